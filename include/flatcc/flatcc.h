@@ -68,6 +68,8 @@ struct flatcc_options {
     int cgen_json_printer;
     int cgen_recursive;
     int cgen_spacing;
+    int cgen_vtable_dict;
+    int cgen_verifier_specs;
 
     int bgen_bfbs;
     int bgen_qualify_names;
@@ -195,6 +197,15 @@ int flatcc_parse_file(flatcc_context_t ctx, const char *filename);
  * written to the each output binary schema. This option is only
  * understood when writing to files.
  *
+ * If `cgen_vtable_dict` is set along with `cgen_builder`, each builder
+ * file also gets a static vtable dictionary for its tables, see
+ * `flatcc_builder_set_vtable_dict`.
+ *
+ * If `cgen_verifier_specs` is set along with `cgen_verifier`, tables
+ * are verified by interpreting generated field specs in the runtime
+ * instead of by a generated function per table, see
+ * `flatcc_verify_table_as_root_with_spec`.
+ *
  * Returns 0 on success.
  */
 int flatcc_generate_files(flatcc_context_t ctx);
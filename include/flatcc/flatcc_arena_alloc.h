@@ -0,0 +1,117 @@
+#ifndef FLATCC_ARENA_ALLOC_H
+#define FLATCC_ARENA_ALLOC_H
+
+/*
+ * Builder allocator that serves all builder stacks and caches from one
+ * contiguous slab so a builder can start building without a cascade
+ * of small reallocations.
+ *
+ * The builder uses a separate buffer for each `flatcc_builder_alloc_type`
+ * and grows each buffer on demand. The default allocator starts small
+ * and doubles with `realloc`, and every move of the data stack forces
+ * the builder to refresh its stack pointers. The arena allocator
+ * instead carves one region per buffer type out of a single slab and
+ * hands out the whole region on first use. A buffer that outgrows its
+ * region is moved to the heap and then grows like with the default
+ * allocator.
+ *
+ * Region sizes are given by a profile. The arena records the largest
+ * size given out for each buffer type, so the profile of a finished
+ * build can size the arena of the next builder such that it does not
+ * reallocate at all:
+ *
+ *     flatcc_arena_alloc_t A;
+ *     flatcc_arena_alloc_profile_t profile;
+ *     flatcc_builder_t builder, *B = &builder;
+ *
+ *     flatcc_arena_alloc_init(&A, 0, 0);
+ *     flatcc_builder_custom_init(B, 0, 0, flatcc_arena_alloc, &A);
+ *     ... build buffer ...
+ *     flatcc_arena_alloc_get_profile(&A, &profile);
+ *     flatcc_builder_clear(B);
+ *     flatcc_arena_alloc_clear(&A);
+ *
+ *     flatcc_arena_alloc_init(&A, &profile, flatcc_arena_alloc_mmap);
+ *     ...
+ *
+ * The slab is allocated with `malloc` by default. With
+ * `flatcc_arena_alloc_mmap` it is mapped as anonymous memory where
+ * supported, and with `flatcc_arena_alloc_hugepages` it is mapped
+ * using huge pages where supported, falling back to ordinary pages.
+ *
+ * An arena serves one builder at a time. It can be reused by another
+ * builder after `flatcc_builder_clear`.
+ */
+
+#include <stdlib.h>
+
+#include "flatcc/flatcc_builder.h"
+
+/* Region size for each buffer type when no profile is given. */
+#ifndef FLATCC_ARENA_ALLOC_REGION_SIZE
+#define FLATCC_ARENA_ALLOC_REGION_SIZE 1024
+#endif
+
+/* Flags for `flatcc_arena_alloc_init`. */
+enum {
+    flatcc_arena_alloc_mmap = 1,
+    flatcc_arena_alloc_hugepages = 2
+};
+
+typedef struct flatcc_arena_alloc_profile flatcc_arena_alloc_profile_t;
+
+struct flatcc_arena_alloc_profile {
+    /* Bytes needed for each buffer, indexed by `flatcc_builder_alloc_type`. */
+    size_t size[FLATCC_BUILDER_ALLOC_BUFFER_COUNT];
+};
+
+typedef struct flatcc_arena_alloc flatcc_arena_alloc_t;
+
+struct flatcc_arena_alloc {
+    uint8_t *slab;
+    size_t slab_size;
+    /* Set if the slab is mapped rather than allocated. */
+    int is_mapped;
+    /* Region of each buffer type within the slab. */
+    size_t offset[FLATCC_BUILDER_ALLOC_BUFFER_COUNT];
+    size_t size[FLATCC_BUILDER_ALLOC_BUFFER_COUNT];
+    /* Largest size given out for each buffer type. */
+    flatcc_arena_alloc_profile_t profile;
+    /* Number of buffers that outgrew their region. */
+    size_t overflow_count;
+};
+
+/*
+ * Allocates a slab with a region for each buffer type sized by
+ * `profile`, or `FLATCC_ARENA_ALLOC_REGION_SIZE` for each buffer type
+ * if `profile` is null. A zero sized region is allowed and means the
+ * buffer is allocated on the heap when first needed. `flags` is a
+ * combination of `flatcc_arena_alloc_mmap` and
+ * `flatcc_arena_alloc_hugepages`, or 0.
+ *
+ * Returns 0 on success, -1 on failure.
+ */
+int flatcc_arena_alloc_init(flatcc_arena_alloc_t *A,
+        const flatcc_arena_alloc_profile_t *profile, int flags);
+
+/*
+ * Releases the slab. Must not be called while a builder still holds
+ * buffers from the arena, i.e. before `flatcc_builder_clear`.
+ */
+void flatcc_arena_alloc_clear(flatcc_arena_alloc_t *A);
+
+/*
+ * Copies the largest size given out for each buffer type since the
+ * arena was initialized, for use as profile of a later arena.
+ */
+void flatcc_arena_alloc_get_profile(flatcc_arena_alloc_t *A,
+        flatcc_arena_alloc_profile_t *profile);
+
+/*
+ * The allocator interface function to the builder API.
+ * `alloc_context` must be of type `flatcc_arena_alloc_t`.
+ */
+int flatcc_arena_alloc(void *alloc_context,
+        flatcc_iovec_t *b, size_t request, int zero_fill, int alloc_type);
+
+#endif /* FLATCC_ARENA_ALLOC_H */
@@ -157,6 +157,14 @@ enum flatcc_builder_alloc_type {
     flatcc_builder_alloc_vd,
     /* User stack frame for custom data. */
     flatcc_builder_alloc_us,
+    /* Log of tables with clustered vtables when building fragments. */
+    flatcc_builder_alloc_fr,
+    /* The hash table part of the string cache. */
+    flatcc_builder_alloc_sh,
+    /* The string descriptor buffer, i.e. list elements for shared objects. */
+    flatcc_builder_alloc_sd,
+    /* The string cache, holds a copy of each interned string or shared object. */
+    flatcc_builder_alloc_sb,
 
     /* Number of allocation buffers. */
     flatcc_builder_alloc_buffer_count
@@ -228,8 +236,8 @@ extern const uint8_t flatcc_builder_padding_base[];
 /**
  * `request` is a minimum size to be returned, but allocation is
  * expected to grow exponentially or in reasonable chunks. Notably,
- * `alloc_type = flatcc_builder_alloc_ht` will only use highest available
- * power of 2. The allocator may shrink if `request` is well below
+ * `alloc_type = flatcc_builder_alloc_ht` and `flatcc_builder_alloc_sh`
+ * will only use highest available power of 2. The allocator may shrink if `request` is well below
  * current size but should avoid repeated resizing on small changes in
  * request sizes. If `zero_fill` is non-zero, allocated data beyond
  * the current size must be zeroed. The buffer `b` may be null with 0
@@ -311,6 +319,64 @@ struct __flatcc_builder_frame {
     };
 };
 
+/**
+ * Performance counters reported by `flatcc_builder_get_stats`. Counting
+ * is enabled with `flatcc_builder_set_stats` and requires the runtime
+ * library to be compiled with `FLATCC_BUILDER_STATS`.
+ */
+typedef struct flatcc_builder_stats flatcc_builder_stats_t;
+
+struct flatcc_builder_stats {
+    /* Calls to `create_cached_vtable`, and how many found a vtable. */
+    size_t vtable_lookups;
+    size_t vtable_hits;
+    /* Hash chain entries visited by lookups, and the longest chain walked. */
+    size_t vtable_chain_steps;
+    size_t vtable_max_chain;
+    /* Allocator calls and bytes requested, indexed by `alloc_type`. */
+    size_t alloc_calls[FLATCC_BUILDER_ALLOC_BUFFER_COUNT];
+    size_t alloc_bytes[FLATCC_BUILDER_ALLOC_BUFFER_COUNT];
+    /* Refreshes of the table data stack after reallocation or frame exit. */
+    size_t refresh_ds_count;
+    /* Deepest frame level entered. */
+    int peak_level;
+    /*
+     * Default emitter pages allocated, and pages reused from earlier
+     * buffers or taken from a page pool.
+     */
+    size_t emitter_pages_allocated;
+    size_t emitter_pages_recycled;
+    /* Bytes passed to the emitter in front of and behind address 0. */
+    size_t front_bytes;
+    size_t back_bytes;
+};
+
+/**
+ * A static vtable dictionary, usually generated by `flatcc
+ * --vtable-dict`, see `flatcc_builder_set_vtable_dict`. Each shape
+ * lists table fields in the order they are added, with the size and
+ * alignment given to `table_add`, or the offset size for offset fields.
+ */
+typedef struct flatcc_builder_vtable_field flatcc_builder_vtable_field_t;
+typedef struct flatcc_builder_vtable_shape flatcc_builder_vtable_shape_t;
+typedef struct flatcc_builder_vtable_dict flatcc_builder_vtable_dict_t;
+
+struct flatcc_builder_vtable_field {
+    flatbuffers_voffset_t id;
+    flatbuffers_voffset_t size;
+    uint16_t align;
+};
+
+struct flatcc_builder_vtable_shape {
+    const flatcc_builder_vtable_field_t *fields;
+    size_t count;
+};
+
+struct flatcc_builder_vtable_dict {
+    const flatcc_builder_vtable_shape_t *shapes;
+    size_t count;
+};
+
 /**
  * The main flatcc_builder structure. Can be stack allocated and must
  * be initialized with `flatcc_builder_init` and cleared with
@@ -353,11 +419,27 @@ struct flatcc_builder {
     flatcc_iovec_t buffers[FLATCC_BUILDER_ALLOC_BUFFER_COUNT];
     /* Number of slots in ht - 1. */
     size_t ht_mask;
+    /* Number of slots in sh - 1. */
+    size_t sh_mask;
 
     /* The location in vb to add next cached vtable. */
     flatbuffers_uoffset_t vb_end;
     /* Where to allocate next vtable descriptor for hash table. */
     flatbuffers_uoffset_t vd_end;
+    /* Number of vtable cache flushes, so checkpoints can detect them. */
+    size_t vb_flush_count;
+    /* Most recent stale vtable descriptor reused in this buffer, or 0. */
+    flatbuffers_uoffset_t vd_revived;
+    /* End of the table log in `alloc_fr` buffer in fragment mode. */
+    flatbuffers_uoffset_t fr_end;
+    /* The location in sb to add next interned string. */
+    flatbuffers_uoffset_t sb_end;
+    /* Where to allocate next string descriptor for hash table. */
+    flatbuffers_uoffset_t sd_end;
+    /* Number of string cache flushes, so checkpoints can detect them. */
+    size_t sb_flush_count;
+    /* Bytes not emitted because interned strings or shared objects were reused. */
+    size_t shared_bytes_saved;
     /* Ensure final buffer is aligned to at least this. Nested buffers get their own `min_align`. */
     uint16_t min_align;
     /* The current active objects alignment isolated from nested activity. */
@@ -382,10 +464,31 @@ struct flatcc_builder {
 
     /* If non-zero, vtable cache gets flushed periodically. */
     size_t vb_flush_limit;
+    /* If non-zero, string cache gets flushed periodically. */
+    size_t sb_flush_limit;
     /* If non-zero, fails on deep nesting to help drivers with a stack, such as recursive parsers etc. */
     int max_level;
     /* If non-zero, do not cluster vtables at end, only emit negative offsets (0 by default). */
     int disable_vt_clustering;
+    /* If non-zero, log tables so the content can be spliced into another builder. */
+    int fragment_mode;
+    /* If non-zero, top-level buffers are size prefixed and reset keeps the vtable cache. */
+    int stream_mode;
+    /* If non-zero, all strings are interned, not just shared strings. */
+    int intern_strings;
+    /* If non-zero, identical structs, scalar vectors and leaf tables are shared. */
+    int dedup_objects;
+    /* If non-zero, performance counters are updated. */
+    int enable_stats;
+    /* Maps source objects to refs while cloning, owned by the caller, or null. */
+    struct flatcc_refmap *refmap;
+    /* Seeds the vtable cache after reset and flush, or null. */
+    const flatcc_builder_vtable_dict_t *vtable_dict;
+
+    /* Counters since statistics were last enabled, and emitter counts at that point. */
+    flatcc_builder_stats_t stats;
+    size_t stats_page_alloc_base;
+    size_t stats_page_reuse_base;
 
     /* Set if the default emitter is being used. */
     int is_default_emitter;
@@ -399,6 +502,42 @@ struct flatcc_builder {
     size_t user_frame_end;
 };
 
+/**
+ * Builder state saved by `flatcc_builder_checkpoint` and restored by
+ * `flatcc_builder_rollback`. The content is private to the builder.
+ */
+typedef struct flatcc_builder_checkpoint flatcc_builder_checkpoint_t;
+
+struct flatcc_builder_checkpoint {
+    /* Copy of the frame that was open, if any. */
+    __flatcc_builder_frame_t frame;
+    int level;
+    flatbuffers_uoffset_t vs_offset;
+    flatbuffers_uoffset_t pl_offset;
+    flatbuffers_voffset_t id_end;
+    uint32_t vt_hash;
+    flatbuffers_uoffset_t ds_offset;
+    flatbuffers_uoffset_t ds_first;
+    flatbuffers_uoffset_t vb_end;
+    flatbuffers_uoffset_t vd_end;
+    flatbuffers_uoffset_t vd_revived;
+    size_t vb_flush_count;
+    flatbuffers_uoffset_t fr_end;
+    flatbuffers_uoffset_t sb_end;
+    flatbuffers_uoffset_t sd_end;
+    size_t sb_flush_count;
+    size_t shared_bytes_saved;
+    uint16_t min_align;
+    uint16_t align;
+    uint16_t block_align;
+    flatcc_builder_ref_t emit_start;
+    flatcc_builder_ref_t emit_end;
+    flatcc_builder_ref_t buffer_mark;
+    char identifier[FLATBUFFERS_IDENTIFIER_SIZE];
+    size_t user_frame_offset;
+    size_t user_frame_end;
+};
+
 /**
  * Call this before any other API call.
  *
@@ -456,6 +595,18 @@ int flatcc_builder_custom_reset(flatcc_builder_t *B,
  */
 int flatcc_builder_reset(flatcc_builder_t *B);
 
+/**
+ * Pre-sizes the data stack and, with the default emitter, the emitter
+ * so a buffer of up to `size` bytes can be built without further
+ * growth, typically with one allocation each. Best called after reset
+ * and before building. Generated `_estimate_size` helpers give upper
+ * bounds for tables, vectors, strings and buffer headers that can be
+ * added up to a size for the buffer. Other emitters are not affected.
+ *
+ * Returns -1 on allocation failure, 0 on success.
+ */
+int flatcc_builder_reserve(flatcc_builder_t *B, size_t size);
+
 /**
  * Deallocates all memory by calling allocate with a zero size request
  * on each buffer, then zeroing the builder structure itself.
@@ -486,6 +637,38 @@ void flatcc_builder_set_vtable_cache_limit(flatcc_builder_t *B, size_t size);
  */
 void flatcc_builder_flush_vtable_cache(flatcc_builder_t *B);
 
+/**
+ * Seeds the vtable cache with the vtables of a static dictionary so the
+ * first lookup of each listed shape is a cache hit. The vtables are
+ * laid out and hashed exactly as `table_add` and `table_add_offset`
+ * would for the same sequence of fields, and they are only emitted
+ * when a table first uses them, so unused entries cost no space in the
+ * buffer.
+ *
+ * While a dictionary is attached, reset keeps the vtable cache as in
+ * stream mode, and a cache flush seeds the dictionary again, so the
+ * vtable cache limit should be larger than the dictionary. A null
+ * dictionary detaches the current one but keeps its entries until the
+ * next flush. The dictionary must remain valid while attached. It is
+ * detached when reset restores defaults.
+ *
+ * Returns -1 if memory for the cache could not be allocated, and 0
+ * otherwise. Shapes with invalid field ids or tables that would exceed
+ * the voffset range are ignored.
+ */
+int flatcc_builder_set_vtable_dict(flatcc_builder_t *B, const flatcc_builder_vtable_dict_t *dict);
+
+/**
+ * If non-zero, the string cache used for interning will get flushed
+ * whenever the cached string content would exceed the given limit.
+ * Strings longer than the limit are not interned. Strings emitted
+ * before a flush are not shared with strings emitted after.
+ */
+void flatcc_builder_set_string_cache_limit(flatcc_builder_t *B, size_t size);
+
+/** Manual flushing of the string cache used for interning. */
+void flatcc_builder_flush_string_cache(flatcc_builder_t *B);
+
 /**
  * Low-level support function to aid in constructing nested buffers without
  * allocation. Not for regular use.
@@ -554,6 +737,137 @@ void flatcc_builder_set_max_level(flatcc_builder_t *B, int level);
  */
 void flatcc_builder_set_vtable_clustering(flatcc_builder_t *B, int enable);
 
+/**
+ * Fragments allow independent subtrees to be built in parallel, each
+ * in its own builder, typically one per worker thread, and then be
+ * spliced into a main builder.
+ *
+ * A fragment builder is an ordinary builder using the default emitter
+ * with fragment mode enabled. Objects such as tables are created at
+ * level 0 without starting a buffer, and the returned references are
+ * kept for splicing. Fragment mode logs each table using a clustered
+ * vtable so the vtable can be remapped when spliced. The setting
+ * survives reset but is cleared when reset restores defaults.
+ */
+void flatcc_builder_set_fragment_mode(flatcc_builder_t *B, int enable);
+
+/**
+ * Stream mode supports sending many small root buffers as one stream.
+ * Each top-level buffer is emitted with a uoffset little endian size
+ * prefix, the same convention as the length prefix of binary schema
+ * files, and the buffer is padded to a multiple of 4 bytes so the next
+ * record in the stream remains aligned. The emitted content, as
+ * returned by `get_direct_buffer`, `copy_buffer`, `get_buffer_size`
+ * etc., is the prefixed record, and records can be concatenated as is
+ * into a stream to be read with `flatbuffers_stream_iter_next`.
+ *
+ * Normally reset drops the vtable cache because cached vtables cannot
+ * be shared between buffers. In stream mode reset keeps the vtable
+ * hash table and cached vtable content warm, so the next buffer only
+ * emits copies of known vtables without hashing them into a new cache.
+ * The string cache is still cleared on reset.
+ *
+ * The setting survives reset but is cleared when reset restores
+ * defaults.
+ */
+void flatcc_builder_set_stream_mode(flatcc_builder_t *B, int enable);
+
+/**
+ * Attaches a refmap, see `flatcc_refmap.h`, so generated `_clone`
+ * functions reuse objects already cloned into the current buffer
+ * instead of cloning them again. Returns the previous refmap so calls
+ * can be nested. A null refmap disables the lookup. The refmap is owned
+ * by the caller and is not affected by reset.
+ */
+struct flatcc_refmap *flatcc_builder_set_refmap(flatcc_builder_t *B,
+        struct flatcc_refmap *refmap);
+
+/**
+ * Returns the reference recorded for `src` in the attached refmap, or 0
+ * if not found or no refmap is attached.
+ */
+flatcc_builder_ref_t flatcc_builder_refmap_find(flatcc_builder_t *B, const void *src);
+
+/**
+ * Records `ref` for `src` in the attached refmap, if any, and returns
+ * `ref`. Returns 0 if the refmap could not grow.
+ */
+flatcc_builder_ref_t flatcc_builder_refmap_insert(flatcc_builder_t *B,
+        const void *src, flatcc_builder_ref_t ref);
+
+/**
+ * When enabled, every string created, including strings built with
+ * `start_string`, cloned or sliced, is interned as with
+ * `create_shared_string`. Disabled by default. The setting survives
+ * reset but is cleared when reset restores defaults.
+ */
+void flatcc_builder_set_string_interning(flatcc_builder_t *B, int enable);
+
+/**
+ * When enabled, structs created with `create_struct` or `end_struct`,
+ * vectors created with `create_vector` or `end_vector`, and tables
+ * without offset fields are looked up in the string cache by content
+ * before they are emitted, and an identical object emitted earlier in
+ * the current buffer is reused. Offset vectors and tables with offset
+ * fields are not shared. Shared objects must not be modified in place
+ * after the buffer is finalized, unless all uses are meant to change.
+ *
+ * Sharing is independent of `set_string_interning` but uses the same
+ * cache, so `set_string_cache_limit` also applies. Disabled by
+ * default. The setting survives reset but is cleared when reset
+ * restores defaults.
+ */
+void flatcc_builder_set_object_dedup(flatcc_builder_t *B, int enable);
+
+/**
+ * Returns the number of bytes, excluding padding, that were not emitted
+ * because an interned string or a shared object was reused since the
+ * last reset.
+ */
+size_t flatcc_builder_get_shared_bytes_saved(flatcc_builder_t *B);
+
+/**
+ * Enables or disables performance counters. Enabling clears the
+ * counters, which then accumulate across buffers until disabled, so a
+ * long running builder can be sampled now and then. Emitter page
+ * counts are only reported for the default emitter. Disabled by
+ * default. The setting survives reset but is cleared when reset
+ * restores defaults.
+ *
+ * Has no effect unless the runtime library is compiled with
+ * `FLATCC_BUILDER_STATS`, see `flatcc_rtconfig.h`.
+ */
+void flatcc_builder_set_stats(flatcc_builder_t *B, int enable);
+
+/**
+ * Copies the performance counters to `stats`, or zeroes if statistics
+ * are compiled out.
+ */
+void flatcc_builder_get_stats(flatcc_builder_t *B, flatcc_builder_stats_t *stats);
+
+/**
+ * Copies the content of fragment builder `F` into `B` as a single block
+ * placed in front of existing content, and translates the `count`
+ * references in `refs`, obtained from `F`, so they can be used with
+ * `B`, for example as elements in an offset vector or as table fields.
+ *
+ * Internal references within the fragment are relative and need no
+ * change. Vtables of tables logged in fragment mode are looked up in,
+ * or added to, the vtable cache of `B`, and the tables are updated to
+ * use them, so fragments share vtables with each other and with tables
+ * built in `B`. The fragment builder is modified and must be reset
+ * before it is reused. Building in `B` and `F` cannot happen
+ * concurrently with the splice.
+ *
+ * `F` must use the default emitter, must not have open frames or a
+ * top-level buffer, and must be in fragment mode if it has clustered
+ * vtables.
+ *
+ * Returns -1 on failure, 0 on success.
+ */
+int flatcc_builder_splice_fragment(flatcc_builder_t *B, flatcc_builder_t *F,
+        flatcc_builder_ref_t *refs, int count);
+
 /**
  * An alternative to start buffer, start struct/table ... end buffer.
  *
@@ -814,6 +1128,42 @@ void *flatcc_builder_get_user_frame(flatcc_builder_t *B);
  */
 int flatcc_builder_has_user_frame(flatcc_builder_t *B);
 
+/**
+ * Saves the builder state so a partially built subtree can later be
+ * discarded with `flatcc_builder_rollback` without resetting the
+ * builder, for example when input validation fails while building a
+ * nested table.
+ *
+ * Everything started, added, or emitted after the checkpoint is
+ * discarded on rollback, including vtables added to the vtable cache,
+ * and the builder continues as if it had just returned from the
+ * checkpoint call. The checkpoint is only valid while the frame that
+ * was open when it was taken remains open, and content already present
+ * in that frame at checkpoint time must not be edited or truncated in
+ * the meantime. Multiple checkpoints may be taken, but rolling back to
+ * one invalidates later checkpoints.
+ */
+void flatcc_builder_checkpoint(flatcc_builder_t *B, flatcc_builder_checkpoint_t *cp);
+
+/**
+ * Restores the state saved by `flatcc_builder_checkpoint`. The cost
+ * depends on the amount of stack space used and the number of vtables
+ * and shared objects cached since the checkpoint, not on the size of
+ * the buffer or of the caches. Each cached entry is unlinked from its
+ * hash chain, which is usually found near the front of the chain. If a
+ * cache was flushed since the checkpoint, its hash table is cleared
+ * instead.
+ *
+ * Rolling back emitted content requires the emitter to reuse the
+ * discarded address range. The default emitter supports this, see
+ * `flatcc_emitter_rewind`, but with a custom emitter, rollback fails
+ * if anything was emitted after the checkpoint.
+ *
+ * Returns -1 if the builder was not changed because the checkpoint is
+ * no longer valid or cannot be restored, 0 on success.
+ */
+int flatcc_builder_rollback(flatcc_builder_t *B, const flatcc_builder_checkpoint_t *cp);
+
 
 /**
  * Returns the size of the buffer and the logical start and end address
@@ -1201,6 +1551,17 @@ flatcc_builder_ref_t *flatcc_builder_table_add_offset(flatcc_builder_t *B, int i
 flatcc_builder_ref_t flatcc_builder_create_vector(flatcc_builder_t *B,
         const void *data, size_t count, size_t elem_size, uint16_t align, size_t max_count);
 
+/**
+ * Same as `create_vector` but the content is copied with the byte order
+ * of each `swap_width` sized unit reversed, see `flatcc_byteswap.h`.
+ * This converts scalar vectors, and vectors of structs where all fields
+ * have the same size, to protocol endian in one pass when the host
+ * endianness differs. `elem_size` must be a multiple of `swap_width`.
+ */
+flatcc_builder_ref_t flatcc_builder_create_byteswapped_vector(flatcc_builder_t *B,
+        const void *data, size_t count, size_t elem_size, size_t swap_width,
+        uint16_t align, size_t max_count);
+
 /**
  * Starts a vector on the stack.
  *
@@ -1231,6 +1592,14 @@ int flatcc_builder_start_vector(flatcc_builder_t *B, size_t elem_size,
  */
 flatcc_builder_ref_t flatcc_builder_end_vector(flatcc_builder_t *B);
 
+/**
+ * Same as `end_vector` but first reverses the byte order of each
+ * `swap_width` sized unit of the vector on the stack, as
+ * `create_byteswapped_vector`.
+ */
+flatcc_builder_ref_t flatcc_builder_end_byteswapped_vector(flatcc_builder_t *B,
+        size_t swap_width);
+
 /** Returns the number of elements currently on the stack. */
 size_t flatcc_builder_vector_count(flatcc_builder_t *B);
 
@@ -1383,6 +1752,28 @@ flatcc_builder_ref_t flatcc_builder_create_string_str(flatcc_builder_t *B,
  */
 flatcc_builder_ref_t flatcc_builder_create_string_strn(flatcc_builder_t *B, const char *s, size_t max_len);
 
+/**
+ * Interned version of `create_string`. If a string with the same
+ * content was already created by an interned call within the current
+ * buffer, the existing reference is returned and nothing is emitted.
+ * Otherwise the string is created and remembered in the string cache
+ * which works like the vtable cache: a builder owned hash table keyed
+ * by content with a copy of each string, see also
+ * `set_string_cache_limit`.
+ *
+ * Strings are not shared between a nested buffer and its parent.
+ */
+flatcc_builder_ref_t flatcc_builder_create_shared_string(flatcc_builder_t *B,
+        const char *s, size_t len);
+
+/** `create_shared_string` up to zero termination of source. */
+flatcc_builder_ref_t flatcc_builder_create_shared_string_str(flatcc_builder_t *B,
+        const char *s);
+
+/** `create_shared_string` up to zero termination or at most max_len of source. */
+flatcc_builder_ref_t flatcc_builder_create_shared_string_strn(flatcc_builder_t *B,
+        const char *s, size_t max_len);
+
 /**
  * Starts an empty string that can be extended subsequently.
  *
@@ -1475,6 +1866,21 @@ char *flatcc_builder_string_edit(flatcc_builder_t *B);
  */
 void *flatcc_builder_get_direct_buffer(flatcc_builder_t *B, size_t *size_out);
 
+/*
+ * Only for use with the default emitter.
+ *
+ * Zero-copy access to buffers of any size from the default emitter as
+ * an iov array suitable for `writev` or `sendmsg`. See
+ * `flatcc_emitter_get_buffer_iov` for details.
+ *
+ * The entries remain valid until `flatcc_builder_reset` or
+ * `flatcc_builder_clear` which recycles the emitter pages.
+ *
+ * Returns -1 if the emitter is not the default or if `iov_max` is too
+ * small, otherwise the number of entries (required if `iov` is null).
+ */
+int flatcc_builder_get_buffer_iov(flatcc_builder_t *B, flatcc_iovec_t *iov, int iov_max);
+
 /*
  * Only for use with the default emitter.
  *
@@ -1510,10 +1916,56 @@ void *flatcc_builder_finalize_buffer(flatcc_builder_t *B, size_t *size_out);
  * If `size_out` is not null, it is set to the buffer size, or 0 if
  * operation failed.
  *
- * The returned buffer must be deallocated using `free`.
+ * The returned buffer must be deallocated using
+ * `flatcc_builder_aligned_free` because it need not be the start of
+ * the allocated block when `aligned_alloc` is not available.
  */
 void *flatcc_builder_finalize_aligned_buffer(flatcc_builder_t *B, size_t *size_out);
 
+/*
+ * Only for use with the default emitter.
+ *
+ * Returns the capacity required by `flatcc_builder_finalize_buffer_into`
+ * for memory of unknown alignment, that is, the buffer size plus room
+ * to align the buffer to `flatcc_builder_get_buffer_alignment`. Memory
+ * that is already aligned only needs `flatcc_builder_get_buffer_size`.
+ */
+size_t flatcc_builder_get_aligned_buffer_size(flatcc_builder_t *B);
+
+/*
+ * Only for use with the default emitter.
+ *
+ * Finalizes the buffer into caller provided memory, for example a slot
+ * in a shared memory ring, without allocating. The buffer is placed at
+ * the first address in `mem` aligned to the buffer alignment, which is
+ * returned. The returned pointer equals `mem` if `mem` is suitably
+ * aligned.
+ *
+ * Returns null if the emitter is not the default or if `capacity` is
+ * too small, see `flatcc_builder_get_aligned_buffer_size`.
+ *
+ * If `size_out` is not null, it is set to the buffer size, or 0 if
+ * operation failed.
+ */
+void *flatcc_builder_finalize_buffer_into(flatcc_builder_t *B,
+        void *mem, size_t capacity, size_t *size_out);
+
+/*
+ * Allocates `size` bytes aligned to `alignment` which must be a power
+ * of 2. Uses `aligned_alloc` when `FLATBUFFERS_HAVE_ALIGNED_ALLOC` is
+ * defined, otherwise `malloc` with room for alignment.
+ *
+ * The returned memory must be deallocated using
+ * `flatcc_builder_aligned_free`.
+ */
+void *flatcc_builder_aligned_alloc(size_t alignment, size_t size);
+
+/*
+ * Deallocates memory from `flatcc_builder_aligned_alloc` and
+ * `flatcc_builder_finalize_aligned_buffer`. Null is ignored.
+ */
+void flatcc_builder_aligned_free(void *p);
+
 /*
  * Only for use with the default emitter.
  *
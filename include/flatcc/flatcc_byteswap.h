@@ -0,0 +1,37 @@
+#ifndef FLATCC_BYTESWAP_H
+#define FLATCC_BYTESWAP_H
+
+/*
+ * Bulk byte swapping of vector content.
+ *
+ * Generated builders use this when the protocol endianness differs from
+ * the host, i.e. when `flatbuffers_is_native_pe()` is false, so scalar
+ * vectors and vectors of structs with a single field size are converted
+ * in one pass rather than one field at a time. See
+ * `flatcc_builder_create_byteswapped_vector`.
+ *
+ * Readers that link the runtime library can use the same function to
+ * copy a vector out of a buffer into host order:
+ *
+ *     flatbuffers_uint32_vec_t vec = ...;
+ *     size_t len = flatbuffers_uint32_vec_len(vec);
+ *
+ *     if (flatbuffers_is_native_pe()) {
+ *         memcpy(out, vec, len * sizeof(uint32_t));
+ *     } else {
+ *         flatcc_byteswap_copy(out, vec, len * sizeof(uint32_t), sizeof(uint32_t));
+ *     }
+ */
+
+#include <stdlib.h>
+
+/*
+ * Copies `size` bytes from `src` to `dst` while reversing the byte
+ * order of each `width` sized unit. `width` is 1, 2, 4 or 8 and a width
+ * of 1 is a plain copy. `size` must be a multiple of `width`. `dst` may
+ * equal `src` for conversion in place but the buffers must not
+ * otherwise overlap. Neither buffer needs to be aligned.
+ */
+void flatcc_byteswap_copy(void *dst, const void *src, size_t size, size_t width);
+
+#endif /* FLATCC_BYTESWAP_H */
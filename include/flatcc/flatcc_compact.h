@@ -0,0 +1,67 @@
+#ifndef FLATCC_COMPACT_H
+#define FLATCC_COMPACT_H
+
+/*
+ * Rewrites an existing buffer into a compact canonical layout using the
+ * binary schema (bfbs) of its root type, see `flatcc --schema`. No
+ * generated code is needed for the buffer's own schema.
+ *
+ * Buffers built with vtable clustering disabled, with vtable cache
+ * flushes, or assembled from separately built parts, often contain
+ * duplicate vtables and repeated strings. The rewrite builds the
+ * buffer again with vtable clustering, string interning and object
+ * sharing enabled, so identical vtables, strings, structs, scalar
+ * vectors and leaf tables are stored once, and tables reachable along
+ * several paths in the source remain shared:
+ *
+ *     flatcc_builder_init(B);
+ *     if (flatcc_compact_buffer(B, bfbs, bfbs_size, buffer, size)) ... error ...
+ *     compact = flatcc_builder_finalize_aligned_buffer(B, &compact_size);
+ *     printf("saved %zu bytes\n", size - compact_size);
+ *
+ * Field values, including values equal to their default, are kept as
+ * stored, except deprecated fields which are dropped, and union values
+ * with a type not known to the schema which are dropped together with
+ * their type field. Nested flatbuffers are compacted as separate
+ * buffers when the schema was generated by a flatcc version that
+ * exports the `nested_flatbuffer` attribute, and otherwise copied as
+ * plain ubyte vectors.
+ *
+ * The source buffer is bounds checked while it is walked, but it is not
+ * fully verified, so invalid input may be rejected part way, or produce
+ * a buffer that does not verify when the source does not. Use the
+ * generated verifier when the schema is known at compile time.
+ */
+
+#include <stdlib.h>
+
+#include "flatcc/flatcc_builder.h"
+
+/*
+ * Limit on table nesting in the source buffer, also protecting the
+ * call stack. Struct nesting is limited by the schema compiler.
+ */
+#ifndef FLATCC_COMPACT_MAX_LEVELS
+#define FLATCC_COMPACT_MAX_LEVELS 100
+#endif
+
+/*
+ * Builds a compact copy of `buffer` as a new buffer in `B` which can
+ * then be finalized or copied as usual. `bfbs` is a binary schema with
+ * a root table matching the buffer root. It is verified before use and
+ * its file identifier, if any, is used for the new buffer. Both the
+ * schema and the buffer must be aligned to at least 8 bytes in memory,
+ * as with any buffer that is read in place.
+ *
+ * Vtable clustering, string interning and object sharing are enabled,
+ * and vtable and string cache limits are disabled, during the rewrite,
+ * and the builder's own settings are restored on return. Returns 0 on success, or -1 if the
+ * schema does not verify or has no root table, if the buffer is
+ * malformed, or if the builder fails, in which case the builder must
+ * be reset before it is used again.
+ */
+int flatcc_compact_buffer(flatcc_builder_t *B,
+        const void *bfbs, size_t bfbs_size,
+        const void *buffer, size_t size);
+
+#endif /* FLATCC_COMPACT_H */
@@ -42,18 +42,35 @@
  */
 
 /*
- * Memory is allocated in fixed size page units - the first page is
- * split between front and back so each get half the page size. If the
- * size is a multiple of 128 then each page offset will be a multiple of
- * 64, which may be useful for sequencing etc.
+ * Memory is allocated in page units - the first page is split between
+ * front and back so each get half the page size. If the size is a
+ * multiple of 128 then each page offset will be a multiple of 64, which
+ * may be useful for sequencing etc.
+ *
+ * `FLATCC_EMITTER_PAGE_SIZE` is the default page size. It can be
+ * changed per emitter at runtime with `flatcc_emitter_set_page_size`,
+ * or the emitter can choose page sizes adaptively, see
+ * `flatcc_emitter_set_adaptive_page_size`. Runtime sizes are rounded
+ * up to a multiple of twice `FLATCC_EMITTER_PAGE_MULTIPLE`.
  */
+#ifndef FLATCC_EMITTER_PAGE_MULTIPLE
+#define FLATCC_EMITTER_PAGE_MULTIPLE 64
+#endif
+
 #ifndef FLATCC_EMITTER_PAGE_SIZE
 #define FLATCC_EMITTER_MAX_PAGE_SIZE 3000
-#define FLATCC_EMITTER_PAGE_MULTIPLE 64
 #define FLATCC_EMITTER_PAGE_SIZE ((FLATCC_EMITTER_MAX_PAGE_SIZE) &\
     ~(2 * (FLATCC_EMITTER_PAGE_MULTIPLE) - 1))
 #endif
 
+/*
+ * Default upper limit for adaptive page sizes when none is given to
+ * `flatcc_emitter_set_adaptive_page_size`.
+ */
+#ifndef FLATCC_EMITTER_ADAPTIVE_MAX_PAGE_SIZE
+#define FLATCC_EMITTER_ADAPTIVE_MAX_PAGE_SIZE (1024 * 1024)
+#endif
+
 #ifndef FLATCC_EMITTER_ALLOC
 #ifdef FLATCC_EMITTER_USE_ALIGNED_ALLOC
 /*
@@ -69,9 +86,17 @@
 
 typedef struct flatcc_emitter_page flatcc_emitter_page_t;
 typedef struct flatcc_emitter flatcc_emitter_t;
+typedef struct flatcc_emitter_pool flatcc_emitter_pool_t;
 
+/*
+ * The page content is allocated together with the page header and
+ * starts at a multiple of `FLATCC_EMITTER_PAGE_MULTIPLE` after the
+ * header.
+ */
 struct flatcc_emitter_page {
-    uint8_t page[FLATCC_EMITTER_PAGE_SIZE];
+    uint8_t *page;
+    /* The number of bytes in `page`, may differ between pages. */
+    size_t page_size;
     flatcc_emitter_page_t *next;
     flatcc_emitter_page_t *prev;
     /*
@@ -96,6 +121,27 @@ struct flatcc_emitter {
     size_t used;
     size_t capacity;
     size_t used_average;
+
+    /* Settings that survive reset and clear: */
+
+    /* Size of the first page of a buffer, 0 for default. */
+    size_t page_size;
+    /* Adaptive page size limits, both 0 unless adaptive. */
+    size_t min_page_size;
+    size_t max_page_size;
+    /* Shared page pool, if any. */
+    flatcc_emitter_pool_t *pool;
+
+    /* Pool pages cached locally by this emitter. */
+    flatcc_emitter_page_t *pool_cache;
+    size_t pool_cache_count;
+
+    /*
+     * Pages allocated, and pages reused without allocation, since the
+     * emitter was last cleared. Only counted with `FLATCC_BUILDER_STATS`.
+     */
+    size_t page_alloc_count;
+    size_t page_reuse_count;
 };
 
 /* Optional helper to ensure emitter is zeroed initially. */
@@ -104,7 +150,103 @@ static inline void flatcc_emitter_init(flatcc_emitter_t *E)
     memset(E, 0, sizeof(*E));
 }
 
-/* Deallocates all buffer memory making the emitter ready for next use. */
+/*
+ * Sets a fixed page size for pages allocated subsequently and disables
+ * adaptive page sizes. A size of 0 restores the compile time default
+ * `FLATCC_EMITTER_PAGE_SIZE`. Pages already allocated are reused as
+ * is, so the setting is best applied before first use or after clear.
+ *
+ * Large pages mean fewer allocations and shorter page lists for large
+ * buffers, while small pages waste less memory on small buffers.
+ * Settings survive reset and clear.
+ */
+void flatcc_emitter_set_page_size(flatcc_emitter_t *E, size_t page_size);
+
+/*
+ * Enables adaptive page sizes within the given limits. Within a buffer
+ * each new page is as large as all pages allocated so far, up to
+ * `max_page_size`, so a large buffer needs only a logarithmic number of
+ * allocations. On reset the first page of the next buffer is sized
+ * from the running average buffer size so that typical buffers fit in
+ * the front half of a single page. Zero limits select the defaults
+ * `FLATCC_EMITTER_PAGE_SIZE` and `FLATCC_EMITTER_ADAPTIVE_MAX_PAGE_SIZE`.
+ */
+void flatcc_emitter_set_adaptive_page_size(flatcc_emitter_t *E,
+        size_t min_page_size, size_t max_page_size);
+
+/*
+ * A page pool shares emitter pages between emitters, typically one
+ * emitter per thread, such that memory stranded in one emitter after a
+ * burst of traffic can be used by other emitters, and new emitters can
+ * start with warm pages rather than fresh allocations.
+ *
+ * All pages in a pool have the same size. The pool has a lock-free
+ * global freelist and each emitter keeps a small local cache of pool
+ * pages, in addition to the pages it retains between buffers, so most
+ * allocations do not touch shared state. Pages are exchanged with the
+ * freelist in batches of about `FLATCC_EMITTER_POOL_BATCH` pages.
+ * Returned pages are deallocated when the freelist already holds
+ * `max_cached` pages or when all of its fixed number of batch slots
+ * are in use.
+ *
+ * The pool requires C11 atomics. When these are not available,
+ * `flatcc_emitter_pool_create` returns null and
+ * `flatcc_emitter_set_pool` fails.
+ */
+#ifndef FLATCC_EMITTER_POOL_BATCH
+#define FLATCC_EMITTER_POOL_BATCH 8
+#endif
+
+typedef struct flatcc_emitter_pool_stats flatcc_emitter_pool_stats_t;
+struct flatcc_emitter_pool_stats {
+    /* Size of each page in the pool. */
+    size_t page_size;
+    /* Pages held by emitters, including their local caches. */
+    size_t pages_in_use;
+    /* Pages on the global freelist. */
+    size_t pages_cached;
+};
+
+/*
+ * Creates a pool with the given page size, or `FLATCC_EMITTER_PAGE_SIZE`
+ * if 0. `max_cached` limits the number of pages kept on the freelist,
+ * 0 means no limit. Returns null on failure.
+ */
+flatcc_emitter_pool_t *flatcc_emitter_pool_create(size_t page_size, size_t max_cached);
+
+/*
+ * Deallocates all pages on the freelist and the pool itself. All
+ * emitters using the pool must be cleared first.
+ */
+void flatcc_emitter_pool_destroy(flatcc_emitter_pool_t *pool);
+
+/*
+ * A process-wide pool with default page size and no freelist limit.
+ * It is never destroyed, but `flatcc_emitter_pool_trim` can release
+ * cached pages. Returns null if pools are not supported.
+ */
+flatcc_emitter_pool_t *flatcc_emitter_get_global_pool(void);
+
+/* Deallocates pages on the freelist until at most `keep` remain. */
+void flatcc_emitter_pool_trim(flatcc_emitter_pool_t *pool, size_t keep);
+
+/* The counters are updated atomically but read without synchronization. */
+void flatcc_emitter_pool_get_stats(flatcc_emitter_pool_t *pool, flatcc_emitter_pool_stats_t *stats);
+
+/*
+ * Makes the emitter draw pages from, and return pages to, the given
+ * pool. The pool page size overrides page size settings. Must be
+ * called before the first page is allocated or after clear. A null
+ * pool reverts to private allocation. Returns -1 if the emitter has
+ * pages allocated, or if pools are not supported, 0 on success.
+ */
+int flatcc_emitter_set_pool(flatcc_emitter_t *E, flatcc_emitter_pool_t *pool);
+
+/*
+ * Deallocates all buffer memory making the emitter ready for next use.
+ * Page size and pool settings are preserved. Pool pages, including the
+ * local cache, are returned to the pool.
+ */
 void flatcc_emitter_clear(flatcc_emitter_t *E);
 
 /*
@@ -115,6 +257,17 @@ void flatcc_emitter_clear(flatcc_emitter_t *E);
  */
 void flatcc_emitter_reset(flatcc_emitter_t *E);
 
+/*
+ * Replaces the pages of an emitter with no content with a single page
+ * that holds `size` bytes at the front, where the builder places most
+ * of a buffer, and as much at the back. Does nothing if the current
+ * first page is already large enough, if content has been emitted since
+ * reset, or if the emitter uses a page pool.
+ *
+ * Returns -1 on allocation failure, 0 otherwise.
+ */
+int flatcc_emitter_reserve(flatcc_emitter_t *E, size_t size);
+
 /*
  * Helper function that allows a page between front and back to be
  * recycled while the buffer is still being constructed - most likely as part
@@ -134,6 +287,17 @@ void flatcc_emitter_reset(flatcc_emitter_t *E);
  */
 int flatcc_emitter_recycle_page(flatcc_emitter_t *E, flatcc_emitter_page_t *p);
 
+/*
+ * Discards emitted content outside the virtual address range
+ * [`start`, `end`) so subsequent emits continue from there. The range
+ * must lie within the content emitted so far and include address 0.
+ * Pages that no longer hold content are kept for reuse. Used by
+ * `flatcc_builder_rollback`.
+ *
+ * Returns 0 on success, -1 if the range is not valid.
+ */
+int flatcc_emitter_rewind(flatcc_emitter_t *E, flatbuffers_soffset_t start, flatbuffers_soffset_t end);
+
 /*
  * The amount of data copied with `flatcc_emitter_copy_buffer` and related
  * functions. Normally called at end of buffer construction but is
@@ -183,6 +347,25 @@ static inline void *flatcc_emitter_get_direct_buffer(flatcc_emitter_t *E, size_t
  */
 void *flatcc_emitter_copy_buffer(flatcc_emitter_t *E, void *buf, size_t size);
 
+/*
+ * Exports the buffer as a scatter/gather list of the internal pages in
+ * buffer order, such that the iov entries can be passed directly to
+ * `writev`, `sendmsg`, or similar without copying the buffer first.
+ * The `flatcc_iovec_t` type is layout compatible with `struct iovec`.
+ *
+ * If `iov` is null, the number of entries required is returned.
+ * Otherwise up to `iov_max` entries are filled. If `iov_max` is too
+ * small, nothing is stored and -1 is returned, otherwise the number of
+ * entries used is returned. An empty buffer uses 0 entries.
+ *
+ * The entries point into emitter pages and remain valid until the
+ * emitter is reset or cleared, which is when the pages are recycled,
+ * so the emitter should not be reset before the transmission has
+ * completed. Like the copy functions, the result is not meaningful
+ * after pages have been recycled with `flatcc_emitter_recycle_page`.
+ */
+int flatcc_emitter_get_buffer_iov(flatcc_emitter_t *E, flatcc_iovec_t *iov, int iov_max);
+
 /*
  * The emitter interface function to the flatbuilder API.
  * `emit_context` should be of type `flatcc_emitter_t` for this
@@ -0,0 +1,129 @@
+#ifndef FLATCC_FD_EMITTER_H
+#define FLATCC_FD_EMITTER_H
+
+/*
+ * Emitter that streams a buffer to a POSIX file descriptor while it is
+ * being built so that memory use is bounded by two staging pages
+ * regardless of the buffer size.
+ *
+ * The builder emits data at both ends of a virtual address range
+ * starting at 0: content grows down from 0 in the front (negative)
+ * range while clustered vtables grow up in the back (positive) range.
+ * Emitted data never changes, so each staging page is written as soon
+ * as it fills up. The final buffer start is not known before the
+ * buffer is complete, so the virtual address 0 is mapped to a file
+ * offset `origin` chosen by the user. `origin` must be at least as
+ * large as the front part of the buffer which is typically nearly the
+ * entire buffer. On file systems with sparse file support the unused
+ * part of the reservation costs no disk space, but a buffer that grows
+ * below file offset 0 fails with an emitter error.
+ *
+ * When the buffer has been ended, `flatcc_fd_emitter_finalize` writes
+ * the remaining partial pages using `pwrite` and returns the file
+ * offset and size of the buffer. The file is never read back and no
+ * page is held in memory longer than it takes to fill it.
+ *
+ * Usage:
+ *
+ *     flatcc_fd_emitter_t E;
+ *     flatcc_builder_t builder, *B = &builder;
+ *     off_t offset;
+ *     size_t size;
+ *
+ *     flatcc_fd_emitter_init(&E, fd, 1 << 30, 0);
+ *     flatcc_builder_custom_init(B, flatcc_fd_emitter, &E, 0, 0);
+ *     ... build buffer ...
+ *     flatcc_fd_emitter_finalize(&E, &offset, &size);
+ *     flatcc_builder_clear(B);
+ *     flatcc_fd_emitter_clear(&E);
+ *
+ * The emitter is only available on POSIX systems.
+ */
+
+#include <stdlib.h>
+#include <sys/types.h>
+
+#include "flatcc/flatcc_types.h"
+#include "flatcc/flatcc_iov.h"
+
+/*
+ * Staging page size used when 0 is given to `flatcc_fd_emitter_init`.
+ * Each emitter allocates two pages, one for each end of the buffer.
+ * Larger pages result in fewer, larger writes.
+ */
+#ifndef FLATCC_FD_EMITTER_PAGE_SIZE
+#define FLATCC_FD_EMITTER_PAGE_SIZE 65536
+#endif
+
+typedef struct flatcc_fd_emitter flatcc_fd_emitter_t;
+
+/*
+ * The emitter should be initialized with `flatcc_fd_emitter_init`
+ * then provided as emit_context to the flatbuilder along with the
+ * `flatcc_fd_emitter` function.
+ */
+struct flatcc_fd_emitter {
+    int fd;
+    /* File offset of virtual address 0. */
+    off_t origin;
+    size_t page_size;
+    /* Single allocation holding front and back staging page. */
+    uint8_t *front_page;
+    uint8_t *back_page;
+    /* Unused bytes at the start of the front page, filled downwards. */
+    size_t front_left;
+    /* Used bytes at the start of the back page. */
+    size_t back_used;
+    /* Virtual address just above the front page content. */
+    flatbuffers_soffset_t front_base;
+    /* Virtual address of the first byte in the back page. */
+    flatbuffers_soffset_t back_base;
+    /* Virtual address range emitted so far. */
+    flatbuffers_soffset_t start;
+    flatbuffers_soffset_t end;
+    /* Number of bytes emitted so far. */
+    size_t used;
+};
+
+/*
+ * Sets up the emitter to write to `fd` with virtual address 0 mapped to
+ * file offset `origin`. `page_size` may be 0 to use the default. The
+ * file descriptor is not owned by the emitter and must support
+ * `pwrite`. No memory is allocated until the first emit call.
+ */
+void flatcc_fd_emitter_init(flatcc_fd_emitter_t *E, int fd, off_t origin, size_t page_size);
+
+/*
+ * Prepares the emitter for a new buffer with a new origin, keeping the
+ * staging pages. Any unfinalized content is discarded.
+ */
+void flatcc_fd_emitter_reset(flatcc_fd_emitter_t *E, off_t origin);
+
+/* Releases the staging pages. The file descriptor is not closed. */
+void flatcc_fd_emitter_clear(flatcc_fd_emitter_t *E);
+
+/*
+ * Writes the partially filled front and back pages after the buffer
+ * has been ended. `offset_out` receives the file offset of the buffer
+ * start and `size_out` its size, either may be null. The buffer ends
+ * at the highest written file offset, but the file is not truncated.
+ *
+ * Returns 0 on success, -1 on write failure.
+ */
+int flatcc_fd_emitter_finalize(flatcc_fd_emitter_t *E, off_t *offset_out, size_t *size_out);
+
+/* Same as `flatcc_builder_get_buffer_size` once the buffer is ended. */
+static inline size_t flatcc_fd_emitter_get_buffer_size(flatcc_fd_emitter_t *E)
+{
+    return E->used;
+}
+
+/*
+ * The emitter interface function to the flatbuilder API.
+ * `emit_context` must be of type `flatcc_fd_emitter_t`.
+ */
+int flatcc_fd_emitter(void *emit_context,
+        const flatcc_iovec_t *iov, int iov_count,
+        flatbuffers_soffset_t offset, size_t len);
+
+#endif /* FLATCC_FD_EMITTER_H */
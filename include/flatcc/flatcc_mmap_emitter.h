@@ -0,0 +1,113 @@
+#ifndef FLATCC_MMAP_EMITTER_H
+#define FLATCC_MMAP_EMITTER_H
+
+/*
+ * Emitter that builds a buffer directly in a memory mapped file so the
+ * finished buffer never exists as a heap copy and can be read or
+ * mapped by other processes as soon as it is finalized.
+ *
+ * The builder emits data at both ends of a virtual address range
+ * starting at 0: content grows down from 0 in the front (negative)
+ * range while clustered vtables grow up in the back (positive) range.
+ * The emitter extends the file to a reserved size and maps it shared,
+ * with virtual address 0 placed in the middle of the mapping. On file
+ * systems with sparse file support, untouched parts of the reservation
+ * cost no disk space. If either end outgrows the reservation, the file
+ * and the mapping are grown and, if the front grew, the content is
+ * moved up within the mapping.
+ *
+ * `flatcc_mmap_emitter_finalize` moves the buffer to the start of the
+ * file, truncates the file to the buffer size and maps it again at its
+ * final extent. The returned buffer is valid until
+ * `flatcc_mmap_emitter_clear`, and the file remains a valid flatbuffer
+ * after the emitter is cleared.
+ *
+ * Usage:
+ *
+ *     flatcc_mmap_emitter_t E;
+ *     flatcc_builder_t builder, *B = &builder;
+ *     void *buf;
+ *     size_t size;
+ *
+ *     if (flatcc_mmap_emitter_init(&E, fd, 0)) ... error ...
+ *     flatcc_builder_custom_init(B, flatcc_mmap_emitter, &E, 0, 0);
+ *     ... build buffer ...
+ *     buf = flatcc_mmap_emitter_finalize(&E, &size);
+ *     ... use buf ...
+ *     flatcc_builder_clear(B);
+ *     flatcc_mmap_emitter_clear(&E);
+ *
+ * The emitter is only available on POSIX systems.
+ */
+
+#include <stdlib.h>
+#include <sys/types.h>
+
+#include "flatcc/flatcc_types.h"
+#include "flatcc/flatcc_iov.h"
+
+/*
+ * Virtual size reserved when 0 is given to `flatcc_mmap_emitter_init`,
+ * half of which goes to each end of the buffer. Only touched pages are
+ * backed by memory and disk, so the reservation can be generous.
+ */
+#ifndef FLATCC_MMAP_EMITTER_RESERVE
+#define FLATCC_MMAP_EMITTER_RESERVE (64 * 1024 * 1024)
+#endif
+
+typedef struct flatcc_mmap_emitter flatcc_mmap_emitter_t;
+
+struct flatcc_mmap_emitter {
+    int fd;
+    uint8_t *map;
+    size_t map_size;
+    /* Mapping offset of virtual address 0. */
+    size_t origin;
+    /* Virtual address range emitted so far. */
+    flatbuffers_soffset_t start;
+    flatbuffers_soffset_t end;
+    /* Number of bytes emitted so far. */
+    size_t used;
+};
+
+/*
+ * Extends the file `fd` to `reserve` bytes and maps it, or to the
+ * default reservation when `reserve` is 0. Existing file content is
+ * overwritten. The file descriptor must be open for reading and
+ * writing and is not owned by the emitter.
+ *
+ * Returns 0 on success, -1 on failure.
+ */
+int flatcc_mmap_emitter_init(flatcc_mmap_emitter_t *E, int fd, size_t reserve);
+
+/*
+ * Unmaps the file. The file descriptor is not closed, and the file is
+ * left as is, finalized or not.
+ */
+void flatcc_mmap_emitter_clear(flatcc_mmap_emitter_t *E);
+
+/*
+ * Called after the buffer has been ended. Moves the buffer to file
+ * offset 0, truncates the file to the buffer size, and returns the
+ * buffer in the new mapping. `size_out` receives the buffer size and
+ * may be null.
+ *
+ * Returns null on failure in which case the mapping is released.
+ */
+void *flatcc_mmap_emitter_finalize(flatcc_mmap_emitter_t *E, size_t *size_out);
+
+/* Same as `flatcc_builder_get_buffer_size` once the buffer is ended. */
+static inline size_t flatcc_mmap_emitter_get_buffer_size(flatcc_mmap_emitter_t *E)
+{
+    return E->used;
+}
+
+/*
+ * The emitter interface function to the flatbuilder API.
+ * `emit_context` must be of type `flatcc_mmap_emitter_t`.
+ */
+int flatcc_mmap_emitter(void *emit_context,
+        const flatcc_iovec_t *iov, int iov_count,
+        flatbuffers_soffset_t offset, size_t len);
+
+#endif /* FLATCC_MMAP_EMITTER_H */
@@ -0,0 +1,77 @@
+#ifndef FLATCC_REFMAP_H
+#define FLATCC_REFMAP_H
+
+/*
+ * A refmap maps source pointers to builder references so objects that
+ * are reachable along several paths in a source buffer are only cloned
+ * once. Generated `_clone` functions look up and record each cloned
+ * table, vector and string in the refmap attached to the builder with
+ * `flatcc_builder_set_refmap`, if any:
+ *
+ *     flatcc_refmap_t refmap, *old;
+ *
+ *     flatcc_refmap_init(&refmap);
+ *     old = flatcc_builder_set_refmap(B, &refmap);
+ *     MyTable_start_as_root(B);
+ *     MyTable_child_add(B, MyChild_clone(B, MyTable_child(t)));
+ *     ...
+ *     MyTable_end_as_root(B);
+ *     flatcc_builder_set_refmap(B, old);
+ *     flatcc_refmap_clear(&refmap);
+ *
+ * Generated `_clone_as_root` functions do this internally.
+ *
+ * References are only valid within the buffer they were created in, so
+ * a refmap must be reset between buffers and must not be used across
+ * nested buffer boundaries.
+ *
+ * Small maps use storage inside the refmap and larger maps are
+ * allocated with `malloc`.
+ */
+
+#include <stdlib.h>
+
+#include "flatcc/flatcc_builder.h"
+
+/* Number of entries stored in the refmap itself, a power of 2. */
+#ifndef FLATCC_REFMAP_MIN_BUCKETS
+#define FLATCC_REFMAP_MIN_BUCKETS 8
+#endif
+
+typedef struct flatcc_refmap_item flatcc_refmap_item_t;
+
+struct flatcc_refmap_item {
+    const void *src;
+    flatcc_builder_ref_t ref;
+};
+
+typedef struct flatcc_refmap flatcc_refmap_t;
+
+struct flatcc_refmap {
+    size_t count;
+    size_t buckets;
+    flatcc_refmap_item_t *table;
+    flatcc_refmap_item_t min_table[FLATCC_REFMAP_MIN_BUCKETS];
+};
+
+/* Initializes an empty refmap. Does not allocate. */
+void flatcc_refmap_init(flatcc_refmap_t *refmap);
+
+/* Frees any allocated memory and leaves the refmap empty and initialized. */
+void flatcc_refmap_clear(flatcc_refmap_t *refmap);
+
+/* Removes all entries but keeps allocated memory for reuse. */
+void flatcc_refmap_reset(flatcc_refmap_t *refmap);
+
+/*
+ * Records `ref` as the reference of `src`, replacing any earlier entry.
+ * Returns `ref`, or 0 if memory could not be allocated. A null `src` or
+ * zero `ref` is not recorded and returns `ref`.
+ */
+flatcc_builder_ref_t flatcc_refmap_insert(flatcc_refmap_t *refmap,
+        const void *src, flatcc_builder_ref_t ref);
+
+/* Returns the reference recorded for `src`, or 0 if there is none. */
+flatcc_builder_ref_t flatcc_refmap_find(flatcc_refmap_t *refmap, const void *src);
+
+#endif /* FLATCC_REFMAP_H */
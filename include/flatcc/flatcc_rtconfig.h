@@ -55,6 +55,39 @@
 #define FLATCC_DEBUG_VERIFY 0
 #endif
 
+/*
+ * Compiles builder and emitter performance counters into the runtime
+ * library. Counting must still be enabled per builder with
+ * `flatcc_builder_set_stats`, so a builder without statistics only
+ * pays for a predictable branch at each counter. Set to 0 to compile
+ * the counters out entirely, in which case `flatcc_builder_get_stats`
+ * reports zeroes.
+ */
+#ifndef FLATCC_BUILDER_STATS
+#define FLATCC_BUILDER_STATS 1
+#endif
+
+/*
+ * Byte swapping of vectors for a protocol endianness that differs from
+ * the host, see `flatcc_byteswap.h`, uses SSE2 on x86-64 and selects
+ * AVX2 at runtime when the CPU supports it and the compiler is GCC or
+ * Clang. Set to 0 to always use the portable scalar loop.
+ */
+#ifndef FLATCC_BYTESWAP_SIMD
+#define FLATCC_BYTESWAP_SIMD 1
+#endif
+
+/*
+ * UTF-8 and embedded zero checks of strings, see
+ * `flatcc_verify_table_as_root_with_flags`, skip ASCII text with SSE2
+ * on x86-64 and validate all text with AVX2 when the CPU supports it
+ * and the compiler is GCC or Clang. Set to 0 to always use the
+ * portable scalar loop.
+ */
+#ifndef FLATCC_VERIFIER_SIMD
+#define FLATCC_VERIFIER_SIMD 1
+#endif
+
 /*
  * Limit recursion level for tables. Actual level may be deeper
  * when structs are deeply nested - but these are limited by the
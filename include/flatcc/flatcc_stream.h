@@ -0,0 +1,77 @@
+#ifndef FLATCC_STREAM_H
+#define FLATCC_STREAM_H
+
+#ifndef FLATCC_FLATBUFFERS_H
+#error "include via flatcc/flatcc_flatbuffers.h"
+#endif
+
+/*
+ * A stream is a sequence of records, each a uoffset little endian size
+ * prefix followed by a buffer of that size, as produced by the builder
+ * in stream mode (see `flatcc_builder_set_stream_mode`) and by the
+ * `bgen_length_prefix` option for binary schema files.
+ *
+ * The iterator walks the stream in place without copying:
+ *
+ *     flatbuffers_stream_iter_t it;
+ *     const void *buffer;
+ *     size_t size;
+ *
+ *     flatbuffers_stream_iter_init(&it, stream, stream_size);
+ *     while ((buffer = flatbuffers_stream_iter_next(&it, &size))) {
+ *         if (MyTable_verify_as_root(buffer, size)) ...
+ *     }
+ *     if (!flatbuffers_stream_iter_done(&it)) ... truncated stream ...
+ *
+ * Buffers built in stream mode start at a multiple of 4 bytes from the
+ * stream start. Larger alignments hold relative to the buffer start
+ * which is what the verifier checks, but not necessarily in memory.
+ */
+
+typedef struct flatbuffers_stream_iter flatbuffers_stream_iter_t;
+
+struct flatbuffers_stream_iter {
+    const uint8_t *next;
+    const uint8_t *end;
+};
+
+static inline void flatbuffers_stream_iter_init(flatbuffers_stream_iter_t *it,
+        const void *stream, size_t size)
+{
+    it->next = (const uint8_t *)stream;
+    it->end = it->next + size;
+}
+
+/*
+ * Returns the next buffer in the stream and stores its size in
+ * `size_out`, if not null. Returns null at the end of the stream or if
+ * the next record is truncated, in which case the iterator stops.
+ */
+static inline const void *flatbuffers_stream_iter_next(flatbuffers_stream_iter_t *it,
+        size_t *size_out)
+{
+    const uint8_t *buffer;
+    size_t size;
+
+    if ((size_t)(it->end - it->next) < sizeof(flatbuffers_uoffset_t)) {
+        return 0;
+    }
+    size = (size_t)__flatbuffers_uoffset_read_from_pe(it->next);
+    buffer = it->next + sizeof(flatbuffers_uoffset_t);
+    if ((size_t)(it->end - buffer) < size) {
+        return 0;
+    }
+    it->next = buffer + size;
+    if (size_out) {
+        *size_out = size;
+    }
+    return buffer;
+}
+
+/* True if all records have been visited and nothing is left over. */
+static inline int flatbuffers_stream_iter_done(flatbuffers_stream_iter_t *it)
+{
+    return it->next == it->end;
+}
+
+#endif /* FLATCC_STREAM_H */
@@ -78,7 +78,10 @@
     XX(vtable_offset_out_of_range_or_unaligned, "vtable offset out of range or unaligned")\
     XX(vtable_size_out_of_range_or_unaligned, "vtable size out of range or unaligned")\
     XX(vtable_size_overflow, "vtable size overflow")\
-    XX(not_supported, "not supported")
+    XX(not_supported, "not supported")\
+    XX(runtime_task_not_run, "runtime: parallel task not run")\
+    XX(string_not_valid_utf8, "string not valid utf-8")\
+    XX(string_has_embedded_zero, "string has embedded zero")
 
 
 enum flatcc_verify_error_no {
@@ -120,10 +123,136 @@ struct flatcc_table_verifier_descriptor {
     flatbuffers_voffset_t vsize;
     /* Time to live: number nesting levels left before failure. */
     int ttl;
+    /* Objects already verified, or null, see `flatcc_verify_table_as_root_memoized`. */
+    struct flatcc_verify_memo *memo;
+    /* Task runner, or null, see `flatcc_verify_table_as_root_parallel`. */
+    struct flatcc_verify_parallel *parallel;
+    /* Fields to verify, or null for all, see `flatcc_verify_table_as_root_with_mask`. */
+    const struct flatcc_verify_mask *mask;
+    /* Additional string checks, see `flatcc_verify_table_as_root_with_flags`. */
+    int flags;
 };
 
 typedef int flatcc_table_verifier_f(flatcc_table_verifier_descriptor_t *td);
 
+/*
+ * Entry in the visited set of memoized verification. Tables and offset
+ * vectors are keyed by buffer, offset, kind and table verifier, and
+ * remember the nesting levels that were left when they verified.
+ */
+typedef struct flatcc_verify_memo_entry flatcc_verify_memo_entry_t;
+struct flatcc_verify_memo_entry {
+    const void *buf;
+    flatcc_table_verifier_f *tvf;
+    flatbuffers_uoffset_t offset;
+    uint16_t kind;
+    uint16_t ttl;
+};
+
+typedef struct flatcc_verify_memo flatcc_verify_memo_t;
+struct flatcc_verify_memo {
+    flatcc_verify_memo_entry_t *entries;
+    size_t mask;
+    size_t count;
+};
+
+/*
+ * Scratch size in bytes that lets memoized verification of a buffer of
+ * `bufsiz` bytes record every table and offset vector it visits.
+ */
+#define flatcc_verify_memo_size(bufsiz) (((size_t)(bufsiz) / 2 + 2) * sizeof(flatcc_verify_memo_entry_t))
+
+/*
+ * Verifies one part of a large offset vector. Called by a task runner
+ * with the `task_context` it was given and an `index` below the task
+ * count.
+ */
+typedef void flatcc_verify_task_f(void *task_context, size_t index);
+
+/*
+ * Must call `task` once for each index in `0 .. count - 1`, in any
+ * order, on any threads, and only return when all calls have
+ * returned. Calling the tasks in sequence on the current thread is a
+ * valid runner.
+ */
+typedef void flatcc_verify_runner_f(void *runner_context,
+        flatcc_verify_task_f *task, void *task_context, size_t count);
+
+typedef struct flatcc_verify_parallel flatcc_verify_parallel_t;
+struct flatcc_verify_parallel {
+    flatcc_verify_runner_f *runner;
+    void *runner_context;
+};
+
+/*
+ * Selects the fields of a table that restricted verification checks.
+ * Field `id` is selected when bit `id % 32` of `fields[id / 32]` is
+ * set, and ids beyond `count` words are not selected. Generated
+ * verifiers define `<table>_<field>_field_id` for each field, and
+ * `flatcc_verify_mask_word` builds the words in static initializers.
+ *
+ * `children` is null, or has `count * 32` entries indexed by field id
+ * with masks for the table, table vector elements, union table or
+ * nested root under that field. A null entry verifies the whole
+ * subtree of a selected field.
+ */
+typedef struct flatcc_verify_mask flatcc_verify_mask_t;
+struct flatcc_verify_mask {
+    const uint32_t *fields;
+    size_t count;
+    const flatcc_verify_mask_t *const *children;
+};
+
+/* Word `word` of a field mask with only field `id` selected. */
+#define flatcc_verify_mask_word(id, word) \
+    ((uint32_t)((size_t)(id) / 32 == (size_t)(word)) << ((id) % 32))
+
+/*
+ * Kinds of fields in table driven verification, see
+ * `flatcc_verify_table_as_root_with_spec`.
+ */
+enum flatcc_verify_spec_kind {
+    /* Scalar, enum or struct with `align` and `size`. */
+    flatcc_verify_spec_field,
+    flatcc_verify_spec_string,
+    /* Vector with element `align` and `size`. */
+    flatcc_verify_spec_vector,
+    flatcc_verify_spec_string_vector,
+    /* `child` is a table spec. */
+    flatcc_verify_spec_table,
+    flatcc_verify_spec_table_vector,
+    /* `child` is a union spec. */
+    flatcc_verify_spec_union,
+    /* Nested buffer with `align` and a table spec `child`. */
+    flatcc_verify_spec_nested_table,
+    /* Nested buffer with struct `align` and `size`. */
+    flatcc_verify_spec_nested_struct
+};
+
+typedef struct flatcc_verify_field_spec flatcc_verify_field_spec_t;
+struct flatcc_verify_field_spec {
+    const void *child;
+    uint32_t size;
+    flatbuffers_voffset_t id;
+    uint16_t align;
+    uint8_t kind;
+    uint8_t required;
+};
+
+/* Fields in the order the generated verifier function would check them. */
+typedef struct flatcc_verify_table_spec flatcc_verify_table_spec_t;
+struct flatcc_verify_table_spec {
+    const flatcc_verify_field_spec_t *fields;
+    size_t count;
+};
+
+/* Table specs indexed by union type, null for NONE and unknown types. */
+typedef struct flatcc_verify_union_spec flatcc_verify_union_spec_t;
+struct flatcc_verify_union_spec {
+    const flatcc_verify_table_spec_t *const *members;
+    size_t count;
+};
+
 typedef int flatcc_union_verifier_f(flatcc_table_verifier_descriptor_t *td,
         flatbuffers_voffset_t id, uint8_t type);
 
@@ -143,6 +272,94 @@ int flatcc_verify_struct_as_root(const void *buf, size_t bufsiz, const char *fid
 int flatcc_verify_table_as_root(const void *buf, size_t bufsiz, const char *fid,
         flatcc_table_verifier_f *root_tvf);
 
+/*
+ * Verifies like `flatcc_verify_table_as_root` but verifies each table
+ * and offset vector only once, no matter how many offsets refer to it.
+ * Plain verification follows every reference, so a buffer where many
+ * offsets share a subtree, whether from deduplication or crafted to
+ * attack the verifier, costs time in proportion to the expanded tree
+ * and is only bounded by the nesting limit. With memoization the cost
+ * stays in proportion to the buffer size.
+ *
+ * The visited set is a hash table held in the caller provided `scratch`
+ * area of `scratch_size` bytes, aligned as for malloc. It is cleared on
+ * entry and need not be preserved afterwards. `flatcc_verify_memo_size`
+ * gives the size needed to record every object in a buffer. With a
+ * smaller area, objects that do not fit are verified as usual, so the
+ * result is the same, only the time bound is lost. An object reached
+ * at a deeper nesting level than where it was verified is verified
+ * again so the nesting limit is enforced as in plain verification.
+ */
+int flatcc_verify_table_as_root_memoized(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, void *scratch, size_t scratch_size);
+
+/*
+ * Verifies like `flatcc_verify_table_as_root` but splits table and
+ * string vectors of at least `FLATCC_VERIFIER_PARALLEL_MIN_COUNT`
+ * elements into at most `FLATCC_VERIFIER_PARALLEL_MAX_TASKS` chunks
+ * which are handed to `runner` as tasks, typically to be run on a
+ * thread pool. The buffer is only read, and each task verifies its
+ * elements with its own descriptors, so tasks share no mutable state
+ * except their own result slot. Vectors nested inside a task are
+ * verified sequentially by that task.
+ *
+ * When several chunks fail, the error of the first chunk in vector
+ * order is returned, so the result is the same as from
+ * `flatcc_verify_table_as_root` regardless of scheduling. A null
+ * `runner` verifies sequentially.
+ */
+int flatcc_verify_table_as_root_parallel(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, flatcc_verify_runner_f *runner, void *runner_context);
+
+/*
+ * Verifies like `flatcc_verify_table_as_root` but only checks the
+ * vtable and table headers, the fields selected by `mask`, and the
+ * subtrees under them, restricted further by child masks. A null mask
+ * verifies the whole buffer.
+ *
+ * On success every accessor the mask allows is memory safe, including
+ * `_is_present` tests of any field. Accessors of fields that were not
+ * selected may read out of bounds, and required fields are only
+ * checked when selected. For a union field, selecting either the type
+ * or the value field verifies both.
+ */
+int flatcc_verify_table_as_root_with_mask(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, const flatcc_verify_mask_t *mask);
+
+/* Flags for `flatcc_verify_table_as_root_with_flags`. */
+enum flatcc_verify_flags {
+    /* Strings must be valid UTF-8. */
+    flatcc_verify_flag_utf8 = 1,
+    /* Strings must not contain zero bytes before the terminator. */
+    flatcc_verify_flag_no_zero = 2
+};
+
+/*
+ * Verifies like `flatcc_verify_table_as_root` and also checks the
+ * content of every string field and string vector element as given by
+ * `flags`. UTF-8 validation rejects overlong encodings, surrogates,
+ * code points above U+10FFFF and truncated sequences, but accepts
+ * embedded zeroes unless `flatcc_verify_flag_no_zero` is also given.
+ * Both checks are done in a single pass over each string, using SSE2,
+ * or AVX2 when the CPU supports it, unless disabled by
+ * `FLATCC_VERIFIER_SIMD`. With no flags the result is the same as from
+ * `flatcc_verify_table_as_root`. Nested buffers are checked with the
+ * same flags.
+ */
+int flatcc_verify_table_as_root_with_flags(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *root_tvf, int flags);
+
+/*
+ * Verifies like `flatcc_verify_table_as_root` but interprets table
+ * specs generated with `flatcc --verifier-specs` instead of calling
+ * generated verifier functions. Nested tables are tracked on an
+ * explicit stack of `FLATCC_VERIFIER_MAX_LEVELS` frames rather than by
+ * recursion. The result is the same as from the generated functions,
+ * including which error is reported first.
+ */
+int flatcc_verify_table_as_root_with_spec(const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verify_table_spec_t *spec);
+
 /*
  * The buffer header is verified by any of the `_as_root` verifiers, but
  * this function may be used as a quick sanity check.
@@ -192,4 +409,13 @@ int flatcc_verify_table_as_nested_root(flatcc_table_verifier_descriptor_t *td,
 int flatcc_verify_union_field(flatcc_table_verifier_descriptor_t *td,
         flatbuffers_voffset_t id, int required, flatcc_union_verifier_f *uvf);
 
+/*
+ * Verifies the table of a union value for the uvf callback. Unlike
+ * `flatcc_verify_table_field` it does not test the field mask, since
+ * `flatcc_verify_union_field` only calls uvf for a selected union, also
+ * when only the type field was selected.
+ */
+int flatcc_verify_union_table(flatcc_table_verifier_descriptor_t *td,
+        flatbuffers_voffset_t id, flatcc_table_verifier_f tvf);
+
 #endif /* FLATCC_VERIFIER_H */
@@ -0,0 +1,140 @@
+#ifndef FLATCC_WRITER_EMITTER_H
+#define FLATCC_WRITER_EMITTER_H
+
+/*
+ * Emitter that overlaps buffer construction with file I/O by handing
+ * completed pages to a background writer thread.
+ *
+ * The emitter wraps a default emitter. Once the builder has moved past
+ * a page, the page content is final and the page is queued on a
+ * bounded single-producer/single-consumer ring. A dedicated thread
+ * writes queued pages to a file descriptor with `pwrite` while the
+ * builder continues. When the writer is done with a page, the builder
+ * thread returns it to the default emitter with
+ * `flatcc_emitter_recycle_page` so it is reused for new content and
+ * memory stays bounded by the ring size plus a few working pages. When
+ * the ring is full, the builder waits for the writer (backpressure).
+ *
+ * As with `flatcc_fd_emitter`, the final buffer start is not known
+ * before the buffer is complete, so virtual address 0 is mapped to a
+ * user chosen file offset `origin` which must be at least as large as
+ * the front part of the buffer.
+ *
+ * `flatcc_builder_finalize_buffer` only works with the default
+ * emitter. With this emitter `flatcc_writer_emitter_finalize` is used
+ * instead: it waits for queued pages to be written, writes the partial
+ * pages at either end, and returns the file offset and size of the
+ * buffer.
+ *
+ * Usage:
+ *
+ *     flatcc_writer_emitter_t E;
+ *     flatcc_builder_t builder, *B = &builder;
+ *     off_t offset;
+ *     size_t size;
+ *
+ *     if (flatcc_writer_emitter_init(&E, fd, 1 << 30)) ... error ...
+ *     flatcc_builder_custom_init(B, flatcc_writer_emitter, &E, 0, 0);
+ *     ... build buffer ...
+ *     flatcc_writer_emitter_finalize(&E, &offset, &size);
+ *     flatcc_builder_clear(B);
+ *     flatcc_writer_emitter_clear(&E);
+ *
+ * The emitter is only available on POSIX systems with pthreads.
+ */
+
+#include <sys/types.h>
+#include <pthread.h>
+
+#include "flatcc/flatcc_emitter.h"
+
+/*
+ * Number of completed pages that can be queued for the writer thread
+ * before the builder must wait.
+ */
+#ifndef FLATCC_WRITER_EMITTER_RING_SIZE
+#define FLATCC_WRITER_EMITTER_RING_SIZE 8
+#endif
+
+typedef struct flatcc_writer_emitter flatcc_writer_emitter_t;
+
+struct flatcc_writer_emitter {
+    /*
+     * The default emitter holding the pages. Page size and pool
+     * settings may be changed after init and before first use.
+     */
+    flatcc_emitter_t emitter;
+    int fd;
+    /* File offset of virtual address 0. */
+    off_t origin;
+
+    /*
+     * Ring positions count pages since reset. Pages in
+     * [recycled, written) are done but not yet recycled, pages in
+     * [written, queued) are waiting for or being written by the writer.
+     */
+    flatcc_emitter_page_t *ring[FLATCC_WRITER_EMITTER_RING_SIZE];
+    size_t queued;
+    size_t written;
+    size_t recycled;
+
+    /*
+     * Front and back page last seen by the builder thread, null until
+     * the first emission after init or reset.
+     */
+    flatcc_emitter_page_t *front_mark;
+    flatcc_emitter_page_t *back_mark;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    /* Signals the writer that pages are queued or it should stop. */
+    pthread_cond_t queue_cond;
+    /* Signals the builder that pages were written. */
+    pthread_cond_t written_cond;
+    int stop;
+    /* Set on the first write error, after which emit calls fail. */
+    int error;
+};
+
+/*
+ * Sets up the emitter and starts the writer thread. Virtual address 0
+ * maps to file offset `origin` of `fd`. The file descriptor is not
+ * owned by the emitter and must support `pwrite`.
+ *
+ * Returns 0 on success, -1 if the thread could not be started.
+ */
+int flatcc_writer_emitter_init(flatcc_writer_emitter_t *E, int fd, off_t origin);
+
+/*
+ * Waits for pending writes and prepares the emitter for a new buffer
+ * with a new origin. Pages are kept for reuse.
+ */
+void flatcc_writer_emitter_reset(flatcc_writer_emitter_t *E, off_t origin);
+
+/*
+ * Stops and joins the writer thread and releases all pages. The file
+ * descriptor is not closed. The emitter must be initialized again
+ * before reuse.
+ */
+void flatcc_writer_emitter_clear(flatcc_writer_emitter_t *E);
+
+/*
+ * Called after the buffer has been ended. Waits for the writer thread
+ * to write all queued pages, then writes the partially filled pages at
+ * the front and back of the buffer. `offset_out` receives the file
+ * offset of the buffer start and `size_out` its size, either may be
+ * null.
+ *
+ * Returns 0 on success, -1 if any write failed.
+ */
+int flatcc_writer_emitter_finalize(flatcc_writer_emitter_t *E, off_t *offset_out, size_t *size_out);
+
+/*
+ * The emitter interface function to the flatbuilder API.
+ * `emit_context` must be of type `flatcc_writer_emitter_t`.
+ */
+int flatcc_writer_emitter(void *emit_context,
+        const flatcc_iovec_t *iov, int iov_count,
+        flatbuffers_soffset_t offset, size_t len);
+
+#endif /* FLATCC_WRITER_EMITTER_H */
@@ -10,6 +10,7 @@
 #ifndef FLATBUILDER_H
 #include "flatcc/flatcc_builder.h"
 #endif
+#include "flatcc/flatcc_refmap.h"
 typedef flatcc_builder_t flatbuffers_builder_t;
 typedef flatcc_builder_ref_t flatbuffers_ref_t;
 typedef flatcc_builder_ref_t flatbuffers_vec_ref_t;
@@ -18,6 +19,26 @@ typedef flatcc_builder_ref_t flatbuffers_vec_ref_t;
 typedef flatbuffers_ref_t flatbuffers_root_t;
 #define flatbuffers_root(ref) ((flatbuffers_root_t)(ref))
 
+/* Upper bounds on emitted sizes including padding, see `flatcc_builder_reserve`. */
+#define __flatbuffers_vec_estimate_size(n, S, A)\
+  (sizeof(flatbuffers_uoffset_t) + (size_t)(n) * (S) + ((A) > sizeof(flatbuffers_uoffset_t) ? (A) : sizeof(flatbuffers_uoffset_t)) - 1)
+
+/*
+ * Clones return the ref recorded for a source object in the builders
+ * refmap, if any, and record new clones. Empty vectors are not
+ * recorded because their address may be that of the next object.
+ */
+#define __flatbuffers_memoize_begin(B, src)\
+do { flatbuffers_ref_t _ref; if ((_ref = flatcc_builder_refmap_find((B), (src)))) return _ref; } while (0)
+#define __flatbuffers_memoize_end(B, src, op) do { return flatcc_builder_refmap_insert((B), (src), (op)); } while (0)
+#define __flatbuffers_memoize(B, src, op) do { __flatbuffers_memoize_begin(B, src); __flatbuffers_memoize_end(B, src, op); } while (0)
+#define __flatbuffers_memoize_vec(B, vec, op)\
+do { if (!flatbuffers_vec_len(vec)) return (op); __flatbuffers_memoize(B, vec, op); } while (0)
+/* Copies a scalar or struct table field as is, without endian conversion. */
+static inline int __flatbuffers_clone_field(flatbuffers_builder_t *B, const void *t, flatbuffers_voffset_t field_id, size_t size, uint16_t align)
+{ __flatbuffers_read_vt(field_id, offset, t)
+  return offset && !flatcc_builder_table_add_copy(B, field_id, (const uint8_t *)t + offset, size, align) ? -1 : 0; }
+
 #define __flatbuffers_build_buffer(NS)\
 typedef NS ## ref_t NS ## buffer_ref_t;\
 static inline int NS ## buffer_start(NS ## builder_t *B, NS ##fid_t fid)\
@@ -25,9 +46,17 @@ static inline int NS ## buffer_start(NS ## builder_t *B, NS ##fid_t fid)\
 static inline int NS ## buffer_start_aligned(NS ## builder_t *B, NS ##fid_t fid, uint16_t block_align)\
 { return flatcc_builder_start_buffer(B, fid, block_align); }\
 static inline NS ## buffer_ref_t NS ## buffer_end(NS ## builder_t *B, NS ## ref_t root)\
-{ return flatcc_builder_end_buffer(B, root); }
+{ return flatcc_builder_end_buffer(B, root); }\
+static inline size_t NS ## buffer_estimate_size(size_t size, uint16_t align)\
+{ if (align < sizeof(flatbuffers_uoffset_t)) align = sizeof(flatbuffers_uoffset_t);\
+  return size + 3 * sizeof(flatbuffers_uoffset_t) + 2 * ((size_t)align - 1); }
 
 #define __flatbuffers_build_table_root(NS, N, FID, TFID)\
+static inline NS ## buffer_ref_t N ## _clone_as_buffer(NS ## builder_t *B, NS ## fid_t fid, N ## _table_t t)\
+{ flatcc_refmap_t refmap, *refmap_old; NS ## buffer_ref_t ref = 0;\
+  flatcc_refmap_init(&refmap); refmap_old = flatcc_builder_set_refmap(B, &refmap);\
+  if (!NS ## buffer_start(B, fid)) { ref = NS ## buffer_end(B, N ## _clone(B, t)); }\
+  flatcc_builder_set_refmap(B, refmap_old); flatcc_refmap_clear(&refmap); return ref; }\
 static inline int N ## _start_as_root(NS ## builder_t *B)\
 { return NS ## buffer_start(B, FID) ? -1 : N ## _start(B); }\
 static inline int N ## _start_as_typed_root(NS ## builder_t *B)\
@@ -39,7 +68,11 @@ static inline NS ## buffer_ref_t N ## _end_as_typed_root(NS ## builder_t *B)\
 static inline NS ## buffer_ref_t N ## _create_as_root(NS ## builder_t *B __ ## N ## _formal_args)\
 { if (NS ## buffer_start(B, FID)) return 0; return NS ## buffer_end(B, N ## _create(B __ ## N ## _call_args)); }\
 static inline NS ## buffer_ref_t N ## _create_as_typed_root(NS ## builder_t *B __ ## N ## _formal_args)\
-{ if (NS ## buffer_start(B, TFID)) return 0; return NS ## buffer_end(B, N ## _create(B __ ## N ## _call_args)); }
+{ if (NS ## buffer_start(B, TFID)) return 0; return NS ## buffer_end(B, N ## _create(B __ ## N ## _call_args)); }\
+static inline NS ## buffer_ref_t N ## _clone_as_root(NS ## builder_t *B, N ## _table_t t)\
+{ return N ## _clone_as_buffer(B, FID, t); }\
+static inline NS ## buffer_ref_t N ## _clone_as_typed_root(NS ## builder_t *B, N ## _table_t t)\
+{ return N ## _clone_as_buffer(B, TFID, t); }
 
 #define __flatbuffers_build_table_prolog(NS, N, FID, TFID)\
 __flatbuffers_build_table_vector_ops(NS, N ## _vec, N)\
@@ -126,28 +159,33 @@ static inline T *V ## _push_copy(NS ## builder_t *B, const T *p)\
 static inline T *V ## _push_create(NS ## builder_t *B __ ## TN ## _formal_args)\
 { T *_p; return (_p = flatcc_builder_extend_vector(B, 1)) ? TN ## _assign(_p __ ## TN ## _call_args) : 0; }
 
-#define __flatbuffers_build_vector(NS, N, T, S, A)\
+#define __flatbuffers_build_vector(NS, N, T, S, A, W)\
 typedef NS ## ref_t N ## _vec_ref_t;\
 static inline int N ## _vec_start(NS ## builder_t *B)\
 { return flatcc_builder_start_vector(B, S, A, FLATBUFFERS_COUNT_MAX(S)); }\
 static inline N ## _vec_ref_t N ## _vec_end_pe(NS ## builder_t *B)\
 { return flatcc_builder_end_vector(B); }\
 static inline N ## _vec_ref_t N ## _vec_end(NS ## builder_t *B)\
-{ if (!NS ## is_native_pe()) { size_t i, n; T *p = flatcc_builder_vector_edit(B);\
+{ if (!NS ## is_native_pe()) { size_t i, n; T *p; if (W) return flatcc_builder_end_byteswapped_vector(B, W);\
+    p = flatcc_builder_vector_edit(B);\
     for (i = 0, n = flatcc_builder_vector_count(B); i < n; ++i)\
     { N ## _to_pe(N ## __ptr_add(p, i)); }} return flatcc_builder_end_vector(B); }\
 static inline N ## _vec_ref_t N ## _vec_create_pe(NS ## builder_t *B, const T *data, size_t len)\
 { return flatcc_builder_create_vector(B, data, len, S, A, FLATBUFFERS_COUNT_MAX(S)); }\
 static inline N ## _vec_ref_t N ## _vec_create(NS ## builder_t *B, const T *data, size_t len)\
-{ if (!NS ## is_native_pe()) { size_t i; T *p; int ret = flatcc_builder_start_vector(B, S, A, FLATBUFFERS_COUNT_MAX(S)); if (ret) { return ret; }\
+{ if (!NS ## is_native_pe()) { size_t i; T *p; int ret;\
+  if (W) return flatcc_builder_create_byteswapped_vector(B, data, len, S, W, A, FLATBUFFERS_COUNT_MAX(S));\
+  ret = flatcc_builder_start_vector(B, S, A, FLATBUFFERS_COUNT_MAX(S)); if (ret) { return ret; }\
   p = flatcc_builder_extend_vector(B, len); if (!p) return 0;\
   for (i = 0; i < len; ++i) { N ## _copy_to_pe(N ## __ptr_add(p, i), N ## __const_ptr_add(data, i)); }\
   return flatcc_builder_end_vector(B); } else return flatcc_builder_create_vector(B, data, len, S, A, FLATBUFFERS_COUNT_MAX(S)); }\
 static inline N ## _vec_ref_t N ## _vec_clone(NS ## builder_t *B, N ##_vec_t vec)\
-{ return flatcc_builder_create_vector(B, vec, N ## _vec_len(vec), S, A, FLATBUFFERS_COUNT_MAX(S)); }\
+{ __ ## NS ## memoize_vec(B, vec, flatcc_builder_create_vector(B, vec, N ## _vec_len(vec), S, A, FLATBUFFERS_COUNT_MAX(S))); }\
 static inline N ## _vec_ref_t N ## _vec_slice(NS ## builder_t *B, N ##_vec_t vec, size_t index, size_t len)\
 { size_t n = N ## _vec_len(vec); if (index >= n) index = n; n -= index; if (len > n) len = n;\
   return flatcc_builder_create_vector(B, N ## __const_ptr_add(vec, index), len, S, A, FLATBUFFERS_COUNT_MAX(S)); }\
+static inline size_t N ## _vec_estimate_size(size_t len)\
+{ return __ ## NS ## vec_estimate_size(len, S, A); }\
 __flatbuffers_build_vector_ops(NS, N ## _vec, N, N, T)
 
 #define __flatbuffers_build_string_vector_ops(NS, N)\
@@ -161,6 +199,12 @@ static inline NS ## string_ref_t *N ## _push_create_str(NS ## builder_t *B, cons
 { return NS ## string_vec_push(B, NS ## string_create_str(B, s)); }\
 static inline NS ## string_ref_t *N ## _push_create_strn(NS ## builder_t *B, const char *s, size_t max_len)\
 { return NS ## string_vec_push(B, NS ## string_create_strn(B, s, max_len)); }\
+static inline NS ## string_ref_t *N ## _push_create_shared(NS ## builder_t *B, const char *s, size_t len)\
+{ return NS ## string_vec_push(B, NS ## string_create_shared(B, s, len)); }\
+static inline NS ## string_ref_t *N ## _push_create_shared_str(NS ## builder_t *B, const char *s)\
+{ return NS ## string_vec_push(B, NS ## string_create_shared_str(B, s)); }\
+static inline NS ## string_ref_t *N ## _push_create_shared_strn(NS ## builder_t *B, const char *s, size_t max_len)\
+{ return NS ## string_vec_push(B, NS ## string_create_shared_strn(B, s, max_len)); }\
 static inline NS ## string_ref_t *N ## _push_clone(NS ## builder_t *B, NS ## string_t string)\
 { return NS ## string_vec_push(B, NS ## string_clone(B, string)); }\
 static inline NS ## string_ref_t *N ## _push_slice(NS ## builder_t *B, NS ## string_t string, size_t index, size_t len)\
@@ -196,6 +240,14 @@ static inline N ## _vec_ref_t N ## _vec_end(NS ## builder_t *B)\
 { return flatcc_builder_end_offset_vector(B); }\
 static inline N ## _vec_ref_t N ## _vec_create(NS ## builder_t *B, const N ## _ref_t *data, size_t len)\
 { return flatcc_builder_create_offset_vector(B, data, len); }\
+static inline N ## _vec_ref_t N ## _vec_clone(NS ## builder_t *B, N ##_vec_t vec)\
+{ size_t i, n = N ## _vec_len(vec); NS ## ref_t ref; if (n) { __ ## NS ## memoize_begin(B, vec); }\
+  if (flatcc_builder_start_offset_vector(B)) { return 0; }\
+  for (i = 0; i < n; ++i) { if (!(ref = N ## _clone(B, N ## _vec_at(vec, i)))\
+    || !flatcc_builder_offset_vector_push(B, ref)) { return 0; } }\
+  ref = flatcc_builder_end_offset_vector(B); return n ? flatcc_builder_refmap_insert(B, vec, ref) : ref; }\
+static inline size_t N ## _vec_estimate_size(size_t len)\
+{ return __ ## NS ## vec_estimate_size(len, sizeof(flatbuffers_uoffset_t), sizeof(flatbuffers_uoffset_t)); }\
 __flatbuffers_build_offset_vector_ops(NS, N ## _vec, N, N)
 
 #define __flatbuffers_build_string_ops(NS, N)\
@@ -226,11 +278,19 @@ static inline NS ## ref_t NS ## string_create_str(NS ## builder_t *B, const char
 { return flatcc_builder_create_string_str(B, s); }\
 static inline NS ## ref_t NS ## string_create_strn(NS ## builder_t *B, const char *s, size_t len)\
 { return flatcc_builder_create_string_strn(B, s, len); }\
+static inline NS ## ref_t NS ## string_create_shared(NS ## builder_t *B, const char *s, size_t len)\
+{ return flatcc_builder_create_shared_string(B, s, len); }\
+static inline NS ## ref_t NS ## string_create_shared_str(NS ## builder_t *B, const char *s)\
+{ return flatcc_builder_create_shared_string_str(B, s); }\
+static inline NS ## ref_t NS ## string_create_shared_strn(NS ## builder_t *B, const char *s, size_t len)\
+{ return flatcc_builder_create_shared_string_strn(B, s, len); }\
 static inline NS ## string_ref_t NS ## string_clone(NS ## builder_t *B, NS ## string_t string)\
-{ return flatcc_builder_create_string(B, string, NS ## string_len(string)); }\
+{ __ ## NS ## memoize(B, string, flatcc_builder_create_string(B, string, NS ## string_len(string))); }\
 static inline NS ## string_ref_t NS ## string_slice(NS ## builder_t *B, NS ## string_t string, size_t index, size_t len)\
 { size_t n = NS ## string_len(string); if (index >= n) index = n; n -= index; if (len > n) len = n;\
   return flatcc_builder_create_string(B, string + index, len); }\
+static inline size_t NS ## string_estimate_size(size_t len)\
+{ return __ ## NS ## vec_estimate_size(len + 1, 1, 1); }\
 __flatbuffers_build_string_ops(NS, NS ## string)\
 __flatbuffers_build_offset_vector(NS, NS ## string)
 
@@ -253,7 +313,7 @@ static inline T *N ## _assign_to_pe(T *p, T v0)\
 { *p = N ## _cast_to_pe(v0); return p; }
 #define __flatbuffers_build_scalar(NS, N, T)\
 __ ## NS ## define_scalar_primitives(NS, N, T)\
-__ ## NS ## build_vector(NS, N, T, sizeof(T), sizeof(T))
+__ ## NS ## build_vector(NS, N, T, sizeof(T), sizeof(T), sizeof(T))
 /* Depends on generated copy_to/from_pe functions, and the type. */
 #define __flatbuffers_define_struct_primitives(NS, N)\
 static inline N ## _t *N ##_to_pe(N ## _t *p)\
@@ -263,7 +323,7 @@ static inline N ## _t *N ##_from_pe(N ## _t *p)\
 static inline N ## _t *N ## _clear(N ## _t *p) { return memset(p, 0, N ## __size()); }
 
 /* Depends on generated copy/assign_to/from_pe functions, and the type. */
-#define __flatbuffers_build_struct(NS, N, S, A, FID, TFID)\
+#define __flatbuffers_build_struct(NS, N, S, A, FID, TFID, W)\
 __ ## NS ## define_struct_primitives(NS, N)\
 typedef NS ## ref_t N ## _ref_t;\
 static inline N ## _t *N ## _start(NS ## builder_t *B)\
@@ -276,11 +336,12 @@ static inline N ## _ref_t N ## _end_pe(NS ## builder_t *B)\
 static inline N ## _ref_t N ## _create(NS ## builder_t *B __ ## N ## _formal_args)\
 { N ## _t *_p = N ## _start(B); if (!_p) return 0; N ##_assign_to_pe(_p __ ## N ## _call_args);\
   return N ## _end(B); }\
-__flatbuffers_build_vector(NS, N, N ## _t, S, A)\
+__flatbuffers_build_vector(NS, N, N ## _t, S, A, W)\
 __flatbuffers_build_struct_root(NS, N, A, FID, TFID)
 
 #define __flatbuffers_build_table(NS, N, K)\
 typedef NS ## ref_t N ## _ref_t;\
+static inline N ## _ref_t N ## _clone(NS ## builder_t *B, N ## _table_t t);\
 static inline int N ## _start(NS ## builder_t *B)\
 { return flatcc_builder_start_table(B, K); }\
 static inline N ## _ref_t N ## _end(NS ## builder_t *B)\
@@ -289,6 +350,10 @@ static inline N ## _ref_t N ## _end(NS ## builder_t *B)\
   return flatcc_builder_end_table(B); }\
 __flatbuffers_build_offset_vector(NS, N)
 
+/* S: upper bound on the table and its vtable excluding referenced objects. */
+#define __flatbuffers_build_table_estimate(NS, N, S)\
+static inline size_t N ## _estimate_size(void) { return S; }
+
 #define __flatbuffers_build_table_field(ID, NS, N, TN)\
 static inline int N ## _add(NS ## builder_t *B, TN ## _ref_t ref)\
 { TN ## _ref_t *_p; return (ref && (_p = flatcc_builder_table_add_offset(B, ID))) ?\
@@ -298,12 +363,14 @@ static inline int N ## _start(NS ## builder_t *B)\
 static inline int N ## _end(NS ## builder_t *B)\
 { return N ## _add(B, TN ## _end(B)); }\
 static inline TN ## _ref_t N ## _create(NS ## builder_t *B __ ## TN ##_formal_args)\
-{ return N ## _add(B, TN ## _create(B __ ## TN ## _call_args)); }
+{ return N ## _add(B, TN ## _create(B __ ## TN ## _call_args)); }\
+static inline int N ## _clone(NS ## builder_t *B, TN ## _table_t t)\
+{ return N ## _add(B, TN ## _clone(B, t)); }
 
 #define __flatbuffers_build_union_field(ID, NS, N, TN)\
 static inline int N ## _add(NS ## builder_t *B, TN ## _union_ref_t uref)\
 { NS ## ref_t *_p; TN ## _union_type_t *_pt; if (uref.type == TN ## _NONE) return 0; if (uref._member == 0) return -1;\
-  if (!(_pt = flatcc_builder_table_add(B, ID - 1, sizeof(*_pt), sizeof(_pt))) ||\
+  if (!(_pt = flatcc_builder_table_add(B, ID - 1, sizeof(*_pt), sizeof(*_pt))) ||\
   !(_p = flatcc_builder_table_add_offset(B, ID))) return -1; *_pt = uref.type; *_p = uref._member; return 0; }\
 static inline int N ## _add_type(NS ## builder_t *B, TN ## _union_type_t type)\
 { TN ## _union_type_t *_pt; if (type == TN ## _NONE) return 0; return (_pt = flatcc_builder_table_add(B, ID - 1,\
@@ -373,6 +440,8 @@ static inline int N ## _end(NS ## builder_t *B)\
 { return N ## _add(B, flatcc_builder_end_offset_vector(B)); }\
 static inline int N ## _create(NS ## builder_t *B, const TN ## _ref_t *data, size_t len)\
 { return N ## _add(B, flatcc_builder_create_offset_vector(B, data, len)); }\
+static inline int N ## _clone(NS ## builder_t *B, TN ## _vec_t vec)\
+{ return N ## _add(B, TN ## _vec_clone(B, vec)); }\
 __flatbuffers_build_offset_vector_ops(NS, N, N, TN)
 
 #define __flatbuffers_build_string_field(ID, NS, N)\
@@ -388,6 +457,12 @@ static inline int N ## _create_str(NS ## builder_t *B, const char *s)\
 { return N ## _add(B, flatcc_builder_create_string_str(B, s)); }\
 static inline int N ## _create_strn(NS ## builder_t *B, const char *s, size_t max_len)\
 { return N ## _add(B, flatcc_builder_create_string_strn(B, s, max_len)); }\
+static inline int N ## _create_shared(NS ## builder_t *B, const char *s, size_t len)\
+{ return N ## _add(B, flatcc_builder_create_shared_string(B, s, len)); }\
+static inline int N ## _create_shared_str(NS ## builder_t *B, const char *s)\
+{ return N ## _add(B, flatcc_builder_create_shared_string_str(B, s)); }\
+static inline int N ## _create_shared_strn(NS ## builder_t *B, const char *s, size_t max_len)\
+{ return N ## _add(B, flatcc_builder_create_shared_string_strn(B, s, max_len)); }\
 static inline int N ## _clone(NS ## builder_t *B, NS ## string_t string)\
 { return N ## _add(B, NS ## string_clone(B, string)); }\
 static inline int N ## _slice(NS ## builder_t *B, NS ## string_t string, size_t index, size_t len)\
@@ -29,6 +29,16 @@ flatbuffers_voffset_t offset = 0;\
     __flatbuffers_read_vt(ID, offset, t)\
     return offset ? __flatbuffers_read_scalar_at_byteoffset(N, t, offset) : V;\
 }
+/* Mutators only overwrite fields stored in the buffer, absent or defaulted fields fail. */
+#define __flatbuffers_scalar_field_mutate(N, ID, t, v)\
+{\
+    __flatbuffers_read_vt(ID, offset, t)\
+    if (offset) {\
+        N ## _write_to_pe((uint8_t *)(t) + offset, v);\
+        return 0;\
+    }\
+    return -1;\
+}
 #define __flatbuffers_struct_field(T, ID, t, r)\
 {\
     __flatbuffers_read_vt(ID, offset, t)\
@@ -38,6 +48,14 @@ flatbuffers_voffset_t offset = 0;\
     assert(!(r) && "required field missing");\
     return 0;\
 }
+#define __flatbuffers_struct_field_mutate(N, ID, t, v)\
+{\
+    __flatbuffers_read_vt(ID, offset, t)\
+    if (offset) {\
+        return N ## _mutate((N ## _struct_t)((uint8_t *)(t) + offset), v);\
+    }\
+    return -1;\
+}
 #define __flatbuffers_offset_field(T, ID, t, r, adjust)\
 {\
     flatbuffers_uoffset_t *elem;\
@@ -61,6 +79,9 @@ __flatbuffers_vec_len(vec)
 #define __flatbuffers_scalar_vec_at(N, vec, i)\
 { assert(flatbuffers_vec_len(vec) > (i) && "index out of range");\
   return __flatbuffers_read_scalar(N, &(vec)[i]); }
+#define __flatbuffers_scalar_vec_mutate_at(N, vec, i, v)\
+{ if (flatbuffers_vec_len(vec) <= (i)) return -1;\
+  N ## _write_to_pe((void *)((vec) + (i)), v); return 0; }
 #define __flatbuffers_struct_vec_at(vec, i)\
 { assert(flatbuffers_vec_len(vec) > (i) && "index out of range"); return (vec) + (i); }
 /* `adjust` skips past the header for string vectors. */
@@ -74,6 +95,9 @@ static inline size_t N ## _vec_len(N ##_vec_t vec)\
 #define __flatbuffers_define_scalar_vec_at(N, T) \
 static inline T N ## _vec_at(N ## _vec_t vec, size_t i)\
 __flatbuffers_scalar_vec_at(N, vec, i)
+#define __flatbuffers_define_scalar_vec_mutate_at(N, T) \
+static inline int N ## _vec_mutate_at(N ## _vec_t vec, size_t i, T v)\
+__flatbuffers_scalar_vec_mutate_at(N, vec, i, v)
 typedef const char *flatbuffers_string_t;
 static inline size_t flatbuffers_string_len(flatbuffers_string_t s)
 __flatbuffers_string_len(s)
@@ -182,6 +206,7 @@ typedef const T *N ## _vec_t;\
 typedef T *N ## _mutable_vec_t;\
 __flatbuffers_define_scalar_vec_len(N)\
 __flatbuffers_define_scalar_vec_at(N, T)\
+__flatbuffers_define_scalar_vec_mutate_at(N, T)\
 __flatbuffers_define_scalar_find(N, T)\
 \
 __flatbuffers_define_scalar_sort(N, T)
@@ -208,6 +233,8 @@ __flatbuffers_define_string_sort()
 #define __flatbuffers_struct_scalar_field(t, M, N)\
 { return t ? __flatbuffers_read_scalar(N, &(t->M)) : 0; }
 #define __flatbuffers_struct_struct_field(t, M) { return t ? &(t->M) : 0; }
+#define __flatbuffers_struct_scalar_field_mutate(t, M, N, v)\
+{ if (!t) return -1; N ## _write_to_pe((void *)&(t->M), v); return 0; }
 /* If fid is null, the function returns true without testing as buffer is not expected to have any id. */
 static inline int flatbuffers_has_identifier(const void *buffer, const char *fid)
 { return fid == 0 || memcmp(fid, ((flatbuffers_uoffset_t *)buffer) + 1, FLATBUFFERS_IDENTIFIER_SIZE) == 0; }
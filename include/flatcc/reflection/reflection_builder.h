@@ -26,8 +26,10 @@ static const flatbuffers_voffset_t __reflection_EnumVal_required[] = { 0, 0 };
 __flatbuffers_build_table(flatbuffers_, reflection_EnumVal, 3)
 static const flatbuffers_voffset_t __reflection_Enum_required[] = { 0, 1, 3, 0 };
 __flatbuffers_build_table(flatbuffers_, reflection_Enum, 4)
+static const flatbuffers_voffset_t __reflection_KeyValue_required[] = { 0, 0 };
+__flatbuffers_build_table(flatbuffers_, reflection_KeyValue, 2)
 static const flatbuffers_voffset_t __reflection_Field_required[] = { 0, 1, 0 };
-__flatbuffers_build_table(flatbuffers_, reflection_Field, 9)
+__flatbuffers_build_table(flatbuffers_, reflection_Field, 10)
 static const flatbuffers_voffset_t __reflection_Object_required[] = { 0, 1, 0 };
 __flatbuffers_build_table(flatbuffers_, reflection_Object, 5)
 static const flatbuffers_voffset_t __reflection_Schema_required[] = { 0, 1, 0 };
@@ -41,12 +43,15 @@ static inline reflection_EnumVal_ref_t reflection_EnumVal_create(flatbuffers_bui
 #define __reflection_Enum_formal_args , flatbuffers_string_ref_t v0, reflection_EnumVal_vec_ref_t v1, flatbuffers_bool_t v2, reflection_Type_ref_t v3
 #define __reflection_Enum_call_args , v0, v1, v2, v3
 static inline reflection_Enum_ref_t reflection_Enum_create(flatbuffers_builder_t *B __reflection_Enum_formal_args);
+#define __reflection_KeyValue_formal_args , flatbuffers_string_ref_t v0, flatbuffers_string_ref_t v1
+#define __reflection_KeyValue_call_args , v0, v1
+static inline reflection_KeyValue_ref_t reflection_KeyValue_create(flatbuffers_builder_t *B __reflection_KeyValue_formal_args);
 #define __reflection_Field_formal_args ,\
   flatbuffers_string_ref_t v0, reflection_Type_ref_t v1, uint16_t v2, uint16_t v3,\
-  int64_t v4, double v5, flatbuffers_bool_t v6, flatbuffers_bool_t v7, flatbuffers_bool_t v8
+  int64_t v4, double v5, flatbuffers_bool_t v6, flatbuffers_bool_t v7, flatbuffers_bool_t v8, reflection_KeyValue_vec_ref_t v9
 #define __reflection_Field_call_args ,\
   v0, v1, v2, v3,\
-  v4, v5, v6, v7, v8
+  v4, v5, v6, v7, v8, v9
 static inline reflection_Field_ref_t reflection_Field_create(flatbuffers_builder_t *B __reflection_Field_formal_args);
 #define __reflection_Object_formal_args ,\
   flatbuffers_string_ref_t v0, reflection_Field_vec_ref_t v1, flatbuffers_bool_t v2, int32_t v3, int32_t v4
@@ -73,6 +78,18 @@ static inline reflection_Type_ref_t reflection_Type_create(flatbuffers_builder_t
     }
     return reflection_Type_end(B);
 }
+static inline reflection_Type_ref_t reflection_Type_clone(flatbuffers_builder_t *B, reflection_Type_table_t t)
+{
+    __flatbuffers_memoize_begin(B, t);
+    if (reflection_Type_start(B)
+        || __flatbuffers_clone_field(B, t, 2, 4, 4)
+        || __flatbuffers_clone_field(B, t, 0, 1, 1)
+        || __flatbuffers_clone_field(B, t, 1, 1, 1)) {
+        return 0;
+    }
+    __flatbuffers_memoize_end(B, t, reflection_Type_end(B));
+}
+__flatbuffers_build_table_estimate(flatbuffers_, reflection_Type, (9 + 0 * (2 * sizeof(flatbuffers_uoffset_t) - 1) + sizeof(flatbuffers_uoffset_t) + (4 > sizeof(flatbuffers_uoffset_t) ? 4 : sizeof(flatbuffers_uoffset_t)) - 1 + 5 * sizeof(flatbuffers_voffset_t) + sizeof(flatbuffers_uoffset_t) - 1))
 __flatbuffers_build_table_prolog(flatbuffers_, reflection_Type, reflection_Type_identifier, reflection_Type_type_identifier)
 
 __flatbuffers_build_string_field(0, flatbuffers_, reflection_EnumVal_name)
@@ -89,6 +106,18 @@ static inline reflection_EnumVal_ref_t reflection_EnumVal_create(flatbuffers_bui
     }
     return reflection_EnumVal_end(B);
 }
+static inline reflection_EnumVal_ref_t reflection_EnumVal_clone(flatbuffers_builder_t *B, reflection_EnumVal_table_t t)
+{
+    __flatbuffers_memoize_begin(B, t);
+    if (reflection_EnumVal_start(B)
+        || __flatbuffers_clone_field(B, t, 1, 8, 8)
+        || (reflection_EnumVal_name_is_present(t) && reflection_EnumVal_name_clone(B, reflection_EnumVal_name(t)))
+        || (reflection_EnumVal_object_is_present(t) && reflection_EnumVal_object_clone(B, reflection_EnumVal_object(t)))) {
+        return 0;
+    }
+    __flatbuffers_memoize_end(B, t, reflection_EnumVal_end(B));
+}
+__flatbuffers_build_table_estimate(flatbuffers_, reflection_EnumVal, (15 + 2 * (2 * sizeof(flatbuffers_uoffset_t) - 1) + sizeof(flatbuffers_uoffset_t) + (8 > sizeof(flatbuffers_uoffset_t) ? 8 : sizeof(flatbuffers_uoffset_t)) - 1 + 5 * sizeof(flatbuffers_voffset_t) + sizeof(flatbuffers_uoffset_t) - 1))
 __flatbuffers_build_table_prolog(flatbuffers_, reflection_EnumVal, reflection_EnumVal_identifier, reflection_EnumVal_type_identifier)
 
 __flatbuffers_build_string_field(0, flatbuffers_, reflection_Enum_name)
@@ -108,8 +137,46 @@ static inline reflection_Enum_ref_t reflection_Enum_create(flatbuffers_builder_t
     }
     return reflection_Enum_end(B);
 }
+static inline reflection_Enum_ref_t reflection_Enum_clone(flatbuffers_builder_t *B, reflection_Enum_table_t t)
+{
+    __flatbuffers_memoize_begin(B, t);
+    if (reflection_Enum_start(B)
+        || (reflection_Enum_name_is_present(t) && reflection_Enum_name_clone(B, reflection_Enum_name(t)))
+        || (reflection_Enum_values_is_present(t) && reflection_Enum_values_clone(B, reflection_Enum_values(t)))
+        || (reflection_Enum_underlying_type_is_present(t) && reflection_Enum_underlying_type_clone(B, reflection_Enum_underlying_type(t)))
+        || __flatbuffers_clone_field(B, t, 2, 1, 1)) {
+        return 0;
+    }
+    __flatbuffers_memoize_end(B, t, reflection_Enum_end(B));
+}
+__flatbuffers_build_table_estimate(flatbuffers_, reflection_Enum, (1 + 3 * (2 * sizeof(flatbuffers_uoffset_t) - 1) + sizeof(flatbuffers_uoffset_t) + (1 > sizeof(flatbuffers_uoffset_t) ? 1 : sizeof(flatbuffers_uoffset_t)) - 1 + 6 * sizeof(flatbuffers_voffset_t) + sizeof(flatbuffers_uoffset_t) - 1))
 __flatbuffers_build_table_prolog(flatbuffers_, reflection_Enum, reflection_Enum_identifier, reflection_Enum_type_identifier)
 
+__flatbuffers_build_string_field(0, flatbuffers_, reflection_KeyValue_key)
+__flatbuffers_build_string_field(1, flatbuffers_, reflection_KeyValue_value)
+
+static inline reflection_KeyValue_ref_t reflection_KeyValue_create(flatbuffers_builder_t *B __reflection_KeyValue_formal_args)
+{
+    if (reflection_KeyValue_start(B)
+        || reflection_KeyValue_key_add(B, v0)
+        || reflection_KeyValue_value_add(B, v1)) {
+        return 0;
+    }
+    return reflection_KeyValue_end(B);
+}
+static inline reflection_KeyValue_ref_t reflection_KeyValue_clone(flatbuffers_builder_t *B, reflection_KeyValue_table_t t)
+{
+    __flatbuffers_memoize_begin(B, t);
+    if (reflection_KeyValue_start(B)
+        || (reflection_KeyValue_key_is_present(t) && reflection_KeyValue_key_clone(B, reflection_KeyValue_key(t)))
+        || (reflection_KeyValue_value_is_present(t) && reflection_KeyValue_value_clone(B, reflection_KeyValue_value(t)))) {
+        return 0;
+    }
+    __flatbuffers_memoize_end(B, t, reflection_KeyValue_end(B));
+}
+__flatbuffers_build_table_estimate(flatbuffers_, reflection_KeyValue, (0 + 2 * (2 * sizeof(flatbuffers_uoffset_t) - 1) + sizeof(flatbuffers_uoffset_t) + (1 > sizeof(flatbuffers_uoffset_t) ? 1 : sizeof(flatbuffers_uoffset_t)) - 1 + 4 * sizeof(flatbuffers_voffset_t) + sizeof(flatbuffers_uoffset_t) - 1))
+__flatbuffers_build_table_prolog(flatbuffers_, reflection_KeyValue, reflection_KeyValue_identifier, reflection_KeyValue_type_identifier)
+
 __flatbuffers_build_string_field(0, flatbuffers_, reflection_Field_name)
 __flatbuffers_build_table_field(1, flatbuffers_, reflection_Field_type, reflection_Type)
 __flatbuffers_build_scalar_field(2, flatbuffers_, reflection_Field_id, flatbuffers_uint16, uint16_t, 2, 2, 0)
@@ -119,6 +186,8 @@ __flatbuffers_build_scalar_field(5, flatbuffers_, reflection_Field_default_real,
 __flatbuffers_build_scalar_field(6, flatbuffers_, reflection_Field_deprecated, flatbuffers_bool, flatbuffers_bool_t, 1, 1, 0)
 __flatbuffers_build_scalar_field(7, flatbuffers_, reflection_Field_required, flatbuffers_bool, flatbuffers_bool_t, 1, 1, 0)
 __flatbuffers_build_scalar_field(8, flatbuffers_, reflection_Field_key, flatbuffers_bool, flatbuffers_bool_t, 1, 1, 0)
+/* vector has keyed elements */
+__flatbuffers_build_table_vector_field(9, flatbuffers_, reflection_Field_attributes, reflection_KeyValue)
 
 static inline reflection_Field_ref_t reflection_Field_create(flatbuffers_builder_t *B __reflection_Field_formal_args)
 {
@@ -127,6 +196,7 @@ static inline reflection_Field_ref_t reflection_Field_create(flatbuffers_builder
         || reflection_Field_default_real_add(B, v5)
         || reflection_Field_name_add(B, v0)
         || reflection_Field_type_add(B, v1)
+        || reflection_Field_attributes_add(B, v9)
         || reflection_Field_id_add(B, v2)
         || reflection_Field_offset_add(B, v3)
         || reflection_Field_deprecated_add(B, v6)
@@ -136,6 +206,25 @@ static inline reflection_Field_ref_t reflection_Field_create(flatbuffers_builder
     }
     return reflection_Field_end(B);
 }
+static inline reflection_Field_ref_t reflection_Field_clone(flatbuffers_builder_t *B, reflection_Field_table_t t)
+{
+    __flatbuffers_memoize_begin(B, t);
+    if (reflection_Field_start(B)
+        || __flatbuffers_clone_field(B, t, 4, 8, 8)
+        || __flatbuffers_clone_field(B, t, 5, 8, 8)
+        || (reflection_Field_name_is_present(t) && reflection_Field_name_clone(B, reflection_Field_name(t)))
+        || (reflection_Field_type_is_present(t) && reflection_Field_type_clone(B, reflection_Field_type(t)))
+        || (reflection_Field_attributes_is_present(t) && reflection_Field_attributes_clone(B, reflection_Field_attributes(t)))
+        || __flatbuffers_clone_field(B, t, 2, 2, 2)
+        || __flatbuffers_clone_field(B, t, 3, 2, 2)
+        || __flatbuffers_clone_field(B, t, 6, 1, 1)
+        || __flatbuffers_clone_field(B, t, 7, 1, 1)
+        || __flatbuffers_clone_field(B, t, 8, 1, 1)) {
+        return 0;
+    }
+    __flatbuffers_memoize_end(B, t, reflection_Field_end(B));
+}
+__flatbuffers_build_table_estimate(flatbuffers_, reflection_Field, (39 + 3 * (2 * sizeof(flatbuffers_uoffset_t) - 1) + sizeof(flatbuffers_uoffset_t) + (8 > sizeof(flatbuffers_uoffset_t) ? 8 : sizeof(flatbuffers_uoffset_t)) - 1 + 12 * sizeof(flatbuffers_voffset_t) + sizeof(flatbuffers_uoffset_t) - 1))
 __flatbuffers_build_table_prolog(flatbuffers_, reflection_Field, reflection_Field_identifier, reflection_Field_type_identifier)
 
 __flatbuffers_build_string_field(0, flatbuffers_, reflection_Object_name)
@@ -157,6 +246,20 @@ static inline reflection_Object_ref_t reflection_Object_create(flatbuffers_build
     }
     return reflection_Object_end(B);
 }
+static inline reflection_Object_ref_t reflection_Object_clone(flatbuffers_builder_t *B, reflection_Object_table_t t)
+{
+    __flatbuffers_memoize_begin(B, t);
+    if (reflection_Object_start(B)
+        || (reflection_Object_name_is_present(t) && reflection_Object_name_clone(B, reflection_Object_name(t)))
+        || (reflection_Object_fields_is_present(t) && reflection_Object_fields_clone(B, reflection_Object_fields(t)))
+        || __flatbuffers_clone_field(B, t, 3, 4, 4)
+        || __flatbuffers_clone_field(B, t, 4, 4, 4)
+        || __flatbuffers_clone_field(B, t, 2, 1, 1)) {
+        return 0;
+    }
+    __flatbuffers_memoize_end(B, t, reflection_Object_end(B));
+}
+__flatbuffers_build_table_estimate(flatbuffers_, reflection_Object, (15 + 2 * (2 * sizeof(flatbuffers_uoffset_t) - 1) + sizeof(flatbuffers_uoffset_t) + (4 > sizeof(flatbuffers_uoffset_t) ? 4 : sizeof(flatbuffers_uoffset_t)) - 1 + 7 * sizeof(flatbuffers_voffset_t) + sizeof(flatbuffers_uoffset_t) - 1))
 __flatbuffers_build_table_prolog(flatbuffers_, reflection_Object, reflection_Object_identifier, reflection_Object_type_identifier)
 
 /* vector has keyed elements */
@@ -179,6 +282,20 @@ static inline reflection_Schema_ref_t reflection_Schema_create(flatbuffers_build
     }
     return reflection_Schema_end(B);
 }
+static inline reflection_Schema_ref_t reflection_Schema_clone(flatbuffers_builder_t *B, reflection_Schema_table_t t)
+{
+    __flatbuffers_memoize_begin(B, t);
+    if (reflection_Schema_start(B)
+        || (reflection_Schema_objects_is_present(t) && reflection_Schema_objects_clone(B, reflection_Schema_objects(t)))
+        || (reflection_Schema_enums_is_present(t) && reflection_Schema_enums_clone(B, reflection_Schema_enums(t)))
+        || (reflection_Schema_file_ident_is_present(t) && reflection_Schema_file_ident_clone(B, reflection_Schema_file_ident(t)))
+        || (reflection_Schema_file_ext_is_present(t) && reflection_Schema_file_ext_clone(B, reflection_Schema_file_ext(t)))
+        || (reflection_Schema_root_table_is_present(t) && reflection_Schema_root_table_clone(B, reflection_Schema_root_table(t)))) {
+        return 0;
+    }
+    __flatbuffers_memoize_end(B, t, reflection_Schema_end(B));
+}
+__flatbuffers_build_table_estimate(flatbuffers_, reflection_Schema, (0 + 5 * (2 * sizeof(flatbuffers_uoffset_t) - 1) + sizeof(flatbuffers_uoffset_t) + (1 > sizeof(flatbuffers_uoffset_t) ? 1 : sizeof(flatbuffers_uoffset_t)) - 1 + 7 * sizeof(flatbuffers_voffset_t) + sizeof(flatbuffers_uoffset_t) - 1))
 __flatbuffers_build_table_prolog(flatbuffers_, reflection_Schema, reflection_Schema_identifier, reflection_Schema_type_identifier)
 
 #include "flatcc/portable/pdiagnostic_pop.h"
@@ -26,6 +26,9 @@ typedef flatbuffers_uoffset_t *reflection_EnumVal_mutable_vec_t;
 typedef const struct reflection_Enum_table *reflection_Enum_table_t;
 typedef const flatbuffers_uoffset_t *reflection_Enum_vec_t;
 typedef flatbuffers_uoffset_t *reflection_Enum_mutable_vec_t;
+typedef const struct reflection_KeyValue_table *reflection_KeyValue_table_t;
+typedef const flatbuffers_uoffset_t *reflection_KeyValue_vec_t;
+typedef flatbuffers_uoffset_t *reflection_KeyValue_mutable_vec_t;
 typedef const struct reflection_Field_table *reflection_Field_table_t;
 typedef const flatbuffers_uoffset_t *reflection_Field_vec_t;
 typedef flatbuffers_uoffset_t *reflection_Field_mutable_vec_t;
@@ -97,16 +100,22 @@ __flatbuffers_table_as_root(reflection_Type)
 
 static inline reflection_BaseType_enum_t reflection_Type_base_type(reflection_Type_table_t t)
 __flatbuffers_scalar_field(reflection_BaseType, 0, 0, t)
+static inline int reflection_Type_base_type_mutate(reflection_Type_table_t t, reflection_BaseType_enum_t v)
+__flatbuffers_scalar_field_mutate(reflection_BaseType, 0, t, v)
 static inline int reflection_Type_base_type_is_present(reflection_Type_table_t t)
 __flatbuffers_field_present(0, t)
 
 static inline reflection_BaseType_enum_t reflection_Type_element(reflection_Type_table_t t)
 __flatbuffers_scalar_field(reflection_BaseType, 1, 0, t)
+static inline int reflection_Type_element_mutate(reflection_Type_table_t t, reflection_BaseType_enum_t v)
+__flatbuffers_scalar_field_mutate(reflection_BaseType, 1, t, v)
 static inline int reflection_Type_element_is_present(reflection_Type_table_t t)
 __flatbuffers_field_present(1, t)
 
 static inline int32_t reflection_Type_index(reflection_Type_table_t t)
 __flatbuffers_scalar_field(flatbuffers_int32, 2, -1, t)
+static inline int reflection_Type_index_mutate(reflection_Type_table_t t, int32_t v)
+__flatbuffers_scalar_field_mutate(flatbuffers_int32, 2, t, v)
 static inline int reflection_Type_index_is_present(reflection_Type_table_t t)
 __flatbuffers_field_present(2, t)
 
@@ -131,6 +140,8 @@ __flatbuffers_field_present(0, t)
 
 static inline int64_t reflection_EnumVal_value(reflection_EnumVal_table_t t)
 __flatbuffers_scalar_field(flatbuffers_int64, 1, 0, t)
+static inline int reflection_EnumVal_value_mutate(reflection_EnumVal_table_t t, int64_t v)
+__flatbuffers_scalar_field_mutate(flatbuffers_int64, 1, t, v)
 /* Note: find only works on vectors sorted by this field. */
 __flatbuffers_define_find_by_scalar_field(reflection_EnumVal, value, int64_t)
 __flatbuffers_define_sort_by_scalar_field(reflection_EnumVal, value, int64_t, flatbuffers_uoffset_t)
@@ -179,6 +190,8 @@ __flatbuffers_field_present(1, t)
 
 static inline flatbuffers_bool_t reflection_Enum_is_union(reflection_Enum_table_t t)
 __flatbuffers_scalar_field(flatbuffers_bool, 2, 0, t)
+static inline int reflection_Enum_is_union_mutate(reflection_Enum_table_t t, flatbuffers_bool_t v)
+__flatbuffers_scalar_field_mutate(flatbuffers_bool, 2, t, v)
 static inline int reflection_Enum_is_union_is_present(reflection_Enum_table_t t)
 __flatbuffers_field_present(2, t)
 
@@ -188,6 +201,39 @@ static inline int reflection_Enum_underlying_type_is_present(reflection_Enum_tab
 __flatbuffers_field_present(3, t)
 
 
+struct reflection_KeyValue_table { uint8_t unused__; };
+
+#ifndef reflection_KeyValue_identifier
+#define reflection_KeyValue_identifier flatbuffers_identifier
+#endif
+#define reflection_KeyValue_type_hash ((flatbuffers_thash_t)0x8c761eaa)
+#define reflection_KeyValue_type_identifier "\xaa\x1e\x76\x8c"
+static inline size_t reflection_KeyValue_vec_len(reflection_KeyValue_vec_t vec)
+__flatbuffers_vec_len(vec)
+static inline reflection_KeyValue_table_t reflection_KeyValue_vec_at(reflection_KeyValue_vec_t vec, size_t i)
+__flatbuffers_offset_vec_at(reflection_KeyValue_table_t, vec, i, 0)
+__flatbuffers_table_as_root(reflection_KeyValue)
+
+static inline flatbuffers_string_t reflection_KeyValue_key(reflection_KeyValue_table_t t)
+__flatbuffers_vector_field(flatbuffers_string_t, 0, t, 1)
+/* Note: find only works on vectors sorted by this field. */
+static inline size_t reflection_KeyValue_vec_find_by_key(reflection_KeyValue_vec_t vec, const char *s)
+__flatbuffers_find_by_string_field(reflection_KeyValue_key, vec, reflection_KeyValue_vec_at, reflection_KeyValue_vec_len, s)
+static inline size_t reflection_KeyValue_vec_find_n_by_key(reflection_KeyValue_vec_t vec, const char *s, int n)
+__flatbuffers_find_by_string_n_field(reflection_KeyValue_key, vec, reflection_KeyValue_vec_at, reflection_KeyValue_vec_len, s, n)
+__flatbuffers_define_sort_by_string_field(reflection_KeyValue, key)
+#define reflection_KeyValue_vec_find reflection_KeyValue_vec_find_by_key
+#define reflection_KeyValue_vec_find_n reflection_KeyValue_vec_find_n_by_key
+#define reflection_KeyValue_vec_sort reflection_KeyValue_vec_sort_by_key
+static inline int reflection_KeyValue_key_is_present(reflection_KeyValue_table_t t)
+__flatbuffers_field_present(0, t)
+
+static inline flatbuffers_string_t reflection_KeyValue_value(reflection_KeyValue_table_t t)
+__flatbuffers_vector_field(flatbuffers_string_t, 1, t, 0)
+static inline int reflection_KeyValue_value_is_present(reflection_KeyValue_table_t t)
+__flatbuffers_field_present(1, t)
+
+
 struct reflection_Field_table { uint8_t unused__; };
 
 #ifndef reflection_Field_identifier
@@ -222,39 +268,58 @@ __flatbuffers_field_present(1, t)
 
 static inline uint16_t reflection_Field_id(reflection_Field_table_t t)
 __flatbuffers_scalar_field(flatbuffers_uint16, 2, 0, t)
+static inline int reflection_Field_id_mutate(reflection_Field_table_t t, uint16_t v)
+__flatbuffers_scalar_field_mutate(flatbuffers_uint16, 2, t, v)
 static inline int reflection_Field_id_is_present(reflection_Field_table_t t)
 __flatbuffers_field_present(2, t)
 
 static inline uint16_t reflection_Field_offset(reflection_Field_table_t t)
 __flatbuffers_scalar_field(flatbuffers_uint16, 3, 0, t)
+static inline int reflection_Field_offset_mutate(reflection_Field_table_t t, uint16_t v)
+__flatbuffers_scalar_field_mutate(flatbuffers_uint16, 3, t, v)
 static inline int reflection_Field_offset_is_present(reflection_Field_table_t t)
 __flatbuffers_field_present(3, t)
 
 static inline int64_t reflection_Field_default_integer(reflection_Field_table_t t)
 __flatbuffers_scalar_field(flatbuffers_int64, 4, 0, t)
+static inline int reflection_Field_default_integer_mutate(reflection_Field_table_t t, int64_t v)
+__flatbuffers_scalar_field_mutate(flatbuffers_int64, 4, t, v)
 static inline int reflection_Field_default_integer_is_present(reflection_Field_table_t t)
 __flatbuffers_field_present(4, t)
 
 static inline double reflection_Field_default_real(reflection_Field_table_t t)
 __flatbuffers_scalar_field(flatbuffers_double, 5, 0.000000, t)
+static inline int reflection_Field_default_real_mutate(reflection_Field_table_t t, double v)
+__flatbuffers_scalar_field_mutate(flatbuffers_double, 5, t, v)
 static inline int reflection_Field_default_real_is_present(reflection_Field_table_t t)
 __flatbuffers_field_present(5, t)
 
 static inline flatbuffers_bool_t reflection_Field_deprecated(reflection_Field_table_t t)
 __flatbuffers_scalar_field(flatbuffers_bool, 6, 0, t)
+static inline int reflection_Field_deprecated_mutate(reflection_Field_table_t t, flatbuffers_bool_t v)
+__flatbuffers_scalar_field_mutate(flatbuffers_bool, 6, t, v)
 static inline int reflection_Field_deprecated_is_present(reflection_Field_table_t t)
 __flatbuffers_field_present(6, t)
 
 static inline flatbuffers_bool_t reflection_Field_required(reflection_Field_table_t t)
 __flatbuffers_scalar_field(flatbuffers_bool, 7, 0, t)
+static inline int reflection_Field_required_mutate(reflection_Field_table_t t, flatbuffers_bool_t v)
+__flatbuffers_scalar_field_mutate(flatbuffers_bool, 7, t, v)
 static inline int reflection_Field_required_is_present(reflection_Field_table_t t)
 __flatbuffers_field_present(7, t)
 
 static inline flatbuffers_bool_t reflection_Field_key(reflection_Field_table_t t)
 __flatbuffers_scalar_field(flatbuffers_bool, 8, 0, t)
+static inline int reflection_Field_key_mutate(reflection_Field_table_t t, flatbuffers_bool_t v)
+__flatbuffers_scalar_field_mutate(flatbuffers_bool, 8, t, v)
 static inline int reflection_Field_key_is_present(reflection_Field_table_t t)
 __flatbuffers_field_present(8, t)
 
+static inline reflection_KeyValue_vec_t reflection_Field_attributes(reflection_Field_table_t t)
+__flatbuffers_vector_field(reflection_KeyValue_vec_t, 9, t, 0)
+static inline int reflection_Field_attributes_is_present(reflection_Field_table_t t)
+__flatbuffers_field_present(9, t)
+
 
 struct reflection_Object_table { uint8_t unused__; };
 
@@ -290,16 +355,22 @@ __flatbuffers_field_present(1, t)
 
 static inline flatbuffers_bool_t reflection_Object_is_struct(reflection_Object_table_t t)
 __flatbuffers_scalar_field(flatbuffers_bool, 2, 0, t)
+static inline int reflection_Object_is_struct_mutate(reflection_Object_table_t t, flatbuffers_bool_t v)
+__flatbuffers_scalar_field_mutate(flatbuffers_bool, 2, t, v)
 static inline int reflection_Object_is_struct_is_present(reflection_Object_table_t t)
 __flatbuffers_field_present(2, t)
 
 static inline int32_t reflection_Object_minalign(reflection_Object_table_t t)
 __flatbuffers_scalar_field(flatbuffers_int32, 3, 0, t)
+static inline int reflection_Object_minalign_mutate(reflection_Object_table_t t, int32_t v)
+__flatbuffers_scalar_field_mutate(flatbuffers_int32, 3, t, v)
 static inline int reflection_Object_minalign_is_present(reflection_Object_table_t t)
 __flatbuffers_field_present(3, t)
 
 static inline int32_t reflection_Object_bytesize(reflection_Object_table_t t)
 __flatbuffers_scalar_field(flatbuffers_int32, 4, 0, t)
+static inline int reflection_Object_bytesize_mutate(reflection_Object_table_t t, int32_t v)
+__flatbuffers_scalar_field_mutate(flatbuffers_int32, 4, t, v)
 static inline int reflection_Object_bytesize_is_present(reflection_Object_table_t t)
 __flatbuffers_field_present(4, t)
 
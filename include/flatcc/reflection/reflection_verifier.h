@@ -13,10 +13,15 @@
 static int __reflection_Type_table_verifier(flatcc_table_verifier_descriptor_t *td);
 static int __reflection_EnumVal_table_verifier(flatcc_table_verifier_descriptor_t *td);
 static int __reflection_Enum_table_verifier(flatcc_table_verifier_descriptor_t *td);
+static int __reflection_KeyValue_table_verifier(flatcc_table_verifier_descriptor_t *td);
 static int __reflection_Field_table_verifier(flatcc_table_verifier_descriptor_t *td);
 static int __reflection_Object_table_verifier(flatcc_table_verifier_descriptor_t *td);
 static int __reflection_Schema_table_verifier(flatcc_table_verifier_descriptor_t *td);
 
+#define reflection_Type_base_type_field_id 0
+#define reflection_Type_element_field_id 1
+#define reflection_Type_index_field_id 2
+
 static int __reflection_Type_table_verifier(flatcc_table_verifier_descriptor_t *td)
 {
     int ret;
@@ -46,6 +51,30 @@ static inline int reflection_Type_verify_as_root_with_type_hash(const void *buf,
   return flatcc_verify_table_as_root(buf, bufsiz, thash ? (const char *)&thash : 0, &__reflection_Type_table_verifier);
 }
 
+static inline int reflection_Type_verify_as_root_memoized(const void *buf, size_t bufsiz, void *scratch, size_t scratch_size)
+{
+    return flatcc_verify_table_as_root_memoized(buf, bufsiz, reflection_Type_identifier, &__reflection_Type_table_verifier, scratch, scratch_size);
+}
+
+static inline int reflection_Type_verify_as_root_parallel(const void *buf, size_t bufsiz, flatcc_verify_runner_f *runner, void *runner_context)
+{
+    return flatcc_verify_table_as_root_parallel(buf, bufsiz, reflection_Type_identifier, &__reflection_Type_table_verifier, runner, runner_context);
+}
+
+static inline int reflection_Type_verify_as_root_with_mask(const void *buf, size_t bufsiz, const flatcc_verify_mask_t *mask)
+{
+    return flatcc_verify_table_as_root_with_mask(buf, bufsiz, reflection_Type_identifier, &__reflection_Type_table_verifier, mask);
+}
+
+static inline int reflection_Type_verify_as_root_with_flags(const void *buf, size_t bufsiz, int flags)
+{
+    return flatcc_verify_table_as_root_with_flags(buf, bufsiz, reflection_Type_identifier, &__reflection_Type_table_verifier, flags);
+}
+
+#define reflection_EnumVal_name_field_id 0
+#define reflection_EnumVal_value_field_id 1
+#define reflection_EnumVal_object_field_id 2
+
 static int __reflection_EnumVal_table_verifier(flatcc_table_verifier_descriptor_t *td)
 {
     int ret;
@@ -75,6 +104,31 @@ static inline int reflection_EnumVal_verify_as_root_with_type_hash(const void *b
   return flatcc_verify_table_as_root(buf, bufsiz, thash ? (const char *)&thash : 0, &__reflection_EnumVal_table_verifier);
 }
 
+static inline int reflection_EnumVal_verify_as_root_memoized(const void *buf, size_t bufsiz, void *scratch, size_t scratch_size)
+{
+    return flatcc_verify_table_as_root_memoized(buf, bufsiz, reflection_EnumVal_identifier, &__reflection_EnumVal_table_verifier, scratch, scratch_size);
+}
+
+static inline int reflection_EnumVal_verify_as_root_parallel(const void *buf, size_t bufsiz, flatcc_verify_runner_f *runner, void *runner_context)
+{
+    return flatcc_verify_table_as_root_parallel(buf, bufsiz, reflection_EnumVal_identifier, &__reflection_EnumVal_table_verifier, runner, runner_context);
+}
+
+static inline int reflection_EnumVal_verify_as_root_with_mask(const void *buf, size_t bufsiz, const flatcc_verify_mask_t *mask)
+{
+    return flatcc_verify_table_as_root_with_mask(buf, bufsiz, reflection_EnumVal_identifier, &__reflection_EnumVal_table_verifier, mask);
+}
+
+static inline int reflection_EnumVal_verify_as_root_with_flags(const void *buf, size_t bufsiz, int flags)
+{
+    return flatcc_verify_table_as_root_with_flags(buf, bufsiz, reflection_EnumVal_identifier, &__reflection_EnumVal_table_verifier, flags);
+}
+
+#define reflection_Enum_name_field_id 0
+#define reflection_Enum_values_field_id 1
+#define reflection_Enum_is_union_field_id 2
+#define reflection_Enum_underlying_type_field_id 3
+
 static int __reflection_Enum_table_verifier(flatcc_table_verifier_descriptor_t *td)
 {
     int ret;
@@ -105,6 +159,88 @@ static inline int reflection_Enum_verify_as_root_with_type_hash(const void *buf,
   return flatcc_verify_table_as_root(buf, bufsiz, thash ? (const char *)&thash : 0, &__reflection_Enum_table_verifier);
 }
 
+static inline int reflection_Enum_verify_as_root_memoized(const void *buf, size_t bufsiz, void *scratch, size_t scratch_size)
+{
+    return flatcc_verify_table_as_root_memoized(buf, bufsiz, reflection_Enum_identifier, &__reflection_Enum_table_verifier, scratch, scratch_size);
+}
+
+static inline int reflection_Enum_verify_as_root_parallel(const void *buf, size_t bufsiz, flatcc_verify_runner_f *runner, void *runner_context)
+{
+    return flatcc_verify_table_as_root_parallel(buf, bufsiz, reflection_Enum_identifier, &__reflection_Enum_table_verifier, runner, runner_context);
+}
+
+static inline int reflection_Enum_verify_as_root_with_mask(const void *buf, size_t bufsiz, const flatcc_verify_mask_t *mask)
+{
+    return flatcc_verify_table_as_root_with_mask(buf, bufsiz, reflection_Enum_identifier, &__reflection_Enum_table_verifier, mask);
+}
+
+static inline int reflection_Enum_verify_as_root_with_flags(const void *buf, size_t bufsiz, int flags)
+{
+    return flatcc_verify_table_as_root_with_flags(buf, bufsiz, reflection_Enum_identifier, &__reflection_Enum_table_verifier, flags);
+}
+
+#define reflection_KeyValue_key_field_id 0
+#define reflection_KeyValue_value_field_id 1
+
+static int __reflection_KeyValue_table_verifier(flatcc_table_verifier_descriptor_t *td)
+{
+    int ret;
+    if ((ret = flatcc_verify_string_field(td, 0, 1) /* key */)) return ret;
+    if ((ret = flatcc_verify_string_field(td, 1, 0) /* value */)) return ret;
+    return flatcc_verify_ok;
+}
+
+static inline int reflection_KeyValue_verify_as_root(const void *buf, size_t bufsiz)
+{
+    return flatcc_verify_table_as_root(buf, bufsiz, reflection_KeyValue_identifier, &__reflection_KeyValue_table_verifier);
+}
+
+static inline int reflection_KeyValue_verify_as_typed_root(const void *buf, size_t bufsiz)
+{
+    return flatcc_verify_table_as_root(buf, bufsiz, reflection_KeyValue_type_identifier, &__reflection_KeyValue_table_verifier);
+}
+
+static inline int reflection_KeyValue_verify_as_root_with_identifier(const void *buf, size_t bufsiz, const char *fid)
+{
+    return flatcc_verify_table_as_root(buf, bufsiz, fid, &__reflection_KeyValue_table_verifier);
+}
+
+static inline int reflection_KeyValue_verify_as_root_with_type_hash(const void *buf, size_t bufsiz, flatbuffers_thash_t thash)
+{ __flatbuffers_thash_write_to_pe(&thash, thash);
+  return flatcc_verify_table_as_root(buf, bufsiz, thash ? (const char *)&thash : 0, &__reflection_KeyValue_table_verifier);
+}
+
+static inline int reflection_KeyValue_verify_as_root_memoized(const void *buf, size_t bufsiz, void *scratch, size_t scratch_size)
+{
+    return flatcc_verify_table_as_root_memoized(buf, bufsiz, reflection_KeyValue_identifier, &__reflection_KeyValue_table_verifier, scratch, scratch_size);
+}
+
+static inline int reflection_KeyValue_verify_as_root_parallel(const void *buf, size_t bufsiz, flatcc_verify_runner_f *runner, void *runner_context)
+{
+    return flatcc_verify_table_as_root_parallel(buf, bufsiz, reflection_KeyValue_identifier, &__reflection_KeyValue_table_verifier, runner, runner_context);
+}
+
+static inline int reflection_KeyValue_verify_as_root_with_mask(const void *buf, size_t bufsiz, const flatcc_verify_mask_t *mask)
+{
+    return flatcc_verify_table_as_root_with_mask(buf, bufsiz, reflection_KeyValue_identifier, &__reflection_KeyValue_table_verifier, mask);
+}
+
+static inline int reflection_KeyValue_verify_as_root_with_flags(const void *buf, size_t bufsiz, int flags)
+{
+    return flatcc_verify_table_as_root_with_flags(buf, bufsiz, reflection_KeyValue_identifier, &__reflection_KeyValue_table_verifier, flags);
+}
+
+#define reflection_Field_name_field_id 0
+#define reflection_Field_type_field_id 1
+#define reflection_Field_id_field_id 2
+#define reflection_Field_offset_field_id 3
+#define reflection_Field_default_integer_field_id 4
+#define reflection_Field_default_real_field_id 5
+#define reflection_Field_deprecated_field_id 6
+#define reflection_Field_required_field_id 7
+#define reflection_Field_key_field_id 8
+#define reflection_Field_attributes_field_id 9
+
 static int __reflection_Field_table_verifier(flatcc_table_verifier_descriptor_t *td)
 {
     int ret;
@@ -117,6 +253,7 @@ static int __reflection_Field_table_verifier(flatcc_table_verifier_descriptor_t
     if ((ret = flatcc_verify_field(td, 6, 1, 1) /* deprecated */)) return ret;
     if ((ret = flatcc_verify_field(td, 7, 1, 1) /* required */)) return ret;
     if ((ret = flatcc_verify_field(td, 8, 1, 1) /* key */)) return ret;
+    if ((ret = flatcc_verify_table_vector_field(td, 9, 0, &__reflection_KeyValue_table_verifier) /* attributes */)) return ret;
     return flatcc_verify_ok;
 }
 
@@ -140,6 +277,32 @@ static inline int reflection_Field_verify_as_root_with_type_hash(const void *buf
   return flatcc_verify_table_as_root(buf, bufsiz, thash ? (const char *)&thash : 0, &__reflection_Field_table_verifier);
 }
 
+static inline int reflection_Field_verify_as_root_memoized(const void *buf, size_t bufsiz, void *scratch, size_t scratch_size)
+{
+    return flatcc_verify_table_as_root_memoized(buf, bufsiz, reflection_Field_identifier, &__reflection_Field_table_verifier, scratch, scratch_size);
+}
+
+static inline int reflection_Field_verify_as_root_parallel(const void *buf, size_t bufsiz, flatcc_verify_runner_f *runner, void *runner_context)
+{
+    return flatcc_verify_table_as_root_parallel(buf, bufsiz, reflection_Field_identifier, &__reflection_Field_table_verifier, runner, runner_context);
+}
+
+static inline int reflection_Field_verify_as_root_with_mask(const void *buf, size_t bufsiz, const flatcc_verify_mask_t *mask)
+{
+    return flatcc_verify_table_as_root_with_mask(buf, bufsiz, reflection_Field_identifier, &__reflection_Field_table_verifier, mask);
+}
+
+static inline int reflection_Field_verify_as_root_with_flags(const void *buf, size_t bufsiz, int flags)
+{
+    return flatcc_verify_table_as_root_with_flags(buf, bufsiz, reflection_Field_identifier, &__reflection_Field_table_verifier, flags);
+}
+
+#define reflection_Object_name_field_id 0
+#define reflection_Object_fields_field_id 1
+#define reflection_Object_is_struct_field_id 2
+#define reflection_Object_minalign_field_id 3
+#define reflection_Object_bytesize_field_id 4
+
 static int __reflection_Object_table_verifier(flatcc_table_verifier_descriptor_t *td)
 {
     int ret;
@@ -171,6 +334,32 @@ static inline int reflection_Object_verify_as_root_with_type_hash(const void *bu
   return flatcc_verify_table_as_root(buf, bufsiz, thash ? (const char *)&thash : 0, &__reflection_Object_table_verifier);
 }
 
+static inline int reflection_Object_verify_as_root_memoized(const void *buf, size_t bufsiz, void *scratch, size_t scratch_size)
+{
+    return flatcc_verify_table_as_root_memoized(buf, bufsiz, reflection_Object_identifier, &__reflection_Object_table_verifier, scratch, scratch_size);
+}
+
+static inline int reflection_Object_verify_as_root_parallel(const void *buf, size_t bufsiz, flatcc_verify_runner_f *runner, void *runner_context)
+{
+    return flatcc_verify_table_as_root_parallel(buf, bufsiz, reflection_Object_identifier, &__reflection_Object_table_verifier, runner, runner_context);
+}
+
+static inline int reflection_Object_verify_as_root_with_mask(const void *buf, size_t bufsiz, const flatcc_verify_mask_t *mask)
+{
+    return flatcc_verify_table_as_root_with_mask(buf, bufsiz, reflection_Object_identifier, &__reflection_Object_table_verifier, mask);
+}
+
+static inline int reflection_Object_verify_as_root_with_flags(const void *buf, size_t bufsiz, int flags)
+{
+    return flatcc_verify_table_as_root_with_flags(buf, bufsiz, reflection_Object_identifier, &__reflection_Object_table_verifier, flags);
+}
+
+#define reflection_Schema_objects_field_id 0
+#define reflection_Schema_enums_field_id 1
+#define reflection_Schema_file_ident_field_id 2
+#define reflection_Schema_file_ext_field_id 3
+#define reflection_Schema_root_table_field_id 4
+
 static int __reflection_Schema_table_verifier(flatcc_table_verifier_descriptor_t *td)
 {
     int ret;
@@ -202,5 +391,25 @@ static inline int reflection_Schema_verify_as_root_with_type_hash(const void *bu
   return flatcc_verify_table_as_root(buf, bufsiz, thash ? (const char *)&thash : 0, &__reflection_Schema_table_verifier);
 }
 
+static inline int reflection_Schema_verify_as_root_memoized(const void *buf, size_t bufsiz, void *scratch, size_t scratch_size)
+{
+    return flatcc_verify_table_as_root_memoized(buf, bufsiz, reflection_Schema_identifier, &__reflection_Schema_table_verifier, scratch, scratch_size);
+}
+
+static inline int reflection_Schema_verify_as_root_parallel(const void *buf, size_t bufsiz, flatcc_verify_runner_f *runner, void *runner_context)
+{
+    return flatcc_verify_table_as_root_parallel(buf, bufsiz, reflection_Schema_identifier, &__reflection_Schema_table_verifier, runner, runner_context);
+}
+
+static inline int reflection_Schema_verify_as_root_with_mask(const void *buf, size_t bufsiz, const flatcc_verify_mask_t *mask)
+{
+    return flatcc_verify_table_as_root_with_mask(buf, bufsiz, reflection_Schema_identifier, &__reflection_Schema_table_verifier, mask);
+}
+
+static inline int reflection_Schema_verify_as_root_with_flags(const void *buf, size_t bufsiz, int flags)
+{
+    return flatcc_verify_table_as_root_with_flags(buf, bufsiz, reflection_Schema_identifier, &__reflection_Schema_table_verifier, flags);
+}
+
 #include "flatcc/portable/pdiagnostic_pop.h"
 #endif /* REFLECTION_VERIFIER_H */
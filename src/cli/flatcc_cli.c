@@ -33,6 +33,8 @@ void usage(FILE *fp)
             "  --json-parser              Generate json parser for schema\n"
             "  --json-printer             Generate json printer for schema\n"
             "  --json                     Generate both json parser and printer for schema\n"
+            "  --vtable-dict              Generate builder with static vtable dictionary\n"
+            "  --verifier-specs           Generate verifier as field specs for the runtime\n"
             "  --version                  Show version\n"
             "  -h | --help                Help message\n"
     );
@@ -86,6 +88,17 @@ void help(FILE *fp)
         "\n"
         "--json is generates both printer and parser.\n"
         "\n"
+        "--vtable-dict implies -w and adds a `<schema>_vtable_dict()` function to\n"
+        "each builder file. The static dictionary holds the vtables of empty tables\n"
+        "and of tables created with all fields present, and can be attached to a\n"
+        "builder with `flatcc_builder_set_vtable_dict`.\n"
+        "\n"
+        "--verifier-specs implies -v and generates each table verifier as a\n"
+        "static array of field specs interpreted by the runtime library instead\n"
+        "of as a function, which gives less code for large schemas. Memoized,\n"
+        "parallel and masked verification are not available in this mode. All\n"
+        "verifiers of included schema must be generated in the same mode.\n"
+        "\n"
         "The generated source can redefine offset sizes by including a modified\n"
         "`flatcc_types.h` file. The flatbuilder library must then be compiled with the\n"
         "same `flatcc_types.h` file. In this case --prefix and --common-prefix options\n"
@@ -162,6 +175,16 @@ int set_opt(flatcc_options_t *opts, const char *s, const char *a)
         opts->cgen_json_printer = 1;
         return noarg;
     }
+    if (0 == strcmp("-vtable-dict", s)) {
+        opts->cgen_builder = 1;
+        opts->cgen_vtable_dict = 1;
+        return noarg;
+    }
+    if (0 == strcmp("-verifier-specs", s)) {
+        opts->cgen_verifier = 1;
+        opts->cgen_verifier_specs = 1;
+        return noarg;
+    }
 #if FLATCC_REFLECTION
     if (match_long_arg("-schema-namespace", s, n)) {
         if (!a) {
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "flatcc/flatcc_version.h"
+#include "flatcc/flatcc_builder.h"
+#include "flatcc/flatcc_compact.h"
+#include "flatcc/support/readfile.h"
+
+#define VERSION FLATCC_VERSION_TEXT
+
+/* Large enough for any buffer with 32-bit offsets. */
+#define MAX_FILE_SIZE ((size_t)1 << 31)
+
+void usage(FILE *fp)
+{
+    fprintf(fp, "flatcc_compact: rewrite a flatbuffer into a compact layout\n");
+    fprintf(fp, "version: %s\n", VERSION);
+    fprintf(fp, "usage: flatcc_compact [options] schema.bfbs input output\n");
+    fprintf(fp, "options:\n"
+            "  -q                         Do not report sizes\n"
+            "  --version                  Show version\n"
+            "  -h | --help                Help message\n"
+    );
+}
+
+void help(FILE *fp)
+{
+    usage(fp);
+    fprintf(fp,
+        "\n"
+        "Reads a buffer and writes it again with identical vtables, strings,\n"
+        "structs, scalar vectors and leaf tables stored once, and with all\n"
+        "vtables clustered at the end of the buffer. The buffer is interpreted\n"
+        "through a binary schema with a root type, generated with\n"
+        "`flatcc --schema`, so no generated code is needed.\n"
+        "\n"
+        "Deprecated fields and union values of unknown types are dropped.\n"
+        "Size prefixed buffers and streams are not supported.\n"
+        "\n"
+        "The input is range checked but not verified. Buffers from untrusted\n"
+        "sources should be verified before and after compaction.\n");
+}
+
+int main(int argc, const char *argv[])
+{
+    flatcc_builder_t builder, *B = &builder;
+    const char *files[3];
+    char *schema = 0, *input = 0;
+    void *output = 0;
+    size_t schema_size, input_size, output_size;
+    int i, nfiles = 0, quiet = 0, ret = -1;
+    FILE *fp;
+
+    for (i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            /* stdout so less and more works. */
+            help(stdout);
+            return 0;
+        }
+        if (strcmp(argv[i], "--version") == 0) {
+            fprintf(stderr, "flatcc_compact\n");
+            fprintf(stderr, "version: %s\n", VERSION);
+            return 0;
+        }
+        if (strcmp(argv[i], "-q") == 0) {
+            quiet = 1;
+            continue;
+        }
+        if (argv[i][0] == '-' || nfiles == 3) {
+            usage(stderr);
+            return -1;
+        }
+        files[nfiles++] = argv[i];
+    }
+    if (nfiles != 3) {
+        usage(stderr);
+        return -1;
+    }
+    if (!(schema = readfile(files[0], MAX_FILE_SIZE, &schema_size))) {
+        fprintf(stderr, "could not read schema: %s\n", files[0]);
+        goto done;
+    }
+    if (!(input = readfile(files[1], MAX_FILE_SIZE, &input_size))) {
+        fprintf(stderr, "could not read input: %s\n", files[1]);
+        goto done;
+    }
+    flatcc_builder_init(B);
+    if (flatcc_compact_buffer(B, schema, schema_size, input, input_size)) {
+        fprintf(stderr, "could not compact %s with schema %s\n", files[1], files[0]);
+        goto cleanup;
+    }
+    if (!(output = flatcc_builder_finalize_aligned_buffer(B, &output_size))) {
+        fprintf(stderr, "out of memory\n");
+        goto cleanup;
+    }
+    if (!(fp = fopen(files[2], "wb"))) {
+        fprintf(stderr, "could not open output: %s\n", files[2]);
+        goto cleanup;
+    }
+    if (fwrite(output, 1, output_size, fp) != output_size) {
+        fprintf(stderr, "could not write output: %s\n", files[2]);
+        fclose(fp);
+        goto cleanup;
+    }
+    fclose(fp);
+    if (!quiet) {
+        printf("input: %lu bytes, output: %lu bytes, saved: %ld bytes\n",
+                (unsigned long)input_size, (unsigned long)output_size,
+                (long)input_size - (long)output_size);
+    }
+    ret = 0;
+cleanup:
+    flatcc_builder_aligned_free(output);
+    flatcc_builder_clear(B);
+done:
+    free(schema);
+    free(input);
+    return ret;
+}
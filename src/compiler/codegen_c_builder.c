@@ -19,6 +19,7 @@ int fb_gen_common_c_builder_header(output_t *out)
     fprintf(out->fp, "#ifndef FLATBUILDER_H\n");
     fprintf(out->fp, "#include \"flatcc/flatcc_builder.h\"\n");
     fprintf(out->fp, "#endif\n");
+    fprintf(out->fp, "#include \"flatcc/flatcc_refmap.h\"\n");
     if (strcmp(nsc, "flatcc_builder_")) {
         fprintf(out->fp, "typedef flatcc_builder_t %sbuilder_t;\n", nsc);
         fprintf(out->fp, "typedef flatcc_builder_ref_t %sref_t;\n", nsc);
@@ -33,6 +34,30 @@ int fb_gen_common_c_builder_header(output_t *out)
         fprintf(out->fp, "typedef flatbuffers_fid_t %sfid_t;\n", nsc);
     }
     fprintf(out->fp, "\n");
+    fprintf(out->fp,
+        "/* Upper bounds on emitted sizes including padding, see `flatcc_builder_reserve`. */\n"
+        "#define __%svec_estimate_size(n, S, A)\\\n"
+        "  (sizeof(flatbuffers_uoffset_t) + (size_t)(n) * (S) + ((A) > sizeof(flatbuffers_uoffset_t) ? (A) : sizeof(flatbuffers_uoffset_t)) - 1)\n"
+        "\n",
+        nsc);
+    fprintf(out->fp,
+        "/*\n"
+        " * Clones return the ref recorded for a source object in the builders\n"
+        " * refmap, if any, and record new clones. Empty vectors are not\n"
+        " * recorded because their address may be that of the next object.\n"
+        " */\n"
+        "#define __%smemoize_begin(B, src)\\\n"
+        "do { %sref_t _ref; if ((_ref = flatcc_builder_refmap_find((B), (src)))) return _ref; } while (0)\n"
+        "#define __%smemoize_end(B, src, op) do { return flatcc_builder_refmap_insert((B), (src), (op)); } while (0)\n"
+        "#define __%smemoize(B, src, op) do { __%smemoize_begin(B, src); __%smemoize_end(B, src, op); } while (0)\n"
+        "#define __%smemoize_vec(B, vec, op)\\\n"
+        "do { if (!%svec_len(vec)) return (op); __%smemoize(B, vec, op); } while (0)\n"
+        "/* Copies a scalar or struct table field as is, without endian conversion. */\n"
+        "static inline int __%sclone_field(%sbuilder_t *B, const void *t, %svoffset_t field_id, size_t size, uint16_t align)\n"
+        "{ __%sread_vt(field_id, offset, t)\n"
+        "  return offset && !flatcc_builder_table_add_copy(B, field_id, (const uint8_t *)t + offset, size, align) ? -1 : 0; }\n"
+        "\n",
+        nsc, nsc, nsc, nsc, nsc, nsc, nsc, nsc, nsc, nsc, nsc, nsc, nsc);
     fprintf(out->fp,
         "#define __%sbuild_buffer(NS)\\\n"
         "typedef NS ## ref_t NS ## buffer_ref_t;\\\n"
@@ -41,12 +66,20 @@ int fb_gen_common_c_builder_header(output_t *out)
         "static inline int NS ## buffer_start_aligned(NS ## builder_t *B, NS ##fid_t fid, uint16_t block_align)\\\n"
         "{ return flatcc_builder_start_buffer(B, fid, block_align); }\\\n"
         "static inline NS ## buffer_ref_t NS ## buffer_end(NS ## builder_t *B, NS ## ref_t root)\\\n"
-        "{ return flatcc_builder_end_buffer(B, root); }\n"
+        "{ return flatcc_builder_end_buffer(B, root); }\\\n"
+        "static inline size_t NS ## buffer_estimate_size(size_t size, uint16_t align)\\\n"
+        "{ if (align < sizeof(flatbuffers_uoffset_t)) align = sizeof(flatbuffers_uoffset_t);\\\n"
+        "  return size + 3 * sizeof(flatbuffers_uoffset_t) + 2 * ((size_t)align - 1); }\n"
         "\n",
         nsc);
 
     fprintf(out->fp,
         "#define __%sbuild_table_root(NS, N, FID, TFID)\\\n"
+        "static inline NS ## buffer_ref_t N ## _clone_as_buffer(NS ## builder_t *B, NS ## fid_t fid, N ## _table_t t)\\\n"
+        "{ flatcc_refmap_t refmap, *refmap_old; NS ## buffer_ref_t ref = 0;\\\n"
+        "  flatcc_refmap_init(&refmap); refmap_old = flatcc_builder_set_refmap(B, &refmap);\\\n"
+        "  if (!NS ## buffer_start(B, fid)) { ref = NS ## buffer_end(B, N ## _clone(B, t)); }\\\n"
+        "  flatcc_builder_set_refmap(B, refmap_old); flatcc_refmap_clear(&refmap); return ref; }\\\n"
         "static inline int N ## _start_as_root(NS ## builder_t *B)\\\n"
         "{ return NS ## buffer_start(B, FID) ? -1 : N ## _start(B); }\\\n"
         "static inline int N ## _start_as_typed_root(NS ## builder_t *B)\\\n"
@@ -63,7 +96,11 @@ int fb_gen_common_c_builder_header(output_t *out)
         "static inline NS ## buffer_ref_t N ## _create_as_root(NS ## builder_t *B __ ## N ## _formal_args)\\\n"
         "{ if (NS ## buffer_start(B, FID)) return 0; return NS ## buffer_end(B, N ## _create(B __ ## N ## _call_args)); }\\\n"
         "static inline NS ## buffer_ref_t N ## _create_as_typed_root(NS ## builder_t *B __ ## N ## _formal_args)\\\n"
-        "{ if (NS ## buffer_start(B, TFID)) return 0; return NS ## buffer_end(B, N ## _create(B __ ## N ## _call_args)); }\n"
+        "{ if (NS ## buffer_start(B, TFID)) return 0; return NS ## buffer_end(B, N ## _create(B __ ## N ## _call_args)); }\\\n"
+        "static inline NS ## buffer_ref_t N ## _clone_as_root(NS ## builder_t *B, N ## _table_t t)\\\n"
+        "{ return N ## _clone_as_buffer(B, FID, t); }\\\n"
+        "static inline NS ## buffer_ref_t N ## _clone_as_typed_root(NS ## builder_t *B, N ## _table_t t)\\\n"
+        "{ return N ## _clone_as_buffer(B, TFID, t); }\n"
         "\n",
         nsc);
 
@@ -169,29 +206,37 @@ int fb_gen_common_c_builder_header(output_t *out)
         nsc);
 
     fprintf(out->fp,
-        /* NS: common namespace, N: typename, T: element type, S: elem size, A: alignment */
-        "#define __%sbuild_vector(NS, N, T, S, A)\\\n"
+        /*
+         * NS: common namespace, N: typename, T: element type, S: elem size, A: alignment,
+         * W: byte swap width when all fields have that size, or 0 for per field conversion.
+         */
+        "#define __%sbuild_vector(NS, N, T, S, A, W)\\\n"
         "typedef NS ## ref_t N ## _vec_ref_t;\\\n"
         "static inline int N ## _vec_start(NS ## builder_t *B)\\\n"
         "{ return flatcc_builder_start_vector(B, S, A, FLATBUFFERS_COUNT_MAX(S)); }\\\n"
         "static inline N ## _vec_ref_t N ## _vec_end_pe(NS ## builder_t *B)\\\n"
         "{ return flatcc_builder_end_vector(B); }\\\n"
         "static inline N ## _vec_ref_t N ## _vec_end(NS ## builder_t *B)\\\n"
-        "{ if (!NS ## is_native_pe()) { size_t i, n; T *p = flatcc_builder_vector_edit(B);\\\n"
+        "{ if (!NS ## is_native_pe()) { size_t i, n; T *p; if (W) return flatcc_builder_end_byteswapped_vector(B, W);\\\n"
+        "    p = flatcc_builder_vector_edit(B);\\\n"
         "    for (i = 0, n = flatcc_builder_vector_count(B); i < n; ++i)\\\n"
         "    { N ## _to_pe(N ## __ptr_add(p, i)); }} return flatcc_builder_end_vector(B); }\\\n"
         "static inline N ## _vec_ref_t N ## _vec_create_pe(NS ## builder_t *B, const T *data, size_t len)\\\n"
         "{ return flatcc_builder_create_vector(B, data, len, S, A, FLATBUFFERS_COUNT_MAX(S)); }\\\n"
         "static inline N ## _vec_ref_t N ## _vec_create(NS ## builder_t *B, const T *data, size_t len)\\\n"
-        "{ if (!NS ## is_native_pe()) { size_t i; T *p; int ret = flatcc_builder_start_vector(B, S, A, FLATBUFFERS_COUNT_MAX(S)); if (ret) { return ret; }\\\n"
+        "{ if (!NS ## is_native_pe()) { size_t i; T *p; int ret;\\\n"
+        "  if (W) return flatcc_builder_create_byteswapped_vector(B, data, len, S, W, A, FLATBUFFERS_COUNT_MAX(S));\\\n"
+        "  ret = flatcc_builder_start_vector(B, S, A, FLATBUFFERS_COUNT_MAX(S)); if (ret) { return ret; }\\\n"
         "  p = flatcc_builder_extend_vector(B, len); if (!p) return 0;\\\n"
         "  for (i = 0; i < len; ++i) { N ## _copy_to_pe(N ## __ptr_add(p, i), N ## __const_ptr_add(data, i)); }\\\n"
         "  return flatcc_builder_end_vector(B); } else return flatcc_builder_create_vector(B, data, len, S, A, FLATBUFFERS_COUNT_MAX(S)); }\\\n"
         "static inline N ## _vec_ref_t N ## _vec_clone(NS ## builder_t *B, N ##_vec_t vec)\\\n"
-        "{ return flatcc_builder_create_vector(B, vec, N ## _vec_len(vec), S, A, FLATBUFFERS_COUNT_MAX(S)); }\\\n"
+        "{ __ ## NS ## memoize_vec(B, vec, flatcc_builder_create_vector(B, vec, N ## _vec_len(vec), S, A, FLATBUFFERS_COUNT_MAX(S))); }\\\n"
         "static inline N ## _vec_ref_t N ## _vec_slice(NS ## builder_t *B, N ##_vec_t vec, size_t index, size_t len)\\\n"
         "{ size_t n = N ## _vec_len(vec); if (index >= n) index = n; n -= index; if (len > n) len = n;\\\n"
         "  return flatcc_builder_create_vector(B, N ## __const_ptr_add(vec, index), len, S, A, FLATBUFFERS_COUNT_MAX(S)); }\\\n"
+        "static inline size_t N ## _vec_estimate_size(size_t len)\\\n"
+        "{ return __ ## NS ## vec_estimate_size(len, S, A); }\\\n"
         "__%sbuild_vector_ops(NS, N ## _vec, N, N, T)\n"
         "\n",
         nsc, nsc);
@@ -209,6 +254,12 @@ int fb_gen_common_c_builder_header(output_t *out)
         "{ return NS ## string_vec_push(B, NS ## string_create_str(B, s)); }\\\n"
         "static inline NS ## string_ref_t *N ## _push_create_strn(NS ## builder_t *B, const char *s, size_t max_len)\\\n"
         "{ return NS ## string_vec_push(B, NS ## string_create_strn(B, s, max_len)); }\\\n"
+        "static inline NS ## string_ref_t *N ## _push_create_shared(NS ## builder_t *B, const char *s, size_t len)\\\n"
+        "{ return NS ## string_vec_push(B, NS ## string_create_shared(B, s, len)); }\\\n"
+        "static inline NS ## string_ref_t *N ## _push_create_shared_str(NS ## builder_t *B, const char *s)\\\n"
+        "{ return NS ## string_vec_push(B, NS ## string_create_shared_str(B, s)); }\\\n"
+        "static inline NS ## string_ref_t *N ## _push_create_shared_strn(NS ## builder_t *B, const char *s, size_t max_len)\\\n"
+        "{ return NS ## string_vec_push(B, NS ## string_create_shared_strn(B, s, max_len)); }\\\n"
         "static inline NS ## string_ref_t *N ## _push_clone(NS ## builder_t *B, NS ## string_t string)\\\n"
         "{ return NS ## string_vec_push(B, NS ## string_clone(B, string)); }\\\n"
         "static inline NS ## string_ref_t *N ## _push_slice(NS ## builder_t *B, NS ## string_t string, size_t index, size_t len)\\\n"
@@ -254,6 +305,14 @@ int fb_gen_common_c_builder_header(output_t *out)
         "{ return flatcc_builder_end_offset_vector(B); }\\\n"
         "static inline N ## _vec_ref_t N ## _vec_create(NS ## builder_t *B, const N ## _ref_t *data, size_t len)\\\n"
         "{ return flatcc_builder_create_offset_vector(B, data, len); }\\\n"
+        "static inline N ## _vec_ref_t N ## _vec_clone(NS ## builder_t *B, N ##_vec_t vec)\\\n"
+        "{ size_t i, n = N ## _vec_len(vec); NS ## ref_t ref; if (n) { __ ## NS ## memoize_begin(B, vec); }\\\n"
+        "  if (flatcc_builder_start_offset_vector(B)) { return 0; }\\\n"
+        "  for (i = 0; i < n; ++i) { if (!(ref = N ## _clone(B, N ## _vec_at(vec, i)))\\\n"
+        "    || !flatcc_builder_offset_vector_push(B, ref)) { return 0; } }\\\n"
+        "  ref = flatcc_builder_end_offset_vector(B); return n ? flatcc_builder_refmap_insert(B, vec, ref) : ref; }\\\n"
+        "static inline size_t N ## _vec_estimate_size(size_t len)\\\n"
+        "{ return __ ## NS ## vec_estimate_size(len, sizeof(flatbuffers_uoffset_t), sizeof(flatbuffers_uoffset_t)); }\\\n"
         "__%sbuild_offset_vector_ops(NS, N ## _vec, N, N)\n"
         "\n",
         nsc, nsc);
@@ -290,11 +349,19 @@ int fb_gen_common_c_builder_header(output_t *out)
         "{ return flatcc_builder_create_string_str(B, s); }\\\n"
         "static inline NS ## ref_t NS ## string_create_strn(NS ## builder_t *B, const char *s, size_t len)\\\n"
         "{ return flatcc_builder_create_string_strn(B, s, len); }\\\n"
+        "static inline NS ## ref_t NS ## string_create_shared(NS ## builder_t *B, const char *s, size_t len)\\\n"
+        "{ return flatcc_builder_create_shared_string(B, s, len); }\\\n"
+        "static inline NS ## ref_t NS ## string_create_shared_str(NS ## builder_t *B, const char *s)\\\n"
+        "{ return flatcc_builder_create_shared_string_str(B, s); }\\\n"
+        "static inline NS ## ref_t NS ## string_create_shared_strn(NS ## builder_t *B, const char *s, size_t len)\\\n"
+        "{ return flatcc_builder_create_shared_string_strn(B, s, len); }\\\n"
         "static inline NS ## string_ref_t NS ## string_clone(NS ## builder_t *B, NS ## string_t string)\\\n"
-        "{ return flatcc_builder_create_string(B, string, NS ## string_len(string)); }\\\n"
+        "{ __ ## NS ## memoize(B, string, flatcc_builder_create_string(B, string, NS ## string_len(string))); }\\\n"
         "static inline NS ## string_ref_t NS ## string_slice(NS ## builder_t *B, NS ## string_t string, size_t index, size_t len)\\\n"
         "{ size_t n = NS ## string_len(string); if (index >= n) index = n; n -= index; if (len > n) len = n;\\\n"
         "  return flatcc_builder_create_string(B, string + index, len); }\\\n"
+        "static inline size_t NS ## string_estimate_size(size_t len)\\\n"
+        "{ return __ ## NS ## vec_estimate_size(len + 1, 1, 1); }\\\n"
         "__%sbuild_string_ops(NS, NS ## string)\\\n"
         "__%sbuild_offset_vector(NS, NS ## string)\n"
         "\n",
@@ -321,7 +388,7 @@ int fb_gen_common_c_builder_header(output_t *out)
         "{ *p = N ## _cast_to_pe(v0); return p; }\n"
         "#define __%sbuild_scalar(NS, N, T)\\\n"
         "__ ## NS ## define_scalar_primitives(NS, N, T)\\\n"
-        "__ ## NS ## build_vector(NS, N, T, sizeof(T), sizeof(T))\n",
+        "__ ## NS ## build_vector(NS, N, T, sizeof(T), sizeof(T), sizeof(T))\n",
         nsc, nsc);
 
     fprintf(out->fp,
@@ -334,7 +401,7 @@ int fb_gen_common_c_builder_header(output_t *out)
         "static inline N ## _t *N ## _clear(N ## _t *p) { return memset(p, 0, N ## __size()); }\n"
         "\n"
         "/* Depends on generated copy/assign_to/from_pe functions, and the type. */\n"
-        "#define __%sbuild_struct(NS, N, S, A, FID, TFID)\\\n"
+        "#define __%sbuild_struct(NS, N, S, A, FID, TFID, W)\\\n"
         "__ ## NS ## define_struct_primitives(NS, N)\\\n"
         "typedef NS ## ref_t N ## _ref_t;\\\n"
         "static inline N ## _t *N ## _start(NS ## builder_t *B)\\\n"
@@ -347,7 +414,7 @@ int fb_gen_common_c_builder_header(output_t *out)
         "static inline N ## _ref_t N ## _create(NS ## builder_t *B __ ## N ## _formal_args)\\\n"
         "{ N ## _t *_p = N ## _start(B); if (!_p) return 0; N ##_assign_to_pe(_p __ ## N ## _call_args);\\\n"
         "  return N ## _end(B); }\\\n"
-        "__%sbuild_vector(NS, N, N ## _t, S, A)\\\n"
+        "__%sbuild_vector(NS, N, N ## _t, S, A, W)\\\n"
         "__%sbuild_struct_root(NS, N, A, FID, TFID)\n"
         "\n",
         nsc, nsc, nsc, nsc);
@@ -355,6 +422,7 @@ int fb_gen_common_c_builder_header(output_t *out)
     fprintf(out->fp,
         "#define __%sbuild_table(NS, N, K)\\\n"
         "typedef NS ## ref_t N ## _ref_t;\\\n"
+        "static inline N ## _ref_t N ## _clone(NS ## builder_t *B, N ## _table_t t);\\\n"
         "static inline int N ## _start(NS ## builder_t *B)\\\n"
         "{ return flatcc_builder_start_table(B, K); }\\\n"
         "static inline N ## _ref_t N ## _end(NS ## builder_t *B)\\\n"
@@ -365,6 +433,13 @@ int fb_gen_common_c_builder_header(output_t *out)
         "\n",
         nsc, nsc);
 
+    fprintf(out->fp,
+        "/* S: upper bound on the table and its vtable excluding referenced objects. */\n"
+        "#define __%sbuild_table_estimate(NS, N, S)\\\n"
+        "static inline size_t N ## _estimate_size(void) { return S; }\n"
+        "\n",
+        nsc);
+
     fprintf(out->fp,
         "#define __%sbuild_table_field(ID, NS, N, TN)\\\n"
         "static inline int N ## _add(NS ## builder_t *B, TN ## _ref_t ref)\\\n"
@@ -375,7 +450,9 @@ int fb_gen_common_c_builder_header(output_t *out)
         "static inline int N ## _end(NS ## builder_t *B)\\\n"
         "{ return N ## _add(B, TN ## _end(B)); }\\\n"
         "static inline TN ## _ref_t N ## _create(NS ## builder_t *B __ ## TN ##_formal_args)\\\n"
-        "{ return N ## _add(B, TN ## _create(B __ ## TN ## _call_args)); }\n"
+        "{ return N ## _add(B, TN ## _create(B __ ## TN ## _call_args)); }\\\n"
+        "static inline int N ## _clone(NS ## builder_t *B, TN ## _table_t t)\\\n"
+        "{ return N ## _add(B, TN ## _clone(B, t)); }\n"
         "\n",
         nsc);
 
@@ -383,7 +460,7 @@ int fb_gen_common_c_builder_header(output_t *out)
         "#define __%sbuild_union_field(ID, NS, N, TN)\\\n"
         "static inline int N ## _add(NS ## builder_t *B, TN ## _union_ref_t uref)\\\n"
         "{ NS ## ref_t *_p; TN ## _union_type_t *_pt; if (uref.type == TN ## _NONE) return 0; if (uref._member == 0) return -1;\\\n"
-        "  if (!(_pt = flatcc_builder_table_add(B, ID - 1, sizeof(*_pt), sizeof(_pt))) ||\\\n"
+        "  if (!(_pt = flatcc_builder_table_add(B, ID - 1, sizeof(*_pt), sizeof(*_pt))) ||\\\n"
         "  !(_p = flatcc_builder_table_add_offset(B, ID))) return -1; *_pt = uref.type; *_p = uref._member; return 0; }\\\n"
         "static inline int N ## _add_type(NS ## builder_t *B, TN ## _union_type_t type)\\\n"
         "{ TN ## _union_type_t *_pt; if (type == TN ## _NONE) return 0; return (_pt = flatcc_builder_table_add(B, ID - 1,\\\n"
@@ -469,6 +546,8 @@ int fb_gen_common_c_builder_header(output_t *out)
         "{ return N ## _add(B, flatcc_builder_end_offset_vector(B)); }\\\n"
         "static inline int N ## _create(NS ## builder_t *B, const TN ## _ref_t *data, size_t len)\\\n"
         "{ return N ## _add(B, flatcc_builder_create_offset_vector(B, data, len)); }\\\n"
+        "static inline int N ## _clone(NS ## builder_t *B, TN ## _vec_t vec)\\\n"
+        "{ return N ## _add(B, TN ## _vec_clone(B, vec)); }\\\n"
         "__%sbuild_offset_vector_ops(NS, N, N, TN)\n"
         "\n",
         nsc, nsc);
@@ -487,6 +566,12 @@ int fb_gen_common_c_builder_header(output_t *out)
         "{ return N ## _add(B, flatcc_builder_create_string_str(B, s)); }\\\n"
         "static inline int N ## _create_strn(NS ## builder_t *B, const char *s, size_t max_len)\\\n"
         "{ return N ## _add(B, flatcc_builder_create_string_strn(B, s, max_len)); }\\\n"
+        "static inline int N ## _create_shared(NS ## builder_t *B, const char *s, size_t len)\\\n"
+        "{ return N ## _add(B, flatcc_builder_create_shared_string(B, s, len)); }\\\n"
+        "static inline int N ## _create_shared_str(NS ## builder_t *B, const char *s)\\\n"
+        "{ return N ## _add(B, flatcc_builder_create_shared_string_str(B, s)); }\\\n"
+        "static inline int N ## _create_shared_strn(NS ## builder_t *B, const char *s, size_t max_len)\\\n"
+        "{ return N ## _add(B, flatcc_builder_create_shared_string_strn(B, s, max_len)); }\\\n"
         "static inline int N ## _clone(NS ## builder_t *B, NS ## string_t string)\\\n"
         "{ return N ## _add(B, NS ## string_clone(B, string)); }\\\n"
         "static inline int N ## _slice(NS ## builder_t *B, NS ## string_t string, size_t index, size_t len)\\\n"
@@ -841,6 +926,57 @@ static int gen_builder_struct_field_assign(output_t *out, fb_compound_type_t *ct
     return index;
 }
 
+/*
+ * Checks that all fields, including fields of nested structs, have the
+ * size `*width`, or sets it from the first field. Returns the total
+ * size of the fields, or 0 if they differ or a field is deprecated.
+ */
+static uint64_t get_struct_uniform_field_size(fb_compound_type_t *ct, int *width)
+{
+    fb_member_t *member;
+    fb_symbol_t *sym;
+    uint64_t size, total = 0;
+
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member->metadata_flags & fb_f_deprecated) {
+            return 0;
+        }
+        if (member->type.type == vt_compound_type_ref &&
+                member->type.ct->symbol.kind == fb_is_struct) {
+            if (!(size = get_struct_uniform_field_size(member->type.ct, width))) {
+                return 0;
+            }
+            total += size;
+            continue;
+        }
+        if (*width == 0) {
+            *width = (int)member->size;
+        }
+        if ((int)member->size != *width) {
+            return 0;
+        }
+        total += member->size;
+    }
+    return total;
+}
+
+/*
+ * Vectors of structs can be converted to protocol endian with a bulk
+ * byte swap when all fields have the same size and there is no padding
+ * that per field conversion would leave untouched. Returns the field
+ * size, or 0 if fields must be converted one at a time.
+ */
+static int get_struct_swap_width(fb_compound_type_t *ct)
+{
+    int width = 0;
+
+    if (get_struct_uniform_field_size(ct, &width) != ct->size) {
+        return 0;
+    }
+    return width;
+}
+
 static void gen_builder_struct(output_t *out, fb_compound_type_t *ct)
 {
     const char *nsc = out->nsc;
@@ -897,8 +1033,9 @@ static void gen_builder_struct(output_t *out, fb_compound_type_t *ct)
     fprintf(out->fp, "{ ");
     gen_builder_struct_field_assign(out, ct, 0, arg_count, convert_from_pe, 1);
     fprintf(out->fp, "return p; }\n");
-    fprintf(out->fp, "__%sbuild_struct(%s, %s, %llu, %u, %s_identifier, %s_type_identifier)\n",
-            nsc, nsc, snt.text, llu(ct->size), ct->align, snt.text, snt.text);
+    fprintf(out->fp, "__%sbuild_struct(%s, %s, %llu, %u, %s_identifier, %s_type_identifier, %d)\n",
+            nsc, nsc, snt.text, llu(ct->size), ct->align, snt.text, snt.text,
+            get_struct_swap_width(ct));
 }
 
 static int get_create_table_arg_count(fb_compound_type_t *ct)
@@ -1121,6 +1258,63 @@ static int gen_builder_create_table(output_t *out, fb_compound_type_t *ct)
     return 0;
 }
 
+/*
+ * Scalar and struct fields are copied as is. Offset fields are cloned
+ * recursively and shared objects are reused via the builders refmap.
+ */
+static int gen_builder_clone_table(output_t *out, fb_compound_type_t *ct)
+{
+    const char *nsc = out->nsc;
+    fb_member_t *member;
+    int n;
+    const char *s;
+    fb_scoped_name_t snt;
+    fb_scoped_name_t snref;
+
+    fb_clear(snt);
+    fb_clear(snref);
+    fb_compound_name(ct, &snt);
+
+    fprintf(out->fp,
+            "static inline %s_ref_t %s_clone(%sbuilder_t *B, %s_table_t t)\n",
+            snt.text, snt.text, nsc, snt.text);
+    fprintf(out->fp, "{\n    __%smemoize_begin(B, t);\n    if (%s_start(B)", nsc, snt.text);
+    for (member = ct->ordered_members; member; member = member->order) {
+        if (member->metadata_flags & fb_f_deprecated) {
+            continue;
+        }
+        symbol_name(&member->symbol, &n, &s);
+        switch (member->type.type) {
+        case vt_scalar_type:
+            break;
+        case vt_compound_type_ref:
+            switch (member->type.ct->symbol.kind) {
+            case fb_is_struct:
+            case fb_is_enum:
+                break;
+            case fb_is_union:
+                fb_compound_name(member->type.ct, &snref);
+                fprintf(out->fp, "\n        || %s_%.*s_add(B, %s_clone(B, %s_%.*s_type(t), %s_%.*s(t)))",
+                        snt.text, n, s, snref.text, snt.text, n, s, snt.text, n, s);
+                continue;
+            default:
+                fprintf(out->fp, "\n        || (%s_%.*s_is_present(t) && %s_%.*s_clone(B, %s_%.*s(t)))",
+                        snt.text, n, s, snt.text, n, s, snt.text, n, s);
+                continue;
+            }
+            break;
+        default:
+            fprintf(out->fp, "\n        || (%s_%.*s_is_present(t) && %s_%.*s_clone(B, %s_%.*s(t)))",
+                    snt.text, n, s, snt.text, n, s, snt.text, n, s);
+            continue;
+        }
+        fprintf(out->fp, "\n        || __%sclone_field(B, t, %llu, %llu, %u)",
+                nsc, llu(member->id), llu(member->size), member->align);
+    }
+    fprintf(out->fp, ") {\n        return 0;\n    }\n    __%smemoize_end(B, t, %s_end(B));\n}\n", nsc, snt.text);
+    return 0;
+}
+
 static int gen_builder_structs(output_t *out)
 {
     fb_compound_type_t *ct;
@@ -1146,6 +1340,75 @@ static int gen_builder_table(output_t *out, fb_compound_type_t *ct)
     return 0;
 }
 
+/*
+ * Upper bound on the bytes emitted for a table, not counting referenced
+ * objects: the table header, each field with worst case alignment
+ * padding, padding before the table, and a vtable with room for all
+ * fields. Offsets and vtable entries depend on the configured offset
+ * sizes, so the bound is generated as an expression in these.
+ */
+static int gen_builder_table_estimate(output_t *out, fb_compound_type_t *ct)
+{
+    const char *nsc = out->nsc;
+    fb_scoped_name_t snt;
+    fb_member_t *member;
+    fb_symbol_t *sym;
+    uint64_t size = 0, offset_count = 0, align, max_align = 1;
+
+    fb_clear(snt);
+    fb_compound_name(ct, &snt);
+
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member->metadata_flags & fb_f_deprecated) {
+            continue;
+        }
+        switch (member->type.type) {
+        case vt_scalar_type:
+            size += member->size;
+            align = member->align;
+            break;
+        case vt_compound_type_ref:
+            switch (member->type.ct->symbol.kind) {
+            case fb_is_struct:
+                size += member->type.ct->size;
+                align = member->type.ct->align;
+                break;
+            case fb_is_enum:
+                size += member->size;
+                align = member->align;
+                break;
+            case fb_is_union:
+                /* Hidden type field and value offset. */
+                size += 1;
+                ++offset_count;
+                continue;
+            default:
+                ++offset_count;
+                continue;
+            }
+            break;
+        default:
+            /* Strings, vectors, and tables are offsets. */
+            ++offset_count;
+            continue;
+        }
+        size += align - 1;
+        if (max_align < align) {
+            max_align = align;
+        }
+    }
+    /* Header, offsets with padding, table alignment, vtable and its padding. */
+    fprintf(out->fp,
+            "__%sbuild_table_estimate(%s, %s, (%llu + %llu * (2 * sizeof(%suoffset_t) - 1) + sizeof(%suoffset_t)"
+            " + (%llu > sizeof(%suoffset_t) ? %llu : sizeof(%suoffset_t)) - 1"
+            " + %llu * sizeof(%svoffset_t) + sizeof(%suoffset_t) - 1))\n",
+            nsc, nsc, snt.text, llu(size), llu(offset_count), nsc, nsc,
+            llu(max_align), nsc, llu(max_align), nsc,
+            llu((uint64_t)ct->count + 2), nsc, nsc);
+    return 0;
+}
+
 static int gen_builder_table_prolog(output_t *out, fb_compound_type_t *ct)
 {
     const char *nsc = out->nsc;
@@ -1483,6 +1746,25 @@ static int gen_union(output_t *out, fb_compound_type_t *ct)
             break;
         }
     }
+    /* Unknown member types cannot be cloned and are cloned as NONE. */
+    fprintf(out->fp,
+        "static inline %s_union_ref_t %s_clone(%sbuilder_t *B, %s_union_type_t type, %sgeneric_table_t t)\n"
+        "{\n    switch (type) {\n",
+        snt.text, snt.text, nsc, snt.text, nsc);
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member->type.type != vt_compound_type_ref) {
+            continue;
+        }
+        fb_compound_name((fb_compound_type_t *)member->type.ct, &snref);
+        symbol_name(sym, &n, &s);
+        fprintf(out->fp,
+            "    case %s_%.*s: return %s_as_%.*s(%s_clone(B, t));\n",
+            snt.text, n, s, snt.text, n, s, snref.text);
+    }
+    fprintf(out->fp,
+        "    default: return %s_as_NONE();\n    }\n}\n",
+        snt.text);
     return 0;
 }
 
@@ -1581,6 +1863,8 @@ static int gen_builder_tables(output_t *out)
         case fb_is_table:
             gen_builder_table_fields(out, (fb_compound_type_t *)sym);
             gen_builder_create_table(out, (fb_compound_type_t *)sym);
+            gen_builder_clone_table(out, (fb_compound_type_t *)sym);
+            gen_builder_table_estimate(out, (fb_compound_type_t *)sym);
             gen_builder_table_prolog(out, (fb_compound_type_t *)sym);
             fprintf(out->fp, "\n");
             break;
@@ -1591,6 +1875,114 @@ static int gen_builder_tables(output_t *out)
     return 0;
 }
 
+/*
+ * Lists table fields in the order `_create` adds them, so the vtable
+ * of a table created with all fields present matches the dictionary
+ * entry.
+ */
+static int gen_vtable_dict_fields(output_t *out, fb_compound_type_t *ct)
+{
+    const char *nsc = out->nsc;
+    fb_member_t *member;
+    int patch_union = !(ct->metadata_flags & fb_f_original_order);
+    fb_scoped_name_t snref;
+
+    fb_clear(snref);
+    for (member = ct->ordered_members; member; member = member->order) {
+        if (member->metadata_flags & fb_f_deprecated) {
+            continue;
+        }
+        if (member->type.type == vt_scalar_type || (member->type.type == vt_compound_type_ref &&
+                (member->type.ct->symbol.kind == fb_is_struct || member->type.ct->symbol.kind == fb_is_enum))) {
+            fprintf(out->fp, "        { %llu, %llu, %u },\n",
+                    llu(member->id), llu(member->size), (unsigned)member->align);
+            continue;
+        }
+        if (!patch_union && member->type.type == vt_compound_type_ref && member->type.ct->symbol.kind == fb_is_union) {
+            fb_compound_name(member->type.ct, &snref);
+            fprintf(out->fp, "        { %llu, sizeof(%s_union_type_t), sizeof(%s_union_type_t) },\n",
+                    llu(member->id - 1), snref.text, snref.text);
+        }
+        /* Strings, vectors, tables and union values are offsets. */
+        fprintf(out->fp, "        { %llu, sizeof(%suoffset_t), sizeof(%suoffset_t) },\n",
+                llu(member->id), nsc, nsc);
+    }
+    if (!patch_union) {
+        return 0;
+    }
+    /* `_create` adds union types after all other fields. */
+    for (member = ct->ordered_members; member; member = member->order) {
+        if (member->metadata_flags & fb_f_deprecated) {
+            continue;
+        }
+        if (member->type.type == vt_compound_type_ref && member->type.ct->symbol.kind == fb_is_union) {
+            fb_compound_name(member->type.ct, &snref);
+            fprintf(out->fp, "        { %llu, sizeof(%s_union_type_t), sizeof(%s_union_type_t) },\n",
+                    llu(member->id - 1), snref.text, snref.text);
+        }
+    }
+    return 0;
+}
+
+/* Tables without fields only have the empty vtable. */
+static int has_live_fields(fb_compound_type_t *ct)
+{
+    fb_member_t *member;
+
+    for (member = ct->ordered_members; member; member = member->order) {
+        if (!(member->metadata_flags & fb_f_deprecated)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * The dictionary holds the vtable of empty tables, i.e. tables with all
+ * fields at their default, and the vtable of each table in this schema
+ * created with all fields present, see `flatcc_builder_set_vtable_dict`.
+ */
+static int gen_builder_vtable_dict(output_t *out)
+{
+    fb_symbol_t *sym;
+    fb_compound_type_t *ct;
+    fb_scoped_name_t snt;
+    int count = 1;
+
+    fb_clear(snt);
+    fprintf(out->fp,
+        "static inline const flatcc_builder_vtable_dict_t *%s_vtable_dict(void)\n{\n",
+        out->S->basename);
+    for (sym = out->S->symbols; sym; sym = sym->link) {
+        if (sym->kind != fb_is_table || !has_live_fields((fb_compound_type_t *)sym)) {
+            continue;
+        }
+        ct = (fb_compound_type_t *)sym;
+        fb_compound_name(ct, &snt);
+        fprintf(out->fp, "    static const flatcc_builder_vtable_field_t %s_vtable_fields[] = {\n", snt.text);
+        gen_vtable_dict_fields(out, ct);
+        fprintf(out->fp, "    };\n");
+    }
+    fprintf(out->fp,
+        "    static const flatcc_builder_vtable_shape_t shapes[] = {\n"
+        "        { 0, 0 },\n");
+    for (sym = out->S->symbols; sym; sym = sym->link) {
+        if (sym->kind != fb_is_table || !has_live_fields((fb_compound_type_t *)sym)) {
+            continue;
+        }
+        fb_compound_name((fb_compound_type_t *)sym, &snt);
+        fprintf(out->fp, "        { %s_vtable_fields, sizeof(%s_vtable_fields) / sizeof(%s_vtable_fields[0]) },\n",
+                snt.text, snt.text, snt.text);
+        ++count;
+    }
+    fprintf(out->fp,
+        "    };\n"
+        "    static const flatcc_builder_vtable_dict_t dict = { shapes, %d };\n"
+        "    return &dict;\n"
+        "}\n\n", count);
+    return 0;
+}
+
 static int gen_builder_footer(output_t *out)
 {
     gen_pragma_pop(out);
@@ -1606,6 +1998,9 @@ int fb_gen_c_builder(output_t *out)
     gen_builder_enums(out);
     gen_builder_structs(out);
     gen_builder_tables(out);
+    if (out->opts->cgen_vtable_dict) {
+        gen_builder_vtable_dict(out);
+    }
     gen_builder_footer(out);
     return 0;
 }
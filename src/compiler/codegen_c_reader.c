@@ -221,6 +221,18 @@ static void gen_helpers(output_t *out)
         "    return offset ? __%sread_scalar_at_byteoffset(N, t, offset) : V;\\\n"
         "}\n",
         nsc, nsc, nsc);
+    fprintf(out->fp,
+        "/* Mutators only overwrite fields stored in the buffer, absent or defaulted fields fail. */\n"
+        "#define __%sscalar_field_mutate(N, ID, t, v)\\\n"
+        "{\\\n"
+        "    __%sread_vt(ID, offset, t)\\\n"
+        "    if (offset) {\\\n"
+        "        N ## _write_to_pe((uint8_t *)(t) + offset, v);\\\n"
+        "        return 0;\\\n"
+        "    }\\\n"
+        "    return -1;\\\n"
+        "}\n",
+        nsc, nsc);
     fprintf(out->fp,
         "#define __%sstruct_field(T, ID, t, r)\\\n"
         "{\\\n"
@@ -232,6 +244,16 @@ static void gen_helpers(output_t *out)
         "    return 0;\\\n"
         "}\n",
         nsc, nsc);
+    fprintf(out->fp,
+        "#define __%sstruct_field_mutate(N, ID, t, v)\\\n"
+        "{\\\n"
+        "    __%sread_vt(ID, offset, t)\\\n"
+        "    if (offset) {\\\n"
+        "        return N ## _mutate((N ## _struct_t)((uint8_t *)(t) + offset), v);\\\n"
+        "    }\\\n"
+        "    return -1;\\\n"
+        "}\n",
+        nsc, nsc);
     fprintf(out->fp,
         "#define __%soffset_field(T, ID, t, r, adjust)\\\n"
         "{\\\n"
@@ -266,6 +288,11 @@ static void gen_helpers(output_t *out)
         "{ assert(%svec_len(vec) > (i) && \"index out of range\");\\\n"
         "  return __%sread_scalar(N, &(vec)[i]); }\n",
         nsc, nsc, nsc);
+    fprintf(out->fp,
+        "#define __%sscalar_vec_mutate_at(N, vec, i, v)\\\n"
+        "{ if (%svec_len(vec) <= (i)) return -1;\\\n"
+        "  N ## _write_to_pe((void *)((vec) + (i)), v); return 0; }\n",
+        nsc, nsc);
     fprintf(out->fp,
         "#define __%sstruct_vec_at(vec, i)\\\n"
         "{ assert(%svec_len(vec) > (i) && \"index out of range\"); return (vec) + (i); }\n",
@@ -287,6 +314,11 @@ static void gen_helpers(output_t *out)
             "static inline T N ## _vec_at(N ## _vec_t vec, size_t i)\\\n"
             "__%sscalar_vec_at(N, vec, i)\n",
             nsc, nsc);
+    fprintf(out->fp,
+            "#define __%sdefine_scalar_vec_mutate_at(N, T) \\\n"
+            "static inline int N ## _vec_mutate_at(N ## _vec_t vec, size_t i, T v)\\\n"
+            "__%sscalar_vec_mutate_at(N, vec, i, v)\n",
+            nsc, nsc);
     fprintf(out->fp,
             "typedef const char *%sstring_t;\n"
             "static inline size_t %sstring_len(%sstring_t s)\n"
@@ -315,8 +347,9 @@ static void gen_helpers(output_t *out)
             "typedef T *N ## _mutable_vec_t;\\\n"
             "__%sdefine_scalar_vec_len(N)\\\n"
             "__%sdefine_scalar_vec_at(N, T)\\\n"
+            "__%sdefine_scalar_vec_mutate_at(N, T)\\\n"
             "__%sdefine_scalar_find(N, T)\\\n",
-            nsc, nsc, nsc, nsc);
+            nsc, nsc, nsc, nsc, nsc);
     if (out->opts->cgen_sort) {
         fprintf(out->fp, "\\\n__%sdefine_scalar_sort(N, T)\n", nsc);
     }
@@ -353,8 +386,10 @@ static void gen_helpers(output_t *out)
     fprintf(out->fp,
             "#define __%sstruct_scalar_field(t, M, N)\\\n"
             "{ return t ? __%sread_scalar(N, &(t->M)) : 0; }\n"
-            "#define __%sstruct_struct_field(t, M) { return t ? &(t->M) : 0; }\n",
-            nsc, nsc, nsc);
+            "#define __%sstruct_struct_field(t, M) { return t ? &(t->M) : 0; }\n"
+            "#define __%sstruct_scalar_field_mutate(t, M, N, v)\\\n"
+            "{ if (!t) return -1; N ## _write_to_pe((void *)&(t->M), v); return 0; }\n",
+            nsc, nsc, nsc, nsc);
     fprintf(out->fp,
             "/* If fid is null, the function returns true without testing as buffer is not expected to have any id. */\n"
             "static inline int %shas_identifier(const void *buffer, const char *fid)\n"
@@ -579,7 +614,7 @@ static void gen_struct(output_t *out, fb_compound_type_t *ct)
     unsigned pad_index = 0, deprecated_index = 0, pad;
     const char *kind;
     int do_pad = out->opts->cgen_pad;
-    int current_key_processed, already_has_key;
+    int current_key_processed, already_has_key, has_members = 0;
     const char *nsc = out->nsc;
 
     fb_scoped_name_t snt;
@@ -737,6 +772,11 @@ static void gen_struct(output_t *out, fb_compound_type_t *ct)
                 "__%sstruct_scalar_field(t, %.*s, %s%s)\n",
                 tname_ns, tname, snt.text, n, s, snt.text,
                 nsc, n, s, nsc, tname_prefix);
+            fprintf(out->fp,
+                "static inline int %s_%.*s_mutate(%s_struct_t t, %s%s v)\n"
+                "__%sstruct_scalar_field_mutate(t, %.*s, %s%s, v)\n",
+                snt.text, n, s, snt.text, tname_ns, tname,
+                nsc, n, s, nsc, tname_prefix);
             if (member->metadata_flags & fb_f_key) {
                 if (already_has_key) {
                     fprintf(out->fp, "/* Note: this is not the first field with a key on this struct. */\n");
@@ -774,6 +814,11 @@ static void gen_struct(output_t *out, fb_compound_type_t *ct)
                     "__%sstruct_scalar_field(t, %.*s, %s%s)\n",
                     snref.text, snt.text, n, s, snt.text,
                     nsc, n, s, nsc, tname_prefix);
+                fprintf(out->fp,
+                    "static inline int %s_%.*s_mutate(%s_struct_t t, %s_enum_t v)\n"
+                    "__%sstruct_scalar_field_mutate(t, %.*s, %s, v)\n",
+                    snt.text, n, s, snt.text, snref.text,
+                    nsc, n, s, snref.text);
                 if (member->metadata_flags & fb_f_key) {
                     if (already_has_key) {
                         fprintf(out->fp, "/* Note: this is not the first field with a key on this table. */\n");
@@ -825,6 +870,40 @@ static void gen_struct(output_t *out, fb_compound_type_t *ct)
         }
         fprintf(out->fp, "\n");
     }
+    /*
+     * Overwrites all members from a native struct, which is how table
+     * fields and struct vector elements are mutated as a whole.
+     */
+    fprintf(out->fp,
+            "static inline int %s_mutate(%s_struct_t t, const %s_t *v)\n"
+            "{\n"
+            "    if (!t) {\n"
+            "        return -1;\n"
+            "    }\n",
+            snt.text, snt.text, snt.text);
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member->metadata_flags & fb_f_deprecated) {
+            continue;
+        }
+        symbol_name(&member->symbol, &n, &s);
+        if (member->type.type == vt_compound_type_ref &&
+                member->type.ct->symbol.kind == fb_is_struct) {
+            fb_compound_name(member->type.ct, &snref);
+            fprintf(out->fp, "    %s_mutate(&t->%.*s, &v->%.*s);\n",
+                    snref.text, n, s, n, s);
+        } else {
+            fprintf(out->fp, "    %s_%.*s_mutate(t, v->%.*s);\n",
+                    snt.text, n, s, n, s);
+        }
+        has_members = 1;
+    }
+    if (!has_members) {
+        fprintf(out->fp, "    (void)v;\n");
+    }
+    fprintf(out->fp,
+            "    return 0;\n"
+            "}\n\n");
 }
 
 /*
@@ -1065,6 +1144,11 @@ static void gen_table(output_t *out, fb_compound_type_t *ct)
                 gen_panic(out, "internal error: unexpected scalar table default value");
                 continue;
             }
+            fprintf(out->fp,
+                "static inline int %s_%.*s_mutate(%s_table_t t, %s%s v)\n"
+                "__%sscalar_field_mutate(%s%s, %llu, t, v)\n",
+                snt.text, n, s, snt.text, tname_ns, tname,
+                nsc, nsc, tname_prefix, llu(member->id));
             if (member->metadata_flags & fb_f_key) {
                 if (already_has_key) {
                     fprintf(out->fp, "/* Note: this is not the first field with a key on this table. */\n");
@@ -1161,6 +1245,11 @@ static void gen_table(output_t *out, fb_compound_type_t *ct)
                     "__%sstruct_field(%s_struct_t, %llu, t, %u)\n",
                     snref.text, snt.text, n, s, snt.text,
                     nsc, snref.text, llu(member->id), r);
+                fprintf(out->fp,
+                    "static inline int %s_%.*s_mutate(%s_table_t t, const %s_t *v)\n"
+                    "__%sstruct_field_mutate(%s, %llu, t, v)\n",
+                    snt.text, n, s, snt.text, snref.text,
+                    nsc, snref.text, llu(member->id));
                 break;
             case fb_is_table:
                 fprintf(out->fp,
@@ -1196,6 +1285,11 @@ static void gen_table(output_t *out, fb_compound_type_t *ct)
                     gen_panic(out, "internal error: unexpected enum type referenced by table");
                     continue;
                 }
+                fprintf(out->fp,
+                    "static inline int %s_%.*s_mutate(%s_table_t t, %s_enum_t v)\n"
+                    "__%sscalar_field_mutate(%s, %llu, t, v)\n",
+                    snt.text, n, s, snt.text, snref.text,
+                    nsc, snref.text, llu(member->id));
                 if (member->metadata_flags & fb_f_key) {
                     if (already_has_key) {
                         fprintf(out->fp, "/* Note: this is not the first field with a key on this table. */\n");
@@ -57,7 +57,7 @@ static int gen_union_verifier(output_t *out, fb_compound_type_t *ct)
         assert(member->type.type == vt_compound_type_ref);
         fb_compound_name(member->type.ct, &snref);
         fprintf(out->fp,
-                "    case %u: return flatcc_verify_table_field(td, id, 0, __%s_table_verifier);\n",
+                "    case %u: return flatcc_verify_union_table(td, id, __%s_table_verifier);\n",
                 (unsigned)member->value.u, snref.text);
     }
     fprintf(out->fp,
@@ -65,18 +65,225 @@ static int gen_union_verifier(output_t *out, fb_compound_type_t *ct)
     return 0;
 }
 
+static int gen_union_verifier_spec(output_t *out, fb_compound_type_t *ct)
+{
+    fb_symbol_t *sym;
+    fb_member_t *member;
+    fb_scoped_name_t snt, snref;
+    unsigned type, max_type = 0;
+
+    fb_clear(snt);
+    fb_clear(snref);
+    fb_compound_name(ct, &snt);
+
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member->type.type != vt_missing && (unsigned)member->value.u > max_type) {
+            max_type = (unsigned)member->value.u;
+        }
+    }
+    fprintf(out->fp,
+            "static const flatcc_verify_table_spec_t *const __%s_union_members[] = {\n",
+            snt.text);
+    for (type = 0; type <= max_type; ++type) {
+        for (sym = ct->members; sym; sym = sym->link) {
+            member = (fb_member_t *)sym;
+            /* NONE is of type vt_missing and has no table. */
+            if (member->type.type != vt_missing && (unsigned)member->value.u == type) {
+                break;
+            }
+        }
+        if (sym) {
+            assert(member->type.type == vt_compound_type_ref);
+            fb_compound_name(member->type.ct, &snref);
+            fprintf(out->fp, "    &__%s_table_spec,\n", snref.text);
+        } else {
+            fprintf(out->fp, "    0,\n");
+        }
+    }
+    fprintf(out->fp,
+            "};\n"
+            "static const flatcc_verify_union_spec_t __%s_union_spec = { __%s_union_members, %u };\n\n",
+            snt.text, snt.text, max_type + 1);
+    return 0;
+}
+
+static int gen_field_ids(output_t *out, fb_compound_type_t *ct, fb_scoped_name_t *snt)
+{
+    fb_symbol_t *sym;
+    fb_member_t *member;
+
+    /* Field ids for verification masks. */
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member->metadata_flags & fb_f_deprecated) {
+            continue;
+        }
+        if (member->type.type == vt_compound_type_ref && member->type.ct->symbol.kind == fb_is_union) {
+            fprintf(out->fp, "#define %s_%.*s_type_field_id %"PRIu64"\n",
+                    snt->text, (int)sym->ident->len, sym->ident->text, member->id - 1);
+        }
+        fprintf(out->fp, "#define %s_%.*s_field_id %"PRIu64"\n",
+                snt->text, (int)sym->ident->len, sym->ident->text, member->id);
+    }
+    if (ct->members) {
+        fprintf(out->fp, "\n");
+    }
+    return 0;
+}
+
+/* The `_verify_as_root` family, calling either the verifier function or the spec interpreter. */
+static int gen_table_verify_as_root(output_t *out, fb_scoped_name_t *snt)
+{
+    const char *nsc = out->nsc;
+    const char *fn = "flatcc_verify_table_as_root";
+    const char *arg = "table_verifier";
+
+    if (out->opts->cgen_verifier_specs) {
+        fn = "flatcc_verify_table_as_root_with_spec";
+        arg = "table_spec";
+    }
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root(const void *buf, size_t bufsiz)\n"
+            "{\n    return %s(buf, bufsiz, %s_identifier, &__%s_%s);\n}\n\n",
+            snt->text, fn, snt->text, snt->text, arg);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_typed_root(const void *buf, size_t bufsiz)\n"
+            "{\n    return %s(buf, bufsiz, %s_type_identifier, &__%s_%s);\n}\n\n",
+            snt->text, fn, snt->text, snt->text, arg);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_identifier(const void *buf, size_t bufsiz, const char *fid)\n"
+            "{\n    return %s(buf, bufsiz, fid, &__%s_%s);\n}\n\n",
+            snt->text, fn, snt->text, arg);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_type_hash(const void *buf, size_t bufsiz, %sthash_t thash)\n"
+            "{ __flatbuffers_thash_write_to_pe(&thash, thash);\n"
+            "  return %s(buf, bufsiz, thash ? (const char *)&thash : 0, &__%s_%s);\n}\n\n",
+            snt->text, nsc, fn, snt->text, arg);
+    if (out->opts->cgen_verifier_specs) {
+        return 0;
+    }
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_memoized(const void *buf, size_t bufsiz, void *scratch, size_t scratch_size)\n"
+            "{\n    return flatcc_verify_table_as_root_memoized(buf, bufsiz, %s_identifier, &__%s_table_verifier, scratch, scratch_size);\n}\n\n",
+            snt->text, snt->text, snt->text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_parallel(const void *buf, size_t bufsiz, flatcc_verify_runner_f *runner, void *runner_context)\n"
+            "{\n    return flatcc_verify_table_as_root_parallel(buf, bufsiz, %s_identifier, &__%s_table_verifier, runner, runner_context);\n}\n\n",
+            snt->text, snt->text, snt->text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_mask(const void *buf, size_t bufsiz, const flatcc_verify_mask_t *mask)\n"
+            "{\n    return flatcc_verify_table_as_root_with_mask(buf, bufsiz, %s_identifier, &__%s_table_verifier, mask);\n}\n\n",
+            snt->text, snt->text, snt->text);
+    fprintf(out->fp,
+            "static inline int %s_verify_as_root_with_flags(const void *buf, size_t bufsiz, int flags)\n"
+            "{\n    return flatcc_verify_table_as_root_with_flags(buf, bufsiz, %s_identifier, &__%s_table_verifier, flags);\n}\n\n",
+            snt->text, snt->text, snt->text);
+    return 0;
+}
+
+static int gen_table_verifier_spec(output_t *out, fb_compound_type_t *ct)
+{
+    fb_symbol_t *sym;
+    fb_member_t *member;
+    fb_scoped_name_t snt, snref;
+    const char *kind, *child;
+    int count = 0;
+
+    fb_clear(snt);
+    fb_clear(snref);
+    fb_compound_name(ct, &snt);
+
+    gen_field_ids(out, ct, &snt);
+    for (sym = ct->members; sym; sym = sym->link) {
+        member = (fb_member_t *)sym;
+        if (member->metadata_flags & fb_f_deprecated) {
+            continue;
+        }
+        if (count++ == 0) {
+            fprintf(out->fp, "static const flatcc_verify_field_spec_t __%s_table_fields[] = {\n", snt.text);
+        }
+        kind = "field";
+        child = 0;
+        switch (member->type.type) {
+        case vt_vector_type:
+            if (member->nest) {
+                fb_compound_name((fb_compound_type_t *)&member->nest->symbol, &snref);
+                if (member->nest->symbol.kind == fb_is_table) {
+                    kind = "nested_table";
+                    child = "table";
+                } else {
+                    kind = "nested_struct";
+                }
+            } else {
+                kind = "vector";
+            }
+            break;
+        case vt_string_type:
+            kind = "string";
+            break;
+        case vt_vector_string_type:
+            kind = "string_vector";
+            break;
+        case vt_compound_type_ref:
+            fb_compound_name(member->type.ct, &snref);
+            switch (member->type.ct->symbol.kind) {
+            case fb_is_table:
+                kind = "table";
+                child = "table";
+                break;
+            case fb_is_union:
+                kind = "union";
+                child = "union";
+                break;
+            default:
+                break;
+            }
+            break;
+        case vt_vector_compound_type_ref:
+            fb_compound_name(member->type.ct, &snref);
+            if (member->type.ct->symbol.kind == fb_is_table) {
+                kind = "table_vector";
+                child = "table";
+            } else {
+                kind = "vector";
+            }
+            break;
+        default:
+            break;
+        }
+        if (child) {
+            fprintf(out->fp, "    { &__%s_%s_spec, ", snref.text, child);
+        } else {
+            fprintf(out->fp, "    { 0, ");
+        }
+        fprintf(out->fp, "%"PRIu64", %"PRIu64", %"PRIu16", flatcc_verify_spec_%s, %d }, /* %.*s */\n",
+                member->size, member->id, member->align, kind,
+                (member->metadata_flags & fb_f_required) != 0,
+                (int)sym->ident->len, sym->ident->text);
+    }
+    if (count) {
+        fprintf(out->fp, "};\n");
+        fprintf(out->fp, "static const flatcc_verify_table_spec_t __%s_table_spec = { __%s_table_fields, %d };\n\n",
+                snt.text, snt.text, count);
+    } else {
+        fprintf(out->fp, "static const flatcc_verify_table_spec_t __%s_table_spec = { 0, 0 };\n\n", snt.text);
+    }
+    return gen_table_verify_as_root(out, &snt);
+}
+
 static int gen_table_verifier(output_t *out, fb_compound_type_t *ct)
 {
     fb_symbol_t *sym;
     fb_member_t *member;
     fb_scoped_name_t snt, snref;
     int required, first = 1;
-    const char *nsc = out->nsc;
 
     fb_clear(snt);
     fb_clear(snref);
     fb_compound_name(ct, &snt);
 
+    gen_field_ids(out, ct, &snt);
     fprintf(out->fp,
             "static int __%s_table_verifier(flatcc_table_verifier_descriptor_t *td)\n{\n",
             snt.text);
@@ -182,24 +389,7 @@ static int gen_table_verifier(output_t *out, fb_compound_type_t *ct)
     }
     fprintf(out->fp, "    return flatcc_verify_ok;\n");
     fprintf(out->fp, "}\n\n");
-    fprintf(out->fp,
-            "static inline int %s_verify_as_root(const void *buf, size_t bufsiz)\n"
-            "{\n    return flatcc_verify_table_as_root(buf, bufsiz, %s_identifier, &__%s_table_verifier);\n}\n\n",
-            snt.text, snt.text, snt.text);
-    fprintf(out->fp,
-            "static inline int %s_verify_as_typed_root(const void *buf, size_t bufsiz)\n"
-            "{\n    return flatcc_verify_table_as_root(buf, bufsiz, %s_type_identifier, &__%s_table_verifier);\n}\n\n",
-            snt.text, snt.text, snt.text);
-    fprintf(out->fp,
-            "static inline int %s_verify_as_root_with_identifier(const void *buf, size_t bufsiz, const char *fid)\n"
-            "{\n    return flatcc_verify_table_as_root(buf, bufsiz, fid, &__%s_table_verifier);\n}\n\n",
-            snt.text, snt.text);
-    fprintf(out->fp,
-            "static inline int %s_verify_as_root_with_type_hash(const void *buf, size_t bufsiz, %sthash_t thash)\n"
-            "{ __flatbuffers_thash_write_to_pe(&thash, thash);\n"
-            "  return flatcc_verify_table_as_root(buf, bufsiz, thash ? (const char *)&thash : 0, &__%s_table_verifier);\n}\n\n",
-            snt.text, nsc, snt.text);
-    return 0;
+    return gen_table_verify_as_root(out, &snt);
 }
 
 static int gen_struct_verifier(output_t *out, fb_compound_type_t *ct)
@@ -240,9 +430,15 @@ static int gen_verifier_prototypes(output_t *out)
         switch (sym->kind) {
         case fb_is_table:
             fb_compound_name((fb_compound_type_t *)sym, &snt);
-            fprintf(out->fp,
-                    "static int __%s_table_verifier(flatcc_table_verifier_descriptor_t *td);\n",
-                    snt.text);
+            if (out->opts->cgen_verifier_specs) {
+                fprintf(out->fp,
+                        "static const flatcc_verify_table_spec_t __%s_table_spec;\n",
+                        snt.text);
+            } else {
+                fprintf(out->fp,
+                        "static int __%s_table_verifier(flatcc_table_verifier_descriptor_t *td);\n",
+                        snt.text);
+            }
         }
     }
     fprintf(out->fp, "\n");
@@ -256,7 +452,11 @@ static int gen_union_verifiers(output_t *out)
     for (sym = out->S->symbols; sym; sym = sym->link) {
         switch (sym->kind) {
         case fb_is_union:
-            gen_union_verifier(out, (fb_compound_type_t *)sym);
+            if (out->opts->cgen_verifier_specs) {
+                gen_union_verifier_spec(out, (fb_compound_type_t *)sym);
+            } else {
+                gen_union_verifier(out, (fb_compound_type_t *)sym);
+            }
         }
     }
     return 0;
@@ -282,7 +482,11 @@ static int gen_table_verifiers(output_t *out)
     for (sym = out->S->symbols; sym; sym = sym->link) {
         switch (sym->kind) {
         case fb_is_table:
-            gen_table_verifier(out, (fb_compound_type_t *)sym);
+            if (out->opts->cgen_verifier_specs) {
+                gen_table_verifier_spec(out, (fb_compound_type_t *)sym);
+            } else {
+                gen_table_verifier(out, (fb_compound_type_t *)sym);
+            }
         }
     }
     return 0;
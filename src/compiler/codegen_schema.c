@@ -46,7 +46,7 @@ static reflection_Type_ref_t export_type(flatcc_builder_t *B, fb_value_t type)
             break;
         }
         break;
-    case vt_string:
+    case vt_string_type:
         base_type = BaseType(String);
         break;
     case vt_compound_type_ref:
@@ -97,7 +97,21 @@ static reflection_Type_ref_t export_type(flatcc_builder_t *B, fb_value_t type)
     return reflection_Type_create(B, base_type, element, index);
 }
 
-static void export_fields(flatcc_builder_t *B, fb_compound_type_t *ct)
+/* Like `flatc`, except the type is named as in the exported objects. */
+static void export_attributes(flatcc_builder_t *B, fb_member_t *member, object_entry_t *objects)
+{
+    if (!member->nest) {
+        return;
+    }
+    reflection_Field_attributes_start(B);
+    reflection_Field_attributes_push_start(B);
+    reflection_KeyValue_key_create_str(B, "nested_flatbuffer");
+    reflection_KeyValue_value_create_str(B, objects[member->nest->export_index].name);
+    reflection_Field_attributes_push_end(B);
+    reflection_Field_attributes_end(B);
+}
+
+static void export_fields(flatcc_builder_t *B, fb_compound_type_t *ct, object_entry_t *objects)
 {
     fb_symbol_t *sym;
     fb_member_t *member;
@@ -156,6 +170,7 @@ static void export_fields(flatcc_builder_t *B, fb_compound_type_t *ct)
             reflection_Field_offset_add(B, (uint16_t)(member->id + 2) * sizeof(flatbuffers_voffset_t));
             reflection_Field_key_add(B, has_key);
             reflection_Field_required_add(B, required);
+            export_attributes(B, member, objects);
             break;
         case fb_is_struct:
             reflection_Field_offset_add(B, (uint16_t)member->offset);
@@ -185,7 +200,7 @@ static void export_objects(flatcc_builder_t *B, object_entry_t *objects, int nob
          * objects and enums.
          */
         reflection_Object_fields_start(B);
-        export_fields(B, ct);
+        export_fields(B, ct, objects);
         reflection_Object_fields_end(B);
         is_struct = ct->symbol.kind == fb_is_struct;
         if (is_struct) {
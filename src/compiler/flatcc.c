@@ -53,6 +53,8 @@ void flatcc_init_options(flatcc_options_t *opts)
     opts->cgen_builder = 0;
     opts->cgen_json_parser = 0;
     opts->cgen_spacing = FLATCC_CGEN_SPACING;
+    opts->cgen_vtable_dict = 0;
+    opts->cgen_verifier_specs = 0;
 
     opts->bgen_bfbs = FLATCC_BGEN_BFBS;
     opts->bgen_qualify_names = FLATCC_BGEN_QUALIFY_NAMES;
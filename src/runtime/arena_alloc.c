@@ -0,0 +1,175 @@
+/*
+ * Single slab builder allocator, see `flatcc_arena_alloc.h`.
+ *
+ * Uses anonymous `mmap` when requested and available, otherwise
+ * `malloc`.
+ */
+
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+/* Needed for `MAP_ANONYMOUS` and `madvise` with strict C modes. */
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_arena_alloc.h"
+
+#if defined(MAP_ANONYMOUS) || defined(MAP_ANON)
+#define HAVE_MMAP 1
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#else
+#define HAVE_MMAP 0
+#endif
+
+/* Regions start on cache line boundaries. */
+#define REGION_ALIGN 64
+
+#define HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+
+static size_t roundup(size_t n, size_t align)
+{
+    return (n + align - 1) / align * align;
+}
+
+#if HAVE_MMAP
+static void *map_slab(size_t *size, int flags)
+{
+    void *p = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (flags & flatcc_arena_alloc_hugepages) {
+        p = mmap(0, roundup(*size, HUGE_PAGE_SIZE), PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            *size = roundup(*size, HUGE_PAGE_SIZE);
+            return p;
+        }
+    }
+#endif
+    p = mmap(0, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        return 0;
+    }
+#ifdef MADV_HUGEPAGE
+    if (flags & flatcc_arena_alloc_hugepages) {
+        /* Transparent huge pages, if enabled. Failure is harmless. */
+        madvise(p, *size, MADV_HUGEPAGE);
+    }
+#endif
+    return p;
+}
+#endif
+
+int flatcc_arena_alloc_init(flatcc_arena_alloc_t *A,
+        const flatcc_arena_alloc_profile_t *profile, int flags)
+{
+    size_t size = 0;
+    int i;
+
+    memset(A, 0, sizeof(*A));
+    for (i = 0; i < FLATCC_BUILDER_ALLOC_BUFFER_COUNT; ++i) {
+        A->offset[i] = size;
+        A->size[i] = roundup(profile ? profile->size[i] : FLATCC_ARENA_ALLOC_REGION_SIZE, REGION_ALIGN);
+        size += A->size[i];
+    }
+    if (size == 0) {
+        return 0;
+    }
+#if HAVE_MMAP
+    if (flags & (flatcc_arena_alloc_mmap | flatcc_arena_alloc_hugepages)) {
+        if (!(A->slab = map_slab(&size, flags))) {
+            return -1;
+        }
+        A->is_mapped = 1;
+        A->slab_size = size;
+        return 0;
+    }
+#else
+    (void)flags;
+#endif
+    if (!(A->slab = malloc(size))) {
+        return -1;
+    }
+    A->slab_size = size;
+    return 0;
+}
+
+void flatcc_arena_alloc_clear(flatcc_arena_alloc_t *A)
+{
+    if (A->slab) {
+#if HAVE_MMAP
+        if (A->is_mapped) {
+            munmap(A->slab, A->slab_size);
+        } else {
+            free(A->slab);
+        }
+#else
+        free(A->slab);
+#endif
+    }
+    memset(A, 0, sizeof(*A));
+}
+
+void flatcc_arena_alloc_get_profile(flatcc_arena_alloc_t *A,
+        flatcc_arena_alloc_profile_t *profile)
+{
+    *profile = A->profile;
+}
+
+int flatcc_arena_alloc(void *alloc_context,
+        flatcc_iovec_t *b, size_t request, int zero_fill, int alloc_type)
+{
+    flatcc_arena_alloc_t *A = alloc_context;
+    flatcc_iovec_t heap = { 0, 0 };
+    uint8_t *region;
+
+    if (alloc_type < 0 || alloc_type >= FLATCC_BUILDER_ALLOC_BUFFER_COUNT) {
+        return flatcc_builder_default_alloc(0, b, request, zero_fill, alloc_type);
+    }
+    region = A->slab ? A->slab + A->offset[alloc_type] : 0;
+    if (request == 0) {
+        if (b->iov_base != region) {
+            return flatcc_builder_default_alloc(0, b, 0, 0, alloc_type);
+        }
+        b->iov_base = 0;
+        b->iov_len = 0;
+        return 0;
+    }
+    if (b->iov_base == 0 && request <= A->size[alloc_type]) {
+        /* The region may have been used by an earlier builder. */
+        if (zero_fill) {
+            memset(region, 0, A->size[alloc_type]);
+        }
+        b->iov_base = region;
+        b->iov_len = A->size[alloc_type];
+    } else if (b->iov_base != region || b->iov_base == 0) {
+        if (flatcc_builder_default_alloc(0, b, request, zero_fill, alloc_type)) {
+            return -1;
+        }
+    } else if (request > b->iov_len) {
+        /* The buffer outgrew its region and moves to the heap. */
+        if (flatcc_builder_default_alloc(0, &heap, request, zero_fill, alloc_type)) {
+            return -1;
+        }
+        memcpy(heap.iov_base, region, b->iov_len);
+        *b = heap;
+        ++A->overflow_count;
+    }
+    /*
+     * The builder may use all space it is given without further
+     * requests, so the profile records the space rather than the
+     * request. Regions are never shrunk, notably not on reset.
+     */
+    if (A->profile.size[alloc_type] < b->iov_len) {
+        A->profile.size[alloc_type] = b->iov_len;
+    }
+    return 0;
+}
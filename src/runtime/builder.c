@@ -18,8 +18,11 @@
 #include <string.h>
 #include <assert.h>
 
+#include "flatcc/flatcc_rtconfig.h"
 #include "flatcc/flatcc_builder.h"
 #include "flatcc/flatcc_emitter.h"
+#include "flatcc/flatcc_byteswap.h"
+#include "flatcc/flatcc_refmap.h"
 
 /*
  * `check` is designed to handle incorrect use errors that can be
@@ -65,6 +68,7 @@ const uint8_t flatcc_builder_padding_base[512] = { 0 };
 
 #define store_uoffset __flatbuffers_uoffset_cast_to_pe
 #define store_voffset  __flatbuffers_voffset_cast_to_pe
+#define load_voffset __flatbuffers_voffset_cast_from_pe
 
 #define field_size sizeof(uoffset_t)
 #define max_offset_count FLATBUFFERS_COUNT_MAX(field_size)
@@ -75,6 +79,15 @@ const uint8_t flatcc_builder_padding_base[512] = { 0 };
 #define frame_size sizeof(__flatcc_builder_frame_t)
 #define frame(x) (B->frame[0].x)
 
+/* Table log entry in fragment mode. */
+typedef struct fragment_table fragment_table_t;
+struct fragment_table {
+    flatcc_builder_ref_t table;
+    flatcc_builder_vt_ref_t vt_ref;
+    /* The vtable cache hash, so a splice finds vtables built natively. */
+    uint32_t vt_hash;
+};
+
 typedef struct vtable_descriptor vtable_descriptor_t;
 struct vtable_descriptor {
     /* Where the vtable is emitted. */
@@ -85,6 +98,31 @@ struct vtable_descriptor {
     uoffset_t vb_start;
     /* Hash table collision chain. */
     uoffset_t next;
+    /* Hash table slot, so rollback can unlink the descriptor. */
+    uoffset_t slot;
+    /* Descriptor reused from the stale state before this one, if any. */
+    uoffset_t revived_next;
+};
+
+typedef struct shared_descriptor shared_descriptor_t;
+struct shared_descriptor {
+    /* Where the object is emitted. */
+    flatcc_builder_ref_t ref;
+    /* Which buffer it was emitted to. */
+    flatcc_builder_ref_t buffer_mark;
+    /* Where the content is cached. */
+    uoffset_t sb_start;
+    /* Content length excluding headers and zero termination. */
+    uoffset_t len;
+    /* Hash table collision chain. */
+    uoffset_t next;
+    /* Hash table slot, so rollback can unlink the descriptor. */
+    uoffset_t slot;
+    /* The vtable of tables, the element size of vectors, otherwise 0. */
+    flatcc_builder_ref_t tag;
+    /* A `flatcc_builder_type` value. */
+    uint16_t type;
+    uint16_t align;
 };
 
 typedef struct flatcc_iov_state flatcc_iov_state_t;
@@ -123,6 +161,7 @@ int flatcc_builder_default_alloc(void *alloc_context, iovec_t *b, size_t request
         n = 256;
         break;
     case flatcc_builder_alloc_ht:
+    case flatcc_builder_alloc_sh:
         /* Should be exact size, or space size is just wasted. */
         n = request;
         break;
@@ -167,6 +206,8 @@ int flatcc_builder_default_alloc(void *alloc_context, iovec_t *b, size_t request
 #define us_ptr(pos) (T_ptr(B->buffers[flatcc_builder_alloc_us].iov_base, (pos)))
 #define vd_ptr(pos) (T_ptr(B->buffers[flatcc_builder_alloc_vd].iov_base, (pos)))
 #define vb_ptr(pos) (T_ptr(B->buffers[flatcc_builder_alloc_vb].iov_base, (pos)))
+#define sd_ptr(pos) (T_ptr(B->buffers[flatcc_builder_alloc_sd].iov_base, (pos)))
+#define sb_ptr(pos) (T_ptr(B->buffers[flatcc_builder_alloc_sb].iov_base, (pos)))
 #define vs_offset(ptr) ((uoffset_t)((size_t)(ptr) - (size_t)B->buffers[flatcc_builder_alloc_vs].iov_base))
 #define pl_offset(ptr) ((uoffset_t)((size_t)(ptr) - (size_t)B->buffers[flatcc_builder_alloc_pl].iov_base))
 #define us_offset(ptr) ((uoffset_t)((size_t)(ptr) - (size_t)B->buffers[flatcc_builder_alloc_us].iov_base))
@@ -179,6 +220,25 @@ int flatcc_builder_default_alloc(void *alloc_context, iovec_t *b, size_t request
 /* This also returns true if no buffer has been started. */
 #define is_top_buffer(B) (B->buffer_mark == 0)
 
+/*
+ * Buffer mark given to vtable descriptors kept from an earlier buffer in
+ * stream mode. Valid buffer marks are never positive.
+ */
+#define stale_buffer_mark 1
+
+/* Updates performance counters when enabled, compiles to nothing otherwise. */
+#if FLATCC_BUILDER_STATS
+#define stats_update(B, stmt) do { if (B->enable_stats) { stmt; } } while (0)
+#else
+#define stats_update(B, stmt) ((void)0)
+#endif
+
+static inline int call_alloc(flatcc_builder_t *B, iovec_t *buf, size_t request, int zero_fill, int alloc_type)
+{
+    stats_update(B, ++B->stats.alloc_calls[alloc_type]; B->stats.alloc_bytes[alloc_type] += request);
+    return B->alloc(B->alloc_context, buf, request, zero_fill, alloc_type);
+}
+
 /*
  * Tables use a stack represention better suited for quickly adding
  * fields to tables, but it must occasionally be refreshed following
@@ -188,6 +248,7 @@ static inline void refresh_ds(flatcc_builder_t *B, uoffset_t type_limit)
 {
     iovec_t *buf = B->buffers + flatcc_builder_alloc_ds;
 
+    stats_update(B, ++B->stats.refresh_ds_count);
     B->ds = ds_ptr(B->ds_first);
     B->ds_limit = (uoffset_t)buf->iov_len - B->ds_first;
     /*
@@ -205,7 +266,7 @@ static int reserve_ds(flatcc_builder_t *B, size_t need, uoffset_t limit)
 {
     iovec_t *buf = B->buffers + flatcc_builder_alloc_ds;
 
-    if (B->alloc(B->alloc_context, buf, B->ds_first + need, 1, flatcc_builder_alloc_ds)) {
+    if (call_alloc(B, buf, B->ds_first + need, 1, flatcc_builder_alloc_ds)) {
         return -1;
     }
     refresh_ds(B, limit);
@@ -295,7 +356,7 @@ static inline void *reserve_buffer(flatcc_builder_t *B, int alloc_type, size_t u
     iovec_t *buf = B->buffers + alloc_type;
 
     if (used + need > buf->iov_len) {
-        if (B->alloc(B->alloc_context, buf, used + need, zero_init, alloc_type)) {
+        if (call_alloc(B, buf, used + need, zero_init, alloc_type)) {
             check(0, "memory allocation failed");
             return 0;
         }
@@ -336,7 +397,7 @@ static int alloc_ht(flatcc_builder_t *B)
     }
     B->vd_end = sizeof(vtable_descriptor_t);
     size = field_size * FLATCC_BUILDER_MIN_HASH_COUNT;
-    if (B->alloc(B->alloc_context, buf, size, 1, flatcc_builder_alloc_ht)) {
+    if (call_alloc(B, buf, size, 1, flatcc_builder_alloc_ht)) {
         return -1;
     }
     while (size * 2 <= buf->iov_len) {
@@ -359,6 +420,91 @@ static inline uoffset_t *lookup_ht(flatcc_builder_t *B, uint32_t hash)
     return &T[hash & B->ht_mask];
 }
 
+/*
+ * Adds one dictionary vtable to the cache as a stale descriptor so it
+ * is emitted on first use. The vtable is laid out and hashed as
+ * `table_add`, `table_add_offset` and `end_table` would for the same
+ * fields, and it is built in place at the end of the vtable cache where
+ * it is only kept if not already cached. Invalid shapes are ignored.
+ */
+static int seed_vtable_shape(flatcc_builder_t *B, const flatcc_builder_vtable_shape_t *shape)
+{
+    const flatcc_builder_vtable_field_t *f;
+    vtable_descriptor_t *vd;
+    voffset_t *vt, *vt_;
+    uoffset_t *pvd_head, next, offset = 0, id_end = 0;
+    size_t i, vt_size;
+    uint32_t hash;
+
+    for (i = 0; i < shape->count; ++i) {
+        f = shape->fields + i;
+        if (f->id > FLATBUFFERS_ID_MAX || f->align == 0 || (f->align & (f->align - 1))) {
+            return 0;
+        }
+        if (f->id >= id_end) {
+            id_end = f->id + 1u;
+        }
+    }
+    vt_size = sizeof(voffset_t) * (id_end + 2);
+    if (!(vt = reserve_buffer(B, flatcc_builder_alloc_vb, B->vb_end, vt_size, 0))) {
+        return -1;
+    }
+    memset(vt, 0, vt_size);
+    FLATCC_BUILDER_INIT_VT_HASH(hash);
+    for (i = 0; i < shape->count; ++i) {
+        f = shape->fields + i;
+        /* Repeated adds return the existing field. */
+        if (vt[f->id + 2]) {
+            continue;
+        }
+        offset = alignup(offset, f->align);
+        if (offset >= table_limit || f->size >= table_limit - offset) {
+            return 0;
+        }
+        vt[f->id + 2] = store_voffset((voffset_t)(offset + field_size));
+        offset += f->size;
+        FLATCC_BUILDER_UPDATE_VT_HASH(hash, (uint32_t)f->id, (uint32_t)f->size);
+    }
+    vt[0] = store_voffset((voffset_t)vt_size);
+    vt[1] = store_voffset((voffset_t)(offset + field_size));
+    FLATCC_BUILDER_UPDATE_VT_HASH(hash, (uint32_t)vt[0], (uint32_t)vt[1]);
+    if (!(pvd_head = lookup_ht(B, hash))) {
+        return -1;
+    }
+    for (next = *pvd_head; next; next = vd->next) {
+        vd = vd_ptr(next);
+        vt_ = vb_ptr(vd->vb_start);
+        if (vt_[0] == vt[0] && 0 == memcmp(vt, vt_, vt_size)) {
+            return 0;
+        }
+    }
+    if (!(vd = reserve_buffer(B, flatcc_builder_alloc_vd, B->vd_end, sizeof(vtable_descriptor_t), 0))) {
+        return -1;
+    }
+    next = B->vd_end;
+    B->vd_end += sizeof(vtable_descriptor_t);
+    vd->buffer_mark = stale_buffer_mark;
+    vd->vt_ref = 0;
+    vd->vb_start = B->vb_end;
+    vd->slot = (uoffset_t)(pvd_head - (uoffset_t *)B->buffers[flatcc_builder_alloc_ht].iov_base);
+    vd->next = *pvd_head;
+    *pvd_head = next;
+    B->vb_end += (uoffset_t)vt_size;
+    return 0;
+}
+
+static int seed_vtable_dict(flatcc_builder_t *B)
+{
+    size_t i;
+
+    for (i = 0; i < B->vtable_dict->count; ++i) {
+        if (seed_vtable_shape(B, B->vtable_dict->shapes + i)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
 void flatcc_builder_flush_vtable_cache(flatcc_builder_t *B)
 {
     iovec_t *buf = B->buffers + flatcc_builder_alloc_ht;
@@ -370,6 +516,164 @@ void flatcc_builder_flush_vtable_cache(flatcc_builder_t *B)
     /* Reserve the null entry. */
     B->vd_end = sizeof(vtable_descriptor_t);
     B->vb_end = 0;
+    B->vd_revived = 0;
+    ++B->vb_flush_count;
+    /* The cache remains valid if seeding runs out of memory part way. */
+    if (B->vtable_dict) {
+        seed_vtable_dict(B);
+    }
+}
+
+int flatcc_builder_set_vtable_dict(flatcc_builder_t *B, const flatcc_builder_vtable_dict_t *dict)
+{
+    B->vtable_dict = dict;
+    return dict ? seed_vtable_dict(B) : 0;
+}
+
+static int alloc_sh(flatcc_builder_t *B)
+{
+    iovec_t *buf = B->buffers + flatcc_builder_alloc_sh;
+
+    size_t size;
+    /* Allocate null entry so we can check for return errors. */
+    assert(B->sd_end == 0);
+    if (!reserve_buffer(B, flatcc_builder_alloc_sd, B->sd_end, sizeof(shared_descriptor_t), 0)) {
+        return -1;
+    }
+    B->sd_end = sizeof(shared_descriptor_t);
+    size = field_size * FLATCC_BUILDER_MIN_HASH_COUNT;
+    if (call_alloc(B, buf, size, 1, flatcc_builder_alloc_sh)) {
+        return -1;
+    }
+    while (size * 2 <= buf->iov_len) {
+        size *= 2;
+    }
+    B->sh_mask = size / field_size - 1;
+    return 0;
+}
+
+static inline uoffset_t *lookup_sh(flatcc_builder_t *B, uint32_t hash)
+{
+    uoffset_t *T;
+
+    if (B->sh_mask == 0) {
+        if (alloc_sh(B)) {
+            return 0;
+        }
+    }
+    T = B->buffers[flatcc_builder_alloc_sh].iov_base;
+    return &T[hash & B->sh_mask];
+}
+
+void flatcc_builder_flush_string_cache(flatcc_builder_t *B)
+{
+    iovec_t *buf = B->buffers + flatcc_builder_alloc_sh;
+
+    if (B->sh_mask == 0) {
+        return;
+    }
+    memset(buf->iov_base, 0, buf->iov_len);
+    /* Reserve the null entry. */
+    B->sd_end = sizeof(shared_descriptor_t);
+    B->sb_end = 0;
+    ++B->sb_flush_count;
+}
+
+/* FNV-1a. */
+static inline uint32_t shared_hash(const void *data, size_t len, flatcc_builder_ref_t tag)
+{
+    const uint8_t *p = data;
+    uint32_t hash = (uint32_t)2166136261UL ^ (uint32_t)tag;
+
+    while (len--) {
+        hash = (hash ^ *p++) * (uint32_t)16777619UL;
+    }
+    return hash;
+}
+
+/*
+ * Returns the reference to an object with the same type, tag,
+ * alignment and content emitted earlier in the current buffer, or 0 if
+ * there is none. In that case `*pslot` is set to the hash slot to be
+ * given to `add_shared` once the object is emitted, or to null if the
+ * object should not be cached.
+ */
+static flatcc_builder_ref_t find_shared(flatcc_builder_t *B, uoffset_t **pslot,
+        int type, flatcc_builder_ref_t tag, uint16_t align, const void *data, size_t len)
+{
+    shared_descriptor_t *sd;
+    uoffset_t *psd, *psd_head;
+    uoffset_t next;
+
+    *pslot = 0;
+    if (B->sb_flush_limit && B->sb_flush_limit < len) {
+        return 0;
+    }
+    /* This just gets the hash table slot, we still have to inspect it. */
+    if (!(psd_head = lookup_sh(B, shared_hash(data, len, tag)))) {
+        return 0;
+    }
+    psd = psd_head;
+    next = *psd;
+    while (next) {
+        sd = sd_ptr(next);
+        /* Can't share emitted objects between buffers. */
+        if (sd->len != len || sd->tag != tag || sd->type != type || sd->align != align ||
+                sd->buffer_mark != B->buffer_mark || 0 != memcmp(data, sb_ptr(sd->sb_start), len)) {
+            psd = &sd->next;
+            next = sd->next;
+            continue;
+        }
+        /* Move to front hash strategy. */
+        if (psd != psd_head) {
+            *psd = sd->next;
+            sd->next = *psd_head;
+            *psd_head = next;
+        }
+        /* Content, length prefix or table header, and string zero termination. */
+        B->shared_bytes_saved += len + (type == flatcc_builder_struct ? 0 : field_size)
+                + (type == flatcc_builder_string);
+        return sd->ref;
+    }
+    *pslot = psd_head;
+    return 0;
+}
+
+/* Adds an emitted object to the cache after `find_shared` found none. */
+static int add_shared(flatcc_builder_t *B, uoffset_t *slot, flatcc_builder_ref_t ref,
+        int type, flatcc_builder_ref_t tag, uint16_t align, const void *data, size_t len)
+{
+    shared_descriptor_t *sd;
+    uoffset_t next;
+    void *p;
+
+    if (B->sb_flush_limit && B->sb_flush_limit < B->sb_end + len) {
+        /* Also empties `slot`. */
+        flatcc_builder_flush_string_cache(B);
+    }
+    if (!(sd = reserve_buffer(B, flatcc_builder_alloc_sd, B->sd_end, sizeof(shared_descriptor_t), 0))) {
+        return -1;
+    }
+    next = B->sd_end;
+    B->sd_end += sizeof(shared_descriptor_t);
+    sd->ref = ref;
+    sd->buffer_mark = B->buffer_mark;
+    sd->sb_start = B->sb_end;
+    sd->len = (uoffset_t)len;
+    sd->tag = tag;
+    sd->type = (uint16_t)type;
+    sd->align = align;
+    if (len > 0) {
+        if (!(p = reserve_buffer(B, flatcc_builder_alloc_sb, B->sb_end, len, 0))) {
+            return -1;
+        }
+        memcpy(p, data, len);
+        B->sb_end += (uoffset_t)len;
+    }
+    sd->slot = (uoffset_t)(slot - (uoffset_t *)B->buffers[flatcc_builder_alloc_sh].iov_base);
+    sd->next = *slot;
+    *slot = next;
+    return 0;
 }
 
 int flatcc_builder_custom_init(flatcc_builder_t *B,
@@ -403,17 +707,40 @@ int flatcc_builder_init(flatcc_builder_t *B)
     return flatcc_builder_custom_init(B, 0, 0, 0, 0);
 }
 
+static inline int is_vtable_cache_buffer(int alloc_type)
+{
+    return alloc_type == flatcc_builder_alloc_ht ||
+        alloc_type == flatcc_builder_alloc_vd || alloc_type == flatcc_builder_alloc_vb;
+}
+
+/* Keeps cached vtables but invalidates where they were emitted. */
+static void mark_vtable_cache_stale(flatcc_builder_t *B)
+{
+    vtable_descriptor_t *vd;
+    uoffset_t next;
+
+    for (next = sizeof(vtable_descriptor_t); next < B->vd_end; next += sizeof(vtable_descriptor_t)) {
+        vd = vd_ptr(next);
+        vd->buffer_mark = stale_buffer_mark;
+        vd->vt_ref = 0;
+    }
+    B->vd_revived = 0;
+}
+
 int flatcc_builder_custom_reset(flatcc_builder_t *B, int set_defaults, int reduce_buffers)
 {
     iovec_t *buf;
-    int i;
+    int i, keep_vtables = (B->stream_mode || B->vtable_dict) && !set_defaults;
 
     for (i = 0; i < FLATCC_BUILDER_ALLOC_BUFFER_COUNT; ++i) {
         buf = B->buffers + i;
+        if (keep_vtables && is_vtable_cache_buffer(i)) {
+            continue;
+        }
         if (buf->iov_base) {
-            /* Don't try to reduce the hash table. */
-            if (i != flatcc_builder_alloc_ht &&
-                reduce_buffers && B->alloc(B->alloc_context, buf, 1, 1, i)) {
+            /* Don't try to reduce the hash tables. */
+            if (i != flatcc_builder_alloc_ht && i != flatcc_builder_alloc_sh &&
+                reduce_buffers && call_alloc(B, buf, 1, 1, i)) {
                 return -1;
             }
             memset(buf->iov_base, 0, buf->iov_len);
@@ -421,11 +748,22 @@ int flatcc_builder_custom_reset(flatcc_builder_t *B, int set_defaults, int reduc
             assert(buf->iov_len == 0);
         }
     }
-    B->vb_end = 0;
-    if (B->vd_end > 0) {
-        /* Reset past null entry. */
-        B->vd_end = sizeof(vtable_descriptor_t);
+    if (keep_vtables) {
+        mark_vtable_cache_stale(B);
+    } else {
+        B->vb_end = 0;
+        B->vd_revived = 0;
+        if (B->vd_end > 0) {
+            /* Reset past null entry. */
+            B->vd_end = sizeof(vtable_descriptor_t);
+        }
     }
+    B->fr_end = 0;
+    B->sb_end = 0;
+    if (B->sd_end > 0) {
+        B->sd_end = sizeof(shared_descriptor_t);
+    }
+    B->shared_bytes_saved = 0;
     B->min_align = 0;
     B->emit_start = 0;
     B->emit_end = 0;
@@ -440,8 +778,15 @@ int flatcc_builder_custom_reset(flatcc_builder_t *B, int set_defaults, int reduc
     B->frame = 0;
     if (set_defaults) {
         B->vb_flush_limit = 0;
+        B->sb_flush_limit = 0;
         B->max_level = 0;
         B->disable_vt_clustering = 0;
+        B->fragment_mode = 0;
+        B->stream_mode = 0;
+        B->intern_strings = 0;
+        B->dedup_objects = 0;
+        B->enable_stats = 0;
+        B->vtable_dict = 0;
     }
     if (B->is_default_emitter) {
         flatcc_emitter_reset(&B->default_emit_context);
@@ -531,13 +876,15 @@ static int enter_frame(flatcc_builder_t *B, uint16_t align)
         if (!(B->frame = reserve_buffer(B, flatcc_builder_alloc_fs, B->level * frame_size, frame_size, 0))) {
             return -1;
         }
-        B->limit_level = (int)(B->buffers[flatcc_builder_alloc_fs].iov_len / frame_size);
+        /* Level `n` is stored at `n * frame_size`. */
+        B->limit_level = (int)(B->buffers[flatcc_builder_alloc_fs].iov_len / frame_size - 1);
         if (B->max_level > 0 && B->max_level < B->limit_level) {
             B->limit_level = B->max_level;
         }
     } else {
         ++B->frame;
     }
+    stats_update(B, if (B->stats.peak_level < B->level) B->stats.peak_level = B->level);
     frame(ds_offset) = B->ds_offset;
     frame(align) = B->align;
     B->align = align;
@@ -570,6 +917,187 @@ static inline void exit_frame(flatcc_builder_t *B)
     --B->level;
 }
 
+void flatcc_builder_checkpoint(flatcc_builder_t *B, flatcc_builder_checkpoint_t *cp)
+{
+    memset(cp, 0, sizeof(*cp));
+    if (B->frame) {
+        cp->frame = *B->frame;
+    }
+    cp->level = B->level;
+    cp->vs_offset = vs_offset(B->vs);
+    cp->pl_offset = pl_offset(B->pl);
+    cp->id_end = B->id_end;
+    cp->vt_hash = B->vt_hash;
+    cp->ds_offset = B->ds_offset;
+    cp->ds_first = B->ds_first;
+    cp->vb_end = B->vb_end;
+    cp->vd_end = B->vd_end;
+    cp->vd_revived = B->vd_revived;
+    cp->vb_flush_count = B->vb_flush_count;
+    cp->fr_end = B->fr_end;
+    cp->sb_end = B->sb_end;
+    cp->sd_end = B->sd_end;
+    cp->sb_flush_count = B->sb_flush_count;
+    cp->shared_bytes_saved = B->shared_bytes_saved;
+    cp->min_align = B->min_align;
+    cp->align = B->align;
+    cp->block_align = B->block_align;
+    cp->emit_start = B->emit_start;
+    cp->emit_end = B->emit_end;
+    cp->buffer_mark = B->buffer_mark;
+    memcpy(cp->identifier, B->identifier, identifier_size);
+    cp->user_frame_offset = B->user_frame_offset;
+    cp->user_frame_end = B->user_frame_end;
+}
+
+/*
+ * Removes vtable descriptors allocated at or after `vd_end` from the
+ * cache. Each is unlinked from its own hash chain, newest first since
+ * new descriptors are inserted at the front of the chain. Descriptors
+ * reused from the stale state after `vd_revived` was the most recent
+ * one become stale again since their vtables are discarded.
+ */
+static void rollback_vtable_cache(flatcc_builder_t *B, uoffset_t vd_end, uoffset_t vd_revived)
+{
+    uoffset_t *T = B->buffers[flatcc_builder_alloc_ht].iov_base;
+    uoffset_t *pvd, pos;
+    vtable_descriptor_t *vd, *vd2;
+
+    for (pos = B->vd_revived; pos != vd_revived; pos = vd->revived_next) {
+        vd = vd_ptr(pos);
+        vd->buffer_mark = stale_buffer_mark;
+        vd->vt_ref = 0;
+    }
+    B->vd_revived = vd_revived;
+    pos = B->vd_end;
+    while (pos > vd_end) {
+        pos -= (uoffset_t)sizeof(vtable_descriptor_t);
+        vd = vd_ptr(pos);
+        pvd = &T[vd->slot];
+        while (*pvd && *pvd != pos) {
+            vd2 = vd_ptr(*pvd);
+            pvd = &vd2->next;
+        }
+        if (*pvd) {
+            *pvd = vd->next;
+        }
+    }
+}
+
+/* Removes string descriptors allocated at or after `sd_end` from the cache. */
+static void rollback_string_cache(flatcc_builder_t *B, uoffset_t sd_end)
+{
+    uoffset_t *T = B->buffers[flatcc_builder_alloc_sh].iov_base;
+    uoffset_t *psd, pos = B->sd_end;
+    shared_descriptor_t *sd, *sd2;
+
+    while (pos > sd_end) {
+        pos -= (uoffset_t)sizeof(shared_descriptor_t);
+        sd = sd_ptr(pos);
+        psd = &T[sd->slot];
+        while (*psd && *psd != pos) {
+            sd2 = sd_ptr(*psd);
+            psd = &sd2->next;
+        }
+        if (*psd) {
+            *psd = sd->next;
+        }
+    }
+}
+
+int flatcc_builder_rollback(flatcc_builder_t *B, const flatcc_builder_checkpoint_t *cp)
+{
+    __flatcc_builder_frame_t *fs = B->buffers[flatcc_builder_alloc_fs].iov_base;
+    uoffset_t top, cp_top, vs_top;
+    voffset_t *vs;
+    int id;
+
+    check_error(B->level >= cp->level, -1, "checkpoint frame is no longer open");
+    check_error(cp->level == 0 || (fs[cp->level].type == cp->frame.type &&
+            fs[cp->level].ds_first == cp->frame.ds_first), -1, "checkpoint frame is no longer open");
+    if (B->emit_start != cp->emit_start || B->emit_end != cp->emit_end) {
+        /* Custom emitters cannot be asked to reuse emitted space. */
+        if (!B->is_default_emitter) {
+            return -1;
+        }
+        if (flatcc_emitter_rewind(&B->default_emit_context, cp->emit_start, cp->emit_end)) {
+            return -1;
+        }
+        B->emit_start = cp->emit_start;
+        B->emit_end = cp->emit_end;
+    }
+
+    /* The stacks must be zero above the active range. */
+    top = B->ds_first + B->ds_offset;
+    cp_top = cp->ds_first + cp->ds_offset;
+    if (top > cp_top) {
+        memset(ds_ptr(cp_top), 0, top - cp_top);
+    }
+    vs_top = vs_offset(B->vs) + B->id_end * (uoffset_t)sizeof(voffset_t);
+    top = cp->vs_offset + cp->id_end * (uoffset_t)sizeof(voffset_t);
+    if (vs_top > top) {
+        memset(vs_ptr(top), 0, vs_top - top);
+    }
+    B->vs = vs_ptr(cp->vs_offset);
+    if (cp->level > 0 && cp->frame.type == flatcc_builder_table) {
+        /* Fields added to the checkpoint table after the checkpoint. */
+        for (id = 0, vs = B->vs; id < cp->id_end; ++id) {
+            if (vs[id] && (uoffset_t)(vs[id] - field_size) >= cp->ds_offset) {
+                vs[id] = 0;
+            }
+        }
+    }
+    B->pl = pl_ptr(cp->pl_offset);
+    B->id_end = cp->id_end;
+    B->vt_hash = cp->vt_hash;
+
+    B->level = cp->level;
+    B->ds_first = cp->ds_first;
+    B->ds_offset = cp->ds_offset;
+    if (cp->level > 0) {
+        B->frame = fs + cp->level;
+        *B->frame = cp->frame;
+        refresh_ds(B, frame(type_limit));
+    } else {
+        B->frame = 0;
+        B->ds = B->buffers[flatcc_builder_alloc_ds].iov_base;
+        B->ds_limit = 0;
+    }
+
+    if (B->vd_end != cp->vd_end || B->vd_revived != cp->vd_revived ||
+            B->vb_flush_count != cp->vb_flush_count) {
+        if (B->vb_flush_count != cp->vb_flush_count || cp->vd_end == 0) {
+            /* An empty cache is always valid. */
+            flatcc_builder_flush_vtable_cache(B);
+        } else {
+            rollback_vtable_cache(B, cp->vd_end, cp->vd_revived);
+            B->vd_end = cp->vd_end;
+            B->vb_end = cp->vb_end;
+        }
+    }
+
+    if (B->sd_end != cp->sd_end || B->sb_flush_count != cp->sb_flush_count) {
+        if (B->sb_flush_count != cp->sb_flush_count || cp->sd_end == 0) {
+            flatcc_builder_flush_string_cache(B);
+        } else {
+            rollback_string_cache(B, cp->sd_end);
+            B->sd_end = cp->sd_end;
+            B->sb_end = cp->sb_end;
+        }
+    }
+
+    B->shared_bytes_saved = cp->shared_bytes_saved;
+    B->fr_end = cp->fr_end;
+    B->min_align = cp->min_align;
+    B->align = cp->align;
+    B->block_align = cp->block_align;
+    B->buffer_mark = cp->buffer_mark;
+    memcpy(B->identifier, cp->identifier, identifier_size);
+    B->user_frame_offset = cp->user_frame_offset;
+    B->user_frame_end = cp->user_frame_end;
+    return 0;
+}
+
 static inline uoffset_t front_pad(flatcc_builder_t *B, uoffset_t size, uint16_t align)
 {
     return (B->emit_start - size) & (align - 1);
@@ -608,6 +1136,7 @@ static inline flatcc_builder_ref_t emit_front(flatcc_builder_t *B, iov_state_t *
         check(0, "emitter rejected buffer content");
         return 0;
     }
+    stats_update(B, B->stats.front_bytes += iov->len);
     return B->emit_start = ref;
 }
 
@@ -634,6 +1163,7 @@ static inline flatcc_builder_ref_t emit_back(flatcc_builder_t *B, iov_state_t *i
         check(0, "emitter rejected buffer content");
         return 0;
     }
+    stats_update(B, B->stats.back_bytes += iov->len);
     /*
      * Back references always return ref + 1 because ref == 0 is valid and
      * should not be mistaken for error. vtables understand this.
@@ -692,7 +1222,13 @@ flatcc_builder_ref_t flatcc_builder_create_buffer(flatcc_builder_t *B,
     uoffset_t header_pad, id_size;
     uoffset_t object_offset, buffer_size, buffer_base;
     iov_state_t iov;
+    /* Nested buffers are ubyte vectors, stream buffers are size prefixed. */
+    int has_size = is_nested || B->stream_mode;
 
+    if (!is_nested && B->stream_mode && block_align < field_size) {
+        /* Keeps the next buffer in the stream aligned. */
+        block_align = field_size;
+    }
     if (align_to_block(B, &align, block_align, is_nested)) {
         return 0;
     }
@@ -705,12 +1241,13 @@ flatcc_builder_ref_t flatcc_builder_create_buffer(flatcc_builder_t *B,
     header_pad = front_pad(B, field_size + id_size, align);
     init_iov();
     /* ubyte vectors size field wrapping nested buffer. */
-    push_iov_cond(&buffer_size, field_size, is_nested);
+    push_iov_cond(&buffer_size, field_size, has_size);
     push_iov(&object_offset, field_size);
     push_iov(identifier, id_size);
     push_iov(_pad, header_pad);
-    buffer_base = (uoffset_t)B->emit_start - (uoffset_t)iov.len + (is_nested ? field_size : 0);
-    buffer_size = store_uoffset((uoffset_t)B->buffer_mark - buffer_base);
+    buffer_base = (uoffset_t)B->emit_start - (uoffset_t)iov.len + (has_size ? field_size : 0);
+    /* Stream buffers include the clustered vtables at the back. */
+    buffer_size = store_uoffset((uoffset_t)(is_nested ? B->buffer_mark : B->emit_end) - buffer_base);
     object_offset = store_uoffset((uoffset_t)object_ref - buffer_base);
     if (0 == (buffer_ref = emit_front(B, &iov))) {
         check(0, "emitter rejected buffer content");
@@ -723,8 +1260,15 @@ flatcc_builder_ref_t flatcc_builder_create_struct(flatcc_builder_t *B, const voi
 {
     size_t pad;
     iov_state_t iov;
+    flatcc_builder_ref_t ref;
+    uoffset_t *slot = 0;
 
     check(align >= 1, "align cannot be 0");
+    if (B->dedup_objects) {
+        if ((ref = find_shared(B, &slot, flatcc_builder_struct, 0, align, data, size))) {
+            return ref;
+        }
+    }
     set_min_align(B, align);
     pad = front_pad(B, (uoffset_t)size, align);
     init_iov();
@@ -734,7 +1278,13 @@ flatcc_builder_ref_t flatcc_builder_create_struct(flatcc_builder_t *B, const voi
      * so this padding will not likely be emitted.
      */
     push_iov(_pad, pad);
-    return emit_front(B, &iov);
+    if (0 == (ref = emit_front(B, &iov))) {
+        return 0;
+    }
+    if (slot && add_shared(B, slot, ref, flatcc_builder_struct, 0, align, data, size)) {
+        return 0;
+    }
+    return ref;
 }
 
 int flatcc_builder_start_buffer(flatcc_builder_t *B,
@@ -1058,14 +1608,26 @@ flatcc_builder_vt_ref_t flatcc_builder_create_vtable(flatcc_builder_t *B,
     return vt_ref;
 }
 
+static inline void update_vtable_stats(flatcc_builder_t *B, size_t chain, int hit)
+{
+    ++B->stats.vtable_lookups;
+    B->stats.vtable_hits += (size_t)hit;
+    B->stats.vtable_chain_steps += chain;
+    if (B->stats.vtable_max_chain < chain) {
+        B->stats.vtable_max_chain = chain;
+    }
+}
+
 flatcc_builder_vt_ref_t flatcc_builder_create_cached_vtable(flatcc_builder_t *B,
         const voffset_t *vt, voffset_t vt_size, uint32_t vt_hash)
 {
     vtable_descriptor_t *vd, *vd2;
     uoffset_t *pvd, *pvd_head;
-    uoffset_t next;
+    uoffset_t next, vb_start2 = 0;
     voffset_t *vt_;
     voffset_t encoded_vt_size;
+    flatcc_builder_vt_ref_t vt_ref;
+    size_t chain = 0;
 
     /* This just gets the hash table slot, we still have to inspect it. */
     if (!(pvd_head = lookup_ht(B, vt_hash))) {
@@ -1077,6 +1639,7 @@ flatcc_builder_vt_ref_t flatcc_builder_create_cached_vtable(flatcc_builder_t *B,
     vd2 = 0;
     encoded_vt_size = vt[0];
     while (next) {
+        ++chain;
         vd = vd_ptr(next);
         vt_ = vb_ptr(vd->vb_start);
         if (vt_[0] != encoded_vt_size || 0 != memcmp(vt, vt_, vt_size)) {
@@ -1084,10 +1647,26 @@ flatcc_builder_vt_ref_t flatcc_builder_create_cached_vtable(flatcc_builder_t *B,
             next = vd->next;
             continue;
         }
+        if (vd->buffer_mark == stale_buffer_mark) {
+            /*
+             * Kept from an earlier buffer in stream mode: emit a copy
+             * and reuse the descriptor so the cache does not grow with
+             * every buffer.
+             */
+            if (0 == (vd->vt_ref = flatcc_builder_create_vtable(B, vt, vt_size))) {
+                return 0;
+            }
+            vd->buffer_mark = B->buffer_mark;
+            /* Rollback returns the descriptor to the stale state. */
+            vd->revived_next = B->vd_revived;
+            B->vd_revived = next;
+        }
         /* Can't share emitted vtables between buffers, */
         if (vd->buffer_mark != B->buffer_mark) {
             /* but we don't have to resubmit to cache. */
             vd2 = vd;
+            /* The descriptor may move when a new one is allocated. */
+            vb_start2 = vd->vb_start;
             /* See if there is a better match. */
             pvd = &vd->next;
             next = vd->next;
@@ -1095,13 +1674,15 @@ flatcc_builder_vt_ref_t flatcc_builder_create_cached_vtable(flatcc_builder_t *B,
         }
         /* Move to front hash strategy. */
         if (pvd != pvd_head) {
-            *pvd = next;
+            *pvd = vd->next;
             vd->next = *pvd_head;
             *pvd_head = next;
         }
         /* vtable exists and has been emitted within current buffer. */
+        stats_update(B, update_vtable_stats(B, chain, 1));
         return vd->vt_ref;
     }
+    stats_update(B, update_vtable_stats(B, chain, 0));
     /* Allocate new descriptor. */
     if (!(vd = reserve_buffer(B, flatcc_builder_alloc_vd, B->vd_end, sizeof(vtable_descriptor_t), 0))) {
         return 0;
@@ -1111,6 +1692,7 @@ flatcc_builder_vt_ref_t flatcc_builder_create_cached_vtable(flatcc_builder_t *B,
 
     /* Identify the buffer this vtable descriptor belongs to. */
     vd->buffer_mark = B->buffer_mark;
+    vd->slot = (uoffset_t)(pvd_head - (uoffset_t *)B->buffers[flatcc_builder_alloc_ht].iov_base);
 
     /* Move to front hash strategy. */
     vd->next = *pvd_head;
@@ -1120,10 +1702,13 @@ flatcc_builder_vt_ref_t flatcc_builder_create_cached_vtable(flatcc_builder_t *B,
     }
     if (vd2) {
         /* Reuse cached copy. */
-        vd->vb_start = vd2->vb_start;
+        vd->vb_start = vb_start2;
     } else {
         if (B->vb_flush_limit && B->vb_flush_limit < B->vb_end + vt_size) {
+            /* Flushing may seed a dictionary over the descriptor. */
+            vt_ref = vd->vt_ref;
             flatcc_builder_flush_vtable_cache(B);
+            return vt_ref;
         } else {
             /* Make space in vtable cache. */
             if (!(vt_ = reserve_buffer(B, flatcc_builder_alloc_vb, B->vb_end, vt_size, 0))) {
@@ -1142,6 +1727,8 @@ flatcc_builder_ref_t flatcc_builder_create_table(flatcc_builder_t *B, const void
 {
     int i;
     uoffset_t pad, vt_offset, vt_offset_field, vt_base, base, offset, *offset_field;
+    flatcc_builder_ref_t table_ref;
+    fragment_table_t *ft;
     iov_state_t iov;
 
     check(offset_count >= 0, "expected non-negative offset_count");
@@ -1174,7 +1761,21 @@ flatcc_builder_ref_t flatcc_builder_create_table(flatcc_builder_t *B, const void
     push_iov(&vt_offset_field, field_size);
     push_iov(data, size);
     push_iov(_pad, pad);
-    return emit_front(B, &iov);
+    if (0 == (table_ref = emit_front(B, &iov))) {
+        return 0;
+    }
+    /* Only clustered vtables are outside the fragment content. */
+    if (B->fragment_mode && vt_ref > 0) {
+        if (!(ft = reserve_buffer(B, flatcc_builder_alloc_fr, B->fr_end, sizeof(*ft), 0))) {
+            return 0;
+        }
+        ft->table = table_ref;
+        ft->vt_ref = vt_ref;
+        /* Final hash when called from `end_table`. */
+        ft->vt_hash = B->vt_hash;
+        B->fr_end += (uoffset_t)sizeof(*ft);
+    }
+    return table_ref;
 }
 
 int flatcc_builder_check_required_field(flatcc_builder_t *B, flatbuffers_voffset_t id)
@@ -1223,6 +1824,7 @@ flatcc_builder_ref_t flatcc_builder_end_table(flatcc_builder_t *B)
     flatcc_builder_ref_t table_ref, vt_ref;
     int pl_count;
     voffset_t *pl;
+    uoffset_t *slot = 0;
 
     check(frame(type) == flatcc_builder_table, "expected table frame");
 
@@ -1248,8 +1850,18 @@ flatcc_builder_ref_t flatcc_builder_end_table(flatcc_builder_t *B)
 
     pl = pl_ptr(frame(table.pl_end));
     pl_count = (int)(B->pl - pl);
-    if (0 == (table_ref = flatcc_builder_create_table(B, B->ds, B->ds_offset, B->align, pl, pl_count, vt_ref))) {
-        return 0;
+    /* Only leaf tables are shared, offset fields would need patching. */
+    table_ref = 0;
+    if (B->dedup_objects && pl_count == 0) {
+        table_ref = find_shared(B, &slot, flatcc_builder_table, vt_ref, B->align, B->ds, B->ds_offset);
+    }
+    if (table_ref == 0) {
+        if (0 == (table_ref = flatcc_builder_create_table(B, B->ds, B->ds_offset, B->align, pl, pl_count, vt_ref))) {
+            return 0;
+        }
+        if (slot && add_shared(B, slot, table_ref, flatcc_builder_table, vt_ref, B->align, B->ds, B->ds_offset)) {
+            return 0;
+        }
     }
     B->vt_hash = frame(table.vt_hash);
     B->id_end = frame(table.id_end);
@@ -1271,10 +1883,11 @@ flatcc_builder_ref_t flatcc_builder_create_vector(flatcc_builder_t *B,
      */
     uoffset_t vec_size, vec_pad, length_prefix;
     iov_state_t iov;
+    flatcc_builder_ref_t ref;
+    uoffset_t *slot = 0;
 
     check_error(count <= max_count, 0, "vector max_count violated");
     get_min_align(&align, field_size);
-    set_min_align(B, align);
     vec_size = (uoffset_t)count * (uoffset_t)elem_size;
     /*
      * That can happen on 32 bit systems when uoffset_t is defined as 64-bit.
@@ -1283,6 +1896,13 @@ flatcc_builder_ref_t flatcc_builder_create_vector(flatcc_builder_t *B,
 #if FLATBUFFERS_UOFFSET_MAX > SIZE_MAX
     check_error(vec_size < SIZE_MAX, 0, "vector larger than address space");
 #endif
+    if (B->dedup_objects) {
+        if ((ref = find_shared(B, &slot, flatcc_builder_vector,
+                (flatcc_builder_ref_t)elem_size, align, data, vec_size))) {
+            return ref;
+        }
+    }
+    set_min_align(B, align);
     length_prefix = store_uoffset((uoffset_t)count);
     /* Alignment is calculated for the first element, not the header. */
     vec_pad = front_pad(B, vec_size, align);
@@ -1290,7 +1910,14 @@ flatcc_builder_ref_t flatcc_builder_create_vector(flatcc_builder_t *B,
     push_iov(&length_prefix, field_size);
     push_iov(data, vec_size);
     push_iov(_pad, vec_pad);
-    return emit_front(B, &iov);
+    if (0 == (ref = emit_front(B, &iov))) {
+        return 0;
+    }
+    if (slot && add_shared(B, slot, ref, flatcc_builder_vector,
+            (flatcc_builder_ref_t)elem_size, align, data, vec_size)) {
+        return 0;
+    }
+    return ref;
 }
 
 /*
@@ -1318,6 +1945,32 @@ flatcc_builder_ref_t flatcc_builder_end_vector(flatcc_builder_t *B)
     return vector_ref;
 }
 
+flatcc_builder_ref_t flatcc_builder_create_byteswapped_vector(flatcc_builder_t *B,
+        const void *data, size_t count, size_t elem_size, size_t swap_width,
+        uint16_t align, size_t max_count)
+{
+    void *p;
+
+    check(elem_size % swap_width == 0, "element size must be a multiple of swap width");
+    if (flatcc_builder_start_vector(B, elem_size, align, max_count)) {
+        return 0;
+    }
+    if (!(p = flatcc_builder_extend_vector(B, count))) {
+        return 0;
+    }
+    flatcc_byteswap_copy(p, data, count * elem_size, swap_width);
+    return flatcc_builder_end_vector(B);
+}
+
+flatcc_builder_ref_t flatcc_builder_end_byteswapped_vector(flatcc_builder_t *B,
+        size_t swap_width)
+{
+    check(frame(type) == flatcc_builder_vector, "expected vector frame");
+    check(frame(vector.elem_size) % swap_width == 0, "element size must be a multiple of swap width");
+    flatcc_byteswap_copy(B->ds, B->ds, frame(vector.count) * frame(vector.elem_size), swap_width);
+    return flatcc_builder_end_vector(B);
+}
+
 size_t flatcc_builder_vector_count(flatcc_builder_t *B)
 {
     return frame(vector.count);
@@ -1388,7 +2041,7 @@ void *flatcc_builder_offset_vector_edit(flatcc_builder_t *B)
     return B->ds;
 }
 
-flatcc_builder_ref_t flatcc_builder_create_string(flatcc_builder_t *B, const char *s, size_t len)
+static flatcc_builder_ref_t emit_string(flatcc_builder_t *B, const char *s, size_t len)
 {
     uoffset_t s_pad;
     uoffset_t length_prefix;
@@ -1407,6 +2060,44 @@ flatcc_builder_ref_t flatcc_builder_create_string(flatcc_builder_t *B, const cha
     return emit_front(B, &iov);
 }
 
+flatcc_builder_ref_t flatcc_builder_create_shared_string(flatcc_builder_t *B, const char *s, size_t len)
+{
+    flatcc_builder_ref_t ref;
+    uoffset_t *slot;
+
+    if (len > max_string_len) {
+        return 0;
+    }
+    if ((ref = find_shared(B, &slot, flatcc_builder_string, 0, 0, s, len))) {
+        return ref;
+    }
+    if (0 == (ref = emit_string(B, s, len))) {
+        return 0;
+    }
+    if (slot && add_shared(B, slot, ref, flatcc_builder_string, 0, 0, s, len)) {
+        return 0;
+    }
+    return ref;
+}
+
+flatcc_builder_ref_t flatcc_builder_create_shared_string_str(flatcc_builder_t *B, const char *s)
+{
+    return flatcc_builder_create_shared_string(B, s, strlen(s));
+}
+
+flatcc_builder_ref_t flatcc_builder_create_shared_string_strn(flatcc_builder_t *B, const char *s, size_t max_len)
+{
+    return flatcc_builder_create_shared_string(B, s, strnlen(s, max_len));
+}
+
+flatcc_builder_ref_t flatcc_builder_create_string(flatcc_builder_t *B, const char *s, size_t len)
+{
+    if (B->intern_strings) {
+        return flatcc_builder_create_shared_string(B, s, len);
+    }
+    return emit_string(B, s, len);
+}
+
 flatcc_builder_ref_t flatcc_builder_create_string_str(flatcc_builder_t *B, const char *s)
 {
     return flatcc_builder_create_string(B, s, strlen(s));
@@ -1539,6 +2230,236 @@ void flatcc_builder_set_vtable_clustering(flatcc_builder_t *B, int enable)
     B->disable_vt_clustering = !enable;
 }
 
+void flatcc_builder_set_string_interning(flatcc_builder_t *B, int enable)
+{
+    B->intern_strings = enable;
+}
+
+void flatcc_builder_set_object_dedup(flatcc_builder_t *B, int enable)
+{
+    B->dedup_objects = enable;
+}
+
+size_t flatcc_builder_get_shared_bytes_saved(flatcc_builder_t *B)
+{
+    return B->shared_bytes_saved;
+}
+
+void flatcc_builder_set_stats(flatcc_builder_t *B, int enable)
+{
+#if FLATCC_BUILDER_STATS
+    if (enable && !B->enable_stats) {
+        memset(&B->stats, 0, sizeof(B->stats));
+        B->stats.peak_level = B->level;
+        B->stats_page_alloc_base = B->default_emit_context.page_alloc_count;
+        B->stats_page_reuse_base = B->default_emit_context.page_reuse_count;
+    }
+    if (!enable && B->enable_stats) {
+        /* Keep the emitter counts of the sample. */
+        flatcc_builder_get_stats(B, &B->stats);
+    }
+    B->enable_stats = !!enable;
+#else
+    (void)B;
+    (void)enable;
+#endif
+}
+
+void flatcc_builder_get_stats(flatcc_builder_t *B, flatcc_builder_stats_t *stats)
+{
+#if FLATCC_BUILDER_STATS
+    flatcc_emitter_t *E = &B->default_emit_context;
+
+    *stats = B->stats;
+    if (B->is_default_emitter && B->enable_stats) {
+        stats->emitter_pages_allocated = E->page_alloc_count - B->stats_page_alloc_base;
+        stats->emitter_pages_recycled = E->page_reuse_count - B->stats_page_reuse_base;
+    }
+#else
+    (void)B;
+    memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+void flatcc_builder_set_fragment_mode(flatcc_builder_t *B, int enable)
+{
+    B->fragment_mode = enable;
+}
+
+void flatcc_builder_set_stream_mode(flatcc_builder_t *B, int enable)
+{
+    B->stream_mode = enable;
+}
+
+flatcc_refmap_t *flatcc_builder_set_refmap(flatcc_builder_t *B, flatcc_refmap_t *refmap)
+{
+    flatcc_refmap_t *refmap_old = B->refmap;
+
+    B->refmap = refmap;
+    return refmap_old;
+}
+
+flatcc_builder_ref_t flatcc_builder_refmap_find(flatcc_builder_t *B, const void *src)
+{
+    return B->refmap ? flatcc_refmap_find(B->refmap, src) : 0;
+}
+
+flatcc_builder_ref_t flatcc_builder_refmap_insert(flatcc_builder_t *B,
+        const void *src, flatcc_builder_ref_t ref)
+{
+    return B->refmap ? flatcc_refmap_insert(B->refmap, src, ref) : ref;
+}
+
+/*
+ * Maps fragment addresses to the default emitter pages of the fragment
+ * builder. Table log entries are mostly visited in decreasing address
+ * order, so the cursor moves incrementally between pages.
+ */
+typedef struct fragment_cursor fragment_cursor_t;
+struct fragment_cursor {
+    flatcc_iovec_t *iov;
+    int i;
+    flatcc_builder_ref_t base;
+};
+
+static void fragment_copy(fragment_cursor_t *c, flatcc_builder_ref_t pos, void *data, size_t len, int write)
+{
+    uint8_t *p, *d = data;
+    size_t k;
+
+    while (len) {
+        while (pos < c->base) {
+            --c->i;
+            c->base -= (flatcc_builder_ref_t)c->iov[c->i].iov_len;
+        }
+        while (pos >= c->base + (flatcc_builder_ref_t)c->iov[c->i].iov_len) {
+            c->base += (flatcc_builder_ref_t)c->iov[c->i].iov_len;
+            ++c->i;
+        }
+        p = (uint8_t *)c->iov[c->i].iov_base + (pos - c->base);
+        k = c->iov[c->i].iov_len - (size_t)(pos - c->base);
+        k = k < len ? k : len;
+        if (write) {
+            memcpy(p, d, k);
+        } else {
+            memcpy(d, p, k);
+        }
+        d += k;
+        pos += (flatcc_builder_ref_t)k;
+        len -= k;
+    }
+}
+
+int flatcc_builder_splice_fragment(flatcc_builder_t *B, flatcc_builder_t *F,
+        flatcc_builder_ref_t *refs, int count)
+{
+    fragment_table_t *ft = F->buffers[flatcc_builder_alloc_fr].iov_base, *bft = 0;
+    size_t i, n = F->fr_end / sizeof(fragment_table_t);
+    flatcc_iovec_t *pages = 0;
+    fragment_cursor_t c;
+    uint8_t *vb = 0;
+    voffset_t *vt;
+    flatcc_builder_vt_ref_t vt_ref = 0, spliced_vt_ref = 0;
+    flatcc_builder_ref_t pos, end, base;
+    uoffset_t pad, vt_offset_field;
+    uint16_t align = F->min_align;
+    iov_state_t iov;
+    int k, page_count, ret = -1;
+
+    check_error(B != F, -1, "cannot splice a builder into itself");
+    check_error(F->is_default_emitter && F->level == 0, -1, "fragment builder must use default emitter and have no open frames");
+    check_error(F->fragment_mode || F->emit_end == 0, -1, "fragment builder with clustered vtables must be in fragment mode");
+    if (F->emit_start == 0 && F->emit_end == 0) {
+        return 0;
+    }
+    page_count = flatcc_emitter_get_buffer_iov(&F->default_emit_context, 0, 0);
+    if (!(pages = malloc(sizeof(*pages) * (size_t)page_count))) {
+        goto done;
+    }
+    flatcc_emitter_get_buffer_iov(&F->default_emit_context, pages, page_count);
+    c.iov = pages;
+    c.i = 0;
+    c.base = F->emit_start;
+    if (F->emit_end > 0) {
+        if (!(vb = malloc((size_t)F->emit_end))) {
+            goto done;
+        }
+        fragment_copy(&c, 0, vb, (size_t)F->emit_end, 0);
+    }
+    /*
+     * Find or create each vtable in B first because B might emit them
+     * in front when it does not cluster vtables. The log is updated to
+     * hold the vtable references of B. The logged hash is the one the
+     * fragment builder cached the vtable under, so spliced tables share
+     * vtables with each other and with tables built natively in B.
+     */
+    for (i = 0; i < n; ++i) {
+        if (ft[i].vt_ref != vt_ref) {
+            vt_ref = ft[i].vt_ref;
+            vt = (voffset_t *)(vb + vt_ref - 1);
+            if (!(spliced_vt_ref = flatcc_builder_create_cached_vtable(B, vt, load_voffset(vt[0]), ft[i].vt_hash))) {
+                goto done;
+            }
+        }
+        ft[i].vt_ref = spliced_vt_ref;
+    }
+    /*
+     * Fragment addresses are aligned relative to 0, so the end of the
+     * fragment must be placed at an address aligned to the fragment
+     * alignment.
+     */
+    get_min_align(&align, field_size);
+    set_min_align(B, align);
+    if ((pad = front_pad(B, 0, align))) {
+        init_iov();
+        push_iov(_pad, pad);
+        if (!emit_front(B, &iov)) {
+            goto done;
+        }
+    }
+    base = B->emit_start;
+    if (B->fragment_mode && n > 0) {
+        /* Make the tables known to B so B can itself be spliced. */
+        if (!(bft = reserve_buffer(B, flatcc_builder_alloc_fr, B->fr_end, n * sizeof(*bft), 0))) {
+            goto done;
+        }
+    }
+    for (i = 0; i < n; ++i) {
+        vt_offset_field = store_uoffset((uoffset_t)(ft[i].table + base) - (uoffset_t)(ft[i].vt_ref - 1));
+        fragment_copy(&c, ft[i].table, &vt_offset_field, field_size, 1);
+        if (bft && ft[i].vt_ref > 0) {
+            bft->table = ft[i].table + base;
+            bft->vt_ref = ft[i].vt_ref;
+            bft->vt_hash = ft[i].vt_hash;
+            B->fr_end += (uoffset_t)sizeof(*bft);
+            ++bft;
+        }
+    }
+    /* Emit the front part of each page, highest address first. */
+    end = F->emit_end;
+    for (k = page_count; k-- > 0; end = pos) {
+        pos = end - (flatcc_builder_ref_t)pages[k].iov_len;
+        if (pos >= 0) {
+            continue;
+        }
+        init_iov();
+        push_iov(pages[k].iov_base, (size_t)((end < 0 ? end : 0) - pos));
+        if (!emit_front(B, &iov)) {
+            goto done;
+        }
+    }
+    for (k = 0; k < count; ++k) {
+        if (refs[k]) {
+            refs[k] += base;
+        }
+    }
+    ret = 0;
+done:
+    free(pages);
+    free(vb);
+    return ret;
+}
+
 void flatcc_builder_set_block_align(flatcc_builder_t *B, uint16_t align)
 {
     B->block_align = align;
@@ -1572,11 +2493,36 @@ flatcc_builder_ref_t flatcc_builder_get_buffer_end(flatcc_builder_t *B)
     return B->emit_end;
 }
 
+int flatcc_builder_reserve(flatcc_builder_t *B, size_t size)
+{
+    iovec_t *buf = B->buffers + flatcc_builder_alloc_ds;
+
+    if (B->ds_first + size + 1 > buf->iov_len) {
+        if (call_alloc(B, buf, B->ds_first + size + 1, 1, flatcc_builder_alloc_ds)) {
+            return -1;
+        }
+        if (B->level > 0) {
+            refresh_ds(B, frame(type_limit));
+        } else {
+            B->ds = buf->iov_base;
+        }
+    }
+    if (B->is_default_emitter) {
+        return flatcc_emitter_reserve(&B->default_emit_context, size);
+    }
+    return 0;
+}
+
 void flatcc_builder_set_vtable_cache_limit(flatcc_builder_t *B, size_t size)
 {
     B->vb_flush_limit = size;
 }
 
+void flatcc_builder_set_string_cache_limit(flatcc_builder_t *B, size_t size)
+{
+    B->sb_flush_limit = size;
+}
+
 void flatcc_builder_set_identifier(flatcc_builder_t *B, const char identifier[identifier_size])
 {
     memcpy(B->identifier, identifier ? identifier : (const char *)_pad, identifier_size);
@@ -1607,6 +2553,14 @@ void *flatcc_builder_get_direct_buffer(flatcc_builder_t *B, size_t *size_out)
     return 0;
 }
 
+int flatcc_builder_get_buffer_iov(flatcc_builder_t *B, flatcc_iovec_t *iov, int iov_max)
+{
+    if (!B->is_default_emitter) {
+        return -1;
+    }
+    return flatcc_emitter_get_buffer_iov(&B->default_emit_context, iov, iov_max);
+}
+
 void *flatcc_builder_copy_buffer(flatcc_builder_t *B, void *buffer, size_t size)
 {
     /* User is allowed to call tentatively to see if there is support. */
@@ -1647,6 +2601,44 @@ done:
     return buffer;
 }
 
+void *flatcc_builder_aligned_alloc(size_t alignment, size_t size)
+{
+#ifdef FLATBUFFERS_HAVE_ALIGNED_ALLOC
+    size = alignup(size, alignment);
+    return aligned_alloc(alignment, size);
+#else
+    uint8_t *base, *p;
+
+    /*
+     * The block start is stored just before the aligned pointer so it
+     * can be freed.
+     */
+    if (alignment < sizeof(void *)) {
+        alignment = sizeof(void *);
+    }
+    if (!(base = malloc(size + alignment - 1 + sizeof(void *)))) {
+        return 0;
+    }
+    p = (uint8_t *)alignup((size_t)(base + sizeof(void *)), alignment);
+    memcpy(p - sizeof(void *), &base, sizeof(base));
+    return p;
+#endif
+}
+
+void flatcc_builder_aligned_free(void *p)
+{
+#ifdef FLATBUFFERS_HAVE_ALIGNED_ALLOC
+    free(p);
+#else
+    void *base;
+
+    if (p) {
+        memcpy(&base, (uint8_t *)p - sizeof(void *), sizeof(base));
+        free(base);
+    }
+#endif
+}
+
 void *flatcc_builder_finalize_aligned_buffer(flatcc_builder_t *B, size_t *size_out)
 {
     void * buffer;
@@ -1660,18 +2652,14 @@ void *flatcc_builder_finalize_aligned_buffer(flatcc_builder_t *B, size_t *size_o
     }
     align = flatcc_builder_get_buffer_alignment(B);
 
-#ifdef FLATBUFFERS_HAVE_ALIGNED_ALLOC
-    size = (size + align - 1) & ~(align - 1);
-    buffer = aligned_alloc(align, size);
-#else
-    buffer = (void *)(((size_t)malloc(size + align - 1) + align - 1) & ~(align - 1));
-#endif
+    buffer = flatcc_builder_aligned_alloc(align, size);
 
     if (!buffer) {
+        check(0, "failed to allocated memory for finalized buffer");
         goto done;
     }
     if (!flatcc_builder_copy_buffer(B, buffer, size)) {
-        free(buffer);
+        flatcc_builder_aligned_free(buffer);
         buffer = 0;
         goto done;
     }
@@ -1682,6 +2670,28 @@ done:
     return buffer;
 }
 
+size_t flatcc_builder_get_aligned_buffer_size(flatcc_builder_t *B)
+{
+    return flatcc_builder_get_buffer_size(B) + flatcc_builder_get_buffer_alignment(B) - 1;
+}
+
+void *flatcc_builder_finalize_buffer_into(flatcc_builder_t *B,
+        void *mem, size_t capacity, size_t *size_out)
+{
+    void *buffer = 0;
+    size_t size, pad;
+
+    size = flatcc_builder_get_buffer_size(B);
+    pad = alignup((size_t)mem, (size_t)flatcc_builder_get_buffer_alignment(B)) - (size_t)mem;
+    if (mem && capacity >= pad && capacity - pad >= size) {
+        buffer = flatcc_builder_copy_buffer(B, (uint8_t *)mem + pad, size);
+    }
+    if (size_out) {
+        *size_out = buffer ? size : 0;
+    }
+    return buffer;
+}
+
 void *flatcc_builder_get_emit_context(flatcc_builder_t *B)
 {
     return B->emit_context;
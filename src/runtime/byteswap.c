@@ -0,0 +1,166 @@
+/*
+ * Bulk byte swapping, see `flatcc_byteswap.h`.
+ *
+ * SSE2 is part of the x86-64 base instruction set and is used whenever
+ * it is available at compile time. AVX2 is compiled separately with a
+ * target attribute and chosen at runtime, so the library does not need
+ * to be built for the CPU it runs on. The vector kernels handle whole
+ * blocks and the scalar loop handles the remaining tail.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_byteswap.h"
+
+#if FLATCC_BYTESWAP_SIMD && (defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define HAVE_SSE2 0
+#endif
+
+#if HAVE_SSE2 && (defined(__x86_64__) || defined(__i386__)) && \
+        ((defined(__clang__) && __clang_major__ >= 4) || \
+        (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 5))
+#define HAVE_AVX2 1
+#include <immintrin.h>
+#else
+#define HAVE_AVX2 0
+#endif
+
+static inline uint16_t bswap16(uint16_t x)
+{
+    return (uint16_t)((x >> 8) | (x << 8));
+}
+
+static inline uint32_t bswap32(uint32_t x)
+{
+    return ((x >> 24) & 0xffu) | ((x >> 8) & 0xff00u) |
+        ((x << 8) & 0xff0000u) | ((x << 24) & 0xff000000u);
+}
+
+static inline uint64_t bswap64(uint64_t x)
+{
+    return ((uint64_t)bswap32((uint32_t)x) << 32) | bswap32((uint32_t)(x >> 32));
+}
+
+static void swap_scalar(uint8_t *d, const uint8_t *s, size_t size, size_t width)
+{
+    size_t i;
+    uint16_t x16;
+    uint32_t x32;
+    uint64_t x64;
+
+    switch (width) {
+    case 2:
+        for (i = 0; i < size; i += 2) {
+            memcpy(&x16, s + i, 2);
+            x16 = bswap16(x16);
+            memcpy(d + i, &x16, 2);
+        }
+        break;
+    case 4:
+        for (i = 0; i < size; i += 4) {
+            memcpy(&x32, s + i, 4);
+            x32 = bswap32(x32);
+            memcpy(d + i, &x32, 4);
+        }
+        break;
+    case 8:
+        for (i = 0; i < size; i += 8) {
+            memcpy(&x64, s + i, 8);
+            x64 = bswap64(x64);
+            memcpy(d + i, &x64, 8);
+        }
+        break;
+    default:
+        if (d != s) {
+            memcpy(d, s, size);
+        }
+        break;
+    }
+}
+
+#if HAVE_SSE2
+/*
+ * SSE2 has no byte shuffle, so 16-bit words are reordered within each
+ * unit first and the bytes of each word are then swapped by shifts.
+ * Returns the number of bytes processed.
+ */
+static size_t swap_sse2(uint8_t *d, const uint8_t *s, size_t size, size_t width)
+{
+    size_t i, n = size & ~(size_t)15;
+    __m128i x;
+
+    for (i = 0; i < n; i += 16) {
+        x = _mm_loadu_si128((const __m128i *)(const void *)(s + i));
+        if (width == 4) {
+            x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+            x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+        } else if (width == 8) {
+            x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+            x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+        }
+        x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+        _mm_storeu_si128((__m128i *)(void *)(d + i), x);
+    }
+    return n;
+}
+#endif
+
+#if HAVE_AVX2
+__attribute__((target("avx2")))
+static size_t swap_avx2(uint8_t *d, const uint8_t *s, size_t size, size_t width)
+{
+    size_t i, n = size & ~(size_t)31;
+    __m256i x, mask;
+
+    switch (width) {
+    case 2:
+        mask = _mm256_setr_epi8(
+                1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+        break;
+    case 4:
+        mask = _mm256_setr_epi8(
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        break;
+    default:
+        mask = _mm256_setr_epi8(
+                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+        break;
+    }
+    for (i = 0; i < n; i += 32) {
+        x = _mm256_loadu_si256((const __m256i *)(const void *)(s + i));
+        x = _mm256_shuffle_epi8(x, mask);
+        _mm256_storeu_si256((__m256i *)(void *)(d + i), x);
+    }
+    return n;
+}
+#endif
+
+void flatcc_byteswap_copy(void *dst, const void *src, size_t size, size_t width)
+{
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+    size_t n = 0;
+
+    if (width != 2 && width != 4 && width != 8) {
+        swap_scalar(d, s, size, width);
+        return;
+    }
+#if HAVE_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        n = swap_avx2(d, s, size, width);
+    }
+#endif
+#if HAVE_SSE2
+    n += swap_sse2(d + n, s + n, size - n, width);
+#endif
+    swap_scalar(d + n, s + n, size - n, width);
+}
@@ -0,0 +1,516 @@
+/*
+ * Buffer compaction through a binary schema, see `flatcc_compact.h`.
+ *
+ * The source is walked with the reflection schema and every object is
+ * built again. Scalars and structs are copied as raw protocol endian
+ * bytes since source and result share the same format, so no values
+ * are decoded except offsets and union types. Deduplication is left to
+ * the builder, and the refmap only preserves tables that the source
+ * already shares, which also avoids walking them more than once.
+ * Nested flatbuffers are compacted as separate buffers with their own
+ * refmap, because references cannot cross buffer boundaries.
+ *
+ * Offsets only point forward, so the walk terminates, but the source
+ * is otherwise untrusted and every access is range checked.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_builder.h"
+#include "flatcc/flatcc_refmap.h"
+#include "flatcc/flatcc_compact.h"
+#include "flatcc/reflection/reflection_reader.h"
+#include "flatcc/reflection/reflection_verifier.h"
+
+#define uoffset_size sizeof(flatbuffers_uoffset_t)
+#define voffset_size sizeof(flatbuffers_voffset_t)
+
+typedef struct compact_context compact_context_t;
+
+struct compact_context {
+    flatcc_builder_t *B;
+    reflection_Object_vec_t objects;
+    reflection_Enum_vec_t enums;
+    const uint8_t *buf;
+    size_t size;
+    flatcc_refmap_t refmap;
+    int level;
+};
+
+typedef struct compact_table compact_table_t;
+
+struct compact_table {
+    const uint8_t *t;
+    const uint8_t *vt;
+    size_t vt_size;
+    size_t t_size;
+};
+
+static flatcc_builder_ref_t copy_table(compact_context_t *ctx,
+        reflection_Object_table_t obj, const uint8_t *t);
+
+/* Returns 0 for types that are not scalars. */
+static size_t scalar_size(reflection_BaseType_enum_t type)
+{
+    switch (type) {
+    case reflection_BaseType_UType:
+    case reflection_BaseType_Bool:
+    case reflection_BaseType_Byte:
+    case reflection_BaseType_UByte:
+        return 1;
+    case reflection_BaseType_Short:
+    case reflection_BaseType_UShort:
+        return 2;
+    case reflection_BaseType_Int:
+    case reflection_BaseType_UInt:
+    case reflection_BaseType_Float:
+        return 4;
+    case reflection_BaseType_Long:
+    case reflection_BaseType_ULong:
+    case reflection_BaseType_Double:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+static reflection_Object_table_t get_object(compact_context_t *ctx,
+        reflection_Type_table_t type)
+{
+    int32_t index = reflection_Type_index(type);
+
+    if (index < 0 || (size_t)index >= reflection_Object_vec_len(ctx->objects)) {
+        return 0;
+    }
+    return reflection_Object_vec_at(ctx->objects, (size_t)index);
+}
+
+/*
+ * Follows the offset stored at `p` which must be in the buffer. Returns
+ * the target, or null if the target cannot hold a length or vtable
+ * offset, or is misaligned.
+ */
+static const uint8_t *follow(compact_context_t *ctx, const uint8_t *p)
+{
+    size_t pos = (size_t)(p - ctx->buf);
+    size_t off;
+
+    if (pos % uoffset_size || ctx->size - pos < uoffset_size) {
+        return 0;
+    }
+    off = (size_t)__flatbuffers_uoffset_read_from_pe(p);
+    if (off == 0 || off % uoffset_size || off > ctx->size - pos - uoffset_size) {
+        return 0;
+    }
+    return p + off;
+}
+
+/* Returns the vector elements and sets `count`, or null if out of range. */
+static const uint8_t *get_vector(compact_context_t *ctx, const uint8_t *p,
+        size_t elem_size, size_t *count)
+{
+    const uint8_t *vec;
+    size_t n;
+
+    if (!(vec = follow(ctx, p))) {
+        return 0;
+    }
+    n = (size_t)__flatbuffers_uoffset_read_from_pe(vec);
+    vec += uoffset_size;
+    if (elem_size && n > (size_t)(ctx->buf + ctx->size - vec) / elem_size) {
+        return 0;
+    }
+    *count = n;
+    return vec;
+}
+
+static int read_table(compact_context_t *ctx, const uint8_t *t, compact_table_t *tab)
+{
+    size_t pos = (size_t)(t - ctx->buf);
+    int64_t vpos;
+
+    vpos = (int64_t)pos - (int64_t)__flatbuffers_soffset_read_from_pe(t);
+    if (vpos < 0 || vpos % voffset_size || (uint64_t)vpos > ctx->size - 2 * voffset_size) {
+        return -1;
+    }
+    tab->t = t;
+    tab->vt = ctx->buf + vpos;
+    tab->vt_size = (size_t)__flatbuffers_voffset_read_from_pe(tab->vt);
+    tab->t_size = (size_t)__flatbuffers_voffset_read_from_pe(tab->vt + voffset_size);
+    if (tab->vt_size < 2 * voffset_size || tab->vt_size % voffset_size ||
+            tab->vt_size > ctx->size - (size_t)vpos) {
+        return -1;
+    }
+    if (tab->t_size < uoffset_size || tab->t_size > ctx->size - pos) {
+        return -1;
+    }
+    return 0;
+}
+
+/* Sets `p` to the field, or null if absent. Returns -1 if the field is out of range. */
+static int get_field(const compact_table_t *tab, size_t id, size_t size, const uint8_t **p)
+{
+    size_t k = voffset_size * (id + 2), off;
+
+    *p = 0;
+    if (k + voffset_size > tab->vt_size) {
+        return 0;
+    }
+    off = (size_t)__flatbuffers_voffset_read_from_pe(tab->vt + k);
+    if (off == 0) {
+        return 0;
+    }
+    if (off < uoffset_size || size > tab->t_size || off > tab->t_size - size) {
+        return -1;
+    }
+    *p = tab->t + off;
+    return 0;
+}
+
+static int add_offset(flatcc_builder_t *B, size_t id, flatcc_builder_ref_t ref)
+{
+    flatcc_builder_ref_t *pref;
+
+    if (!ref || !(pref = flatcc_builder_table_add_offset(B, (int)id))) {
+        return -1;
+    }
+    *pref = ref;
+    return 0;
+}
+
+static int add_raw(flatcc_builder_t *B, size_t id, const uint8_t *p, size_t size, uint16_t align)
+{
+    void *q;
+
+    if (!(q = flatcc_builder_table_add(B, (int)id, size, align))) {
+        return -1;
+    }
+    memcpy(q, p, size);
+    return 0;
+}
+
+static flatcc_builder_ref_t copy_string(compact_context_t *ctx, const uint8_t *p)
+{
+    const uint8_t *s;
+    size_t n;
+
+    if (!(s = get_vector(ctx, p, 1, &n))) {
+        return 0;
+    }
+    if (n >= (size_t)(ctx->buf + ctx->size - s) || s[n] != 0) {
+        return 0;
+    }
+    return flatcc_builder_create_string(ctx->B, (const char *)s, n);
+}
+
+static flatcc_builder_ref_t copy_vector(compact_context_t *ctx,
+        reflection_Type_table_t type, const uint8_t *p)
+{
+    flatcc_builder_t *B = ctx->B;
+    reflection_BaseType_enum_t element = reflection_Type_element(type);
+    reflection_Object_table_t obj = 0;
+    const uint8_t *vec;
+    size_t i, n, elem_size = scalar_size(element);
+    uint16_t align = (uint16_t)elem_size;
+    int is_raw = elem_size != 0;
+    flatcc_builder_ref_t ref;
+
+    if (element == reflection_BaseType_Obj) {
+        if (!(obj = get_object(ctx, type))) {
+            return 0;
+        }
+        if (reflection_Object_is_struct(obj)) {
+            elem_size = (size_t)reflection_Object_bytesize(obj);
+            align = (uint16_t)reflection_Object_minalign(obj);
+            is_raw = 1;
+        }
+    }
+    if (is_raw) {
+        if (!(vec = get_vector(ctx, p, elem_size, &n))) {
+            return 0;
+        }
+        return flatcc_builder_create_vector(B, vec, n, elem_size,
+                align ? align : 1, FLATBUFFERS_COUNT_MAX(elem_size));
+    }
+    if (element != reflection_BaseType_String && element != reflection_BaseType_Obj) {
+        return 0;
+    }
+    if (!(vec = get_vector(ctx, p, uoffset_size, &n)) || flatcc_builder_start_offset_vector(B)) {
+        return 0;
+    }
+    for (i = 0; i < n; ++i, vec += uoffset_size) {
+        if (obj) {
+            ref = copy_table(ctx, obj, follow(ctx, vec));
+        } else {
+            ref = copy_string(ctx, vec);
+        }
+        if (!ref || !flatcc_builder_offset_vector_push(B, ref)) {
+            return 0;
+        }
+    }
+    return flatcc_builder_end_offset_vector(B);
+}
+
+/* The root type of a `nested_flatbuffer` field, or null. */
+static reflection_Object_table_t get_nested_object(compact_context_t *ctx,
+        reflection_Field_table_t field)
+{
+    reflection_KeyValue_vec_t attributes = reflection_Field_attributes(field);
+    reflection_KeyValue_table_t kv;
+    flatbuffers_string_t name;
+    size_t i, k, n = reflection_KeyValue_vec_len(attributes);
+
+    for (i = 0; i < n; ++i) {
+        kv = reflection_KeyValue_vec_at(attributes, i);
+        if (strcmp(reflection_KeyValue_key(kv), "nested_flatbuffer")) {
+            continue;
+        }
+        if (!(name = reflection_KeyValue_value(kv))) {
+            return 0;
+        }
+        k = reflection_Object_vec_find(ctx->objects, name);
+        return k == flatbuffers_not_found ? 0 : reflection_Object_vec_at(ctx->objects, k);
+    }
+    return 0;
+}
+
+/*
+ * Builds the nested buffer again, keeping its identifier. The builder
+ * aligns it to its content, like the buffer it was built as.
+ */
+static flatcc_builder_ref_t copy_nested(compact_context_t *ctx,
+        reflection_Object_table_t obj, const uint8_t *p)
+{
+    compact_context_t nested = *ctx;
+    flatcc_builder_ref_t ref = 0;
+    const uint8_t *root;
+    size_t size;
+
+    if (!(nested.buf = get_vector(ctx, p, 1, &nested.size)) ||
+            nested.size < uoffset_size + FLATBUFFERS_IDENTIFIER_SIZE) {
+        return 0;
+    }
+    if (flatcc_builder_start_buffer(ctx->B, (const char *)nested.buf + uoffset_size, 0)) {
+        return 0;
+    }
+    flatcc_refmap_init(&nested.refmap);
+    root = follow(&nested, nested.buf);
+    if (reflection_Object_is_struct(obj)) {
+        size = (size_t)reflection_Object_bytesize(obj);
+        if (root && size <= (size_t)(nested.buf + nested.size - root)) {
+            ref = flatcc_builder_create_struct(ctx->B, root, size, (uint16_t)reflection_Object_minalign(obj));
+        }
+    } else {
+        ref = copy_table(&nested, obj, root);
+    }
+    flatcc_refmap_clear(&nested.refmap);
+    return ref ? flatcc_builder_end_buffer(ctx->B, ref) : 0;
+}
+
+/*
+ * The type is stored in the field before the value. A value whose type
+ * is not in the schema cannot be copied and is dropped with its type,
+ * like generated clones do.
+ */
+static int copy_union(compact_context_t *ctx, const compact_table_t *tab,
+        reflection_Type_table_t type, size_t id)
+{
+    reflection_EnumVal_vec_t values;
+    reflection_EnumVal_table_t ev;
+    reflection_Object_table_t obj = 0;
+    const uint8_t *tp, *p;
+    int32_t index = reflection_Type_index(type);
+    size_t i, n;
+
+    if (id == 0 || index < 0 || (size_t)index >= reflection_Enum_vec_len(ctx->enums)) {
+        return -1;
+    }
+    if (get_field(tab, id - 1, 1, &tp) || get_field(tab, id, uoffset_size, &p)) {
+        return -1;
+    }
+    if (!tp) {
+        return 0;
+    }
+    if (*tp == 0) {
+        return add_raw(ctx->B, id - 1, tp, 1, 1);
+    }
+    values = reflection_Enum_values(reflection_Enum_vec_at(ctx->enums, (size_t)index));
+    n = reflection_EnumVal_vec_len(values);
+    for (i = 0; i < n; ++i) {
+        ev = reflection_EnumVal_vec_at(values, i);
+        if (reflection_EnumVal_value(ev) == (int64_t)*tp) {
+            obj = reflection_EnumVal_object(ev);
+            break;
+        }
+    }
+    if (!obj || !p) {
+        return 0;
+    }
+    if (add_offset(ctx->B, id, copy_table(ctx, obj, follow(ctx, p)))) {
+        return -1;
+    }
+    return add_raw(ctx->B, id - 1, tp, 1, 1);
+}
+
+static int copy_field(compact_context_t *ctx, const compact_table_t *tab,
+        reflection_Field_table_t field)
+{
+    flatcc_builder_t *B = ctx->B;
+    reflection_Type_table_t type = reflection_Field_type(field);
+    reflection_BaseType_enum_t base_type = reflection_Type_base_type(type);
+    reflection_Object_table_t obj;
+    size_t id = reflection_Field_id(field), size;
+    const uint8_t *p;
+
+    if (reflection_Field_deprecated(field)) {
+        return 0;
+    }
+    switch (base_type) {
+    case reflection_BaseType_UType:
+        /* Copied with the union value. */
+        return 0;
+    case reflection_BaseType_Union:
+        return copy_union(ctx, tab, type, id);
+    case reflection_BaseType_String:
+    case reflection_BaseType_Vector:
+        if (get_field(tab, id, uoffset_size, &p)) {
+            return -1;
+        }
+        if (!p) {
+            return 0;
+        }
+        if (base_type == reflection_BaseType_String) {
+            return add_offset(B, id, copy_string(ctx, p));
+        }
+        if ((obj = get_nested_object(ctx, field))) {
+            return add_offset(B, id, copy_nested(ctx, obj, p));
+        }
+        return add_offset(B, id, copy_vector(ctx, type, p));
+    case reflection_BaseType_Obj:
+        if (!(obj = get_object(ctx, type))) {
+            return -1;
+        }
+        if (reflection_Object_is_struct(obj)) {
+            size = (size_t)reflection_Object_bytesize(obj);
+            if (get_field(tab, id, size, &p)) {
+                return -1;
+            }
+            return p ? add_raw(B, id, p, size, (uint16_t)reflection_Object_minalign(obj)) : 0;
+        }
+        if (get_field(tab, id, uoffset_size, &p)) {
+            return -1;
+        }
+        return p ? add_offset(B, id, copy_table(ctx, obj, follow(ctx, p))) : 0;
+    default:
+        if (!(size = scalar_size(base_type))) {
+            return -1;
+        }
+        if (get_field(tab, id, size, &p)) {
+            return -1;
+        }
+        return p ? add_raw(B, id, p, size, (uint16_t)size) : 0;
+    }
+}
+
+static flatcc_builder_ref_t copy_table(compact_context_t *ctx,
+        reflection_Object_table_t obj, const uint8_t *t)
+{
+    reflection_Field_vec_t fields;
+    compact_table_t tab;
+    flatcc_builder_ref_t ref;
+    size_t i, n, count = 0;
+
+    if (!t) {
+        return 0;
+    }
+    if ((ref = flatcc_refmap_find(&ctx->refmap, t))) {
+        return ref;
+    }
+    if (ctx->level >= FLATCC_COMPACT_MAX_LEVELS || read_table(ctx, t, &tab)) {
+        return 0;
+    }
+    fields = reflection_Object_fields(obj);
+    n = reflection_Field_vec_len(fields);
+    for (i = 0; i < n; ++i) {
+        if ((size_t)reflection_Field_id(reflection_Field_vec_at(fields, i)) >= count) {
+            count = (size_t)reflection_Field_id(reflection_Field_vec_at(fields, i)) + 1;
+        }
+    }
+    ++ctx->level;
+    if (flatcc_builder_start_table(ctx->B, (int)count)) {
+        return 0;
+    }
+    for (i = 0; i < n; ++i) {
+        if (copy_field(ctx, &tab, reflection_Field_vec_at(fields, i))) {
+            return 0;
+        }
+    }
+    --ctx->level;
+    if (!(ref = flatcc_builder_end_table(ctx->B))) {
+        return 0;
+    }
+    return flatcc_refmap_insert(&ctx->refmap, t, ref);
+}
+
+int flatcc_compact_buffer(flatcc_builder_t *B,
+        const void *bfbs, size_t bfbs_size,
+        const void *buffer, size_t size)
+{
+    compact_context_t ctx;
+    reflection_Schema_table_t schema;
+    reflection_Object_table_t root;
+    flatbuffers_string_t ident;
+    flatcc_builder_ref_t ref = 0;
+    int vt_clustering, intern_strings, dedup_objects;
+    size_t vb_flush_limit, sb_flush_limit;
+    char fid[FLATBUFFERS_IDENTIFIER_SIZE] = { 0 };
+
+    if (reflection_Schema_verify_as_root(bfbs, bfbs_size)) {
+        return -1;
+    }
+    schema = reflection_Schema_as_root(bfbs);
+    if (!(root = reflection_Schema_root_table(schema))) {
+        return -1;
+    }
+    if (!buffer || size < uoffset_size + FLATBUFFERS_IDENTIFIER_SIZE ||
+            (size_t)(uintptr_t)buffer % uoffset_size) {
+        return -1;
+    }
+    ident = reflection_Schema_file_ident(schema);
+    if (ident && flatbuffers_string_len(ident) == FLATBUFFERS_IDENTIFIER_SIZE) {
+        memcpy(fid, ident, FLATBUFFERS_IDENTIFIER_SIZE);
+    }
+    ctx.B = B;
+    ctx.objects = reflection_Schema_objects(schema);
+    ctx.enums = reflection_Schema_enums(schema);
+    ctx.buf = buffer;
+    ctx.size = size;
+    ctx.level = 0;
+    flatcc_refmap_init(&ctx.refmap);
+
+    vt_clustering = !B->disable_vt_clustering;
+    intern_strings = B->intern_strings;
+    dedup_objects = B->dedup_objects;
+    vb_flush_limit = B->vb_flush_limit;
+    sb_flush_limit = B->sb_flush_limit;
+    flatcc_builder_set_vtable_clustering(B, 1);
+    flatcc_builder_set_string_interning(B, 1);
+    flatcc_builder_set_object_dedup(B, 1);
+    flatcc_builder_set_vtable_cache_limit(B, 0);
+    flatcc_builder_set_string_cache_limit(B, 0);
+
+    if (!flatcc_builder_start_buffer(B, fid, 0)) {
+        ref = copy_table(&ctx, root, follow(&ctx, ctx.buf));
+        ref = ref ? flatcc_builder_end_buffer(B, ref) : 0;
+    }
+
+    flatcc_builder_set_vtable_clustering(B, vt_clustering);
+    flatcc_builder_set_string_interning(B, intern_strings);
+    flatcc_builder_set_object_dedup(B, dedup_objects);
+    flatcc_builder_set_vtable_cache_limit(B, vb_flush_limit);
+    flatcc_builder_set_string_cache_limit(B, sb_flush_limit);
+    flatcc_refmap_clear(&ctx.refmap);
+    return ref ? 0 : -1;
+}
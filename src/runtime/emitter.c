@@ -3,19 +3,398 @@
 #include "flatcc/flatcc_rtconfig.h"
 #include "flatcc/flatcc_emitter.h"
 
+/*
+ * Shared page pools need C11 atomics. gcc 4.7 and 4.8 accept -std=c11
+ * but do not provide <stdatomic.h>.
+ */
+#ifndef FLATCC_EMITTER_HAVE_POOL
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__) &&\
+        !(defined(__GNUC__) && !defined(__clang__) && (__GNUC__ * 100 + __GNUC_MINOR__) < 409)
+#define FLATCC_EMITTER_HAVE_POOL 1
+#else
+#define FLATCC_EMITTER_HAVE_POOL 0
+#endif
+#endif
+
+#if FLATCC_EMITTER_HAVE_POOL
+#include <stdatomic.h>
+#endif
+
+/* Page sizes are kept at a multiple of 2 * FLATCC_EMITTER_PAGE_MULTIPLE. */
+#define page_size_multiple (2 * FLATCC_EMITTER_PAGE_MULTIPLE)
+#define page_size_roundup(n) (((n) + page_size_multiple - 1) & ~(size_t)(page_size_multiple - 1))
+
+/* Page content starts after the header, aligned to the page multiple. */
+#define page_header_size ((sizeof(flatcc_emitter_page_t) + FLATCC_EMITTER_PAGE_MULTIPLE - 1) &\
+        ~(size_t)(FLATCC_EMITTER_PAGE_MULTIPLE - 1))
+
+static inline flatcc_emitter_page_t *new_page(size_t size)
+{
+    flatcc_emitter_page_t *p;
+
+    if (!(p = FLATCC_EMITTER_ALLOC(page_header_size + size))) {
+        return 0;
+    }
+    p->page = (uint8_t *)p + page_header_size;
+    p->page_size = size;
+    return p;
+}
+
+#if FLATCC_EMITTER_HAVE_POOL
+
+/*
+ * The freelist is a fixed array of slots, each holding either null or
+ * a batch of pages linked through the page `next` field. A batch is
+ * added by a compare and swap of an empty slot, and removed by an
+ * atomic exchange of a slot with null. Neither operation can suffer
+ * from the ABA problem of a linked stack, and no tagged pointers or
+ * double width atomics are needed. When all slots are taken, returned
+ * pages are deallocated.
+ */
+#ifndef FLATCC_EMITTER_POOL_SLOTS
+#define FLATCC_EMITTER_POOL_SLOTS 64
+#endif
+
+struct flatcc_emitter_pool {
+    _Atomic(flatcc_emitter_page_t *) slots[FLATCC_EMITTER_POOL_SLOTS];
+    /* Where to start scanning, only a hint to spread contention. */
+    atomic_uint hint;
+    atomic_size_t pages_allocated;
+    atomic_size_t pages_cached;
+    size_t page_size;
+    size_t max_cached;
+};
+
+/* Zero initialized which is a valid pool with default settings. */
+static flatcc_emitter_pool_t global_pool;
+
+static inline size_t pool_page_size(flatcc_emitter_pool_t *pool)
+{
+    return pool->page_size ? pool->page_size : FLATCC_EMITTER_PAGE_SIZE;
+}
+
+static void free_chain(flatcc_emitter_page_t *p)
+{
+    flatcc_emitter_page_t *next;
+
+    while (p) {
+        next = p->next;
+        free(p);
+        p = next;
+    }
+}
+
+/*
+ * Returns 0 if the batch was placed in a slot. The pages are counted
+ * before the batch is published, so a concurrent pop cannot subtract
+ * them first.
+ */
+static int pool_push_batch(flatcc_emitter_pool_t *pool, flatcc_emitter_page_t *batch, size_t count)
+{
+    unsigned int i, k = atomic_load_explicit(&pool->hint, memory_order_relaxed);
+    flatcc_emitter_page_t *empty;
+    size_t cached = atomic_fetch_add(&pool->pages_cached, count);
+
+    if (pool->max_cached && cached + count > pool->max_cached) {
+        atomic_fetch_sub(&pool->pages_cached, count);
+        return -1;
+    }
+    for (i = 0; i < FLATCC_EMITTER_POOL_SLOTS; ++i, ++k) {
+        k %= FLATCC_EMITTER_POOL_SLOTS;
+        empty = 0;
+        if (atomic_load_explicit(&pool->slots[k], memory_order_relaxed) == 0 &&
+                atomic_compare_exchange_strong(&pool->slots[k], &empty, batch)) {
+            atomic_store_explicit(&pool->hint, k, memory_order_relaxed);
+            return 0;
+        }
+    }
+    atomic_fetch_sub(&pool->pages_cached, count);
+    return -1;
+}
+
+static flatcc_emitter_page_t *pool_pop_batch(flatcc_emitter_pool_t *pool, size_t *count)
+{
+    unsigned int i, k = atomic_load_explicit(&pool->hint, memory_order_relaxed);
+    flatcc_emitter_page_t *batch, *p;
+    size_t n;
+
+    for (i = 0; i < FLATCC_EMITTER_POOL_SLOTS; ++i, ++k) {
+        k %= FLATCC_EMITTER_POOL_SLOTS;
+        if (atomic_load_explicit(&pool->slots[k], memory_order_relaxed) == 0) {
+            continue;
+        }
+        if ((batch = atomic_exchange(&pool->slots[k], (flatcc_emitter_page_t *)0))) {
+            for (n = 0, p = batch; p; p = p->next) {
+                ++n;
+            }
+            atomic_fetch_sub(&pool->pages_cached, n);
+            *count = n;
+            return batch;
+        }
+    }
+    return 0;
+}
+
+/* Moves up to `count` pages from the local cache to the pool. */
+static void pool_return_cache(flatcc_emitter_t *E, size_t count)
+{
+    flatcc_emitter_pool_t *pool = E->pool;
+    flatcc_emitter_page_t *batch, *last;
+    size_t n;
+
+    if (count == 0 || !E->pool_cache) {
+        return;
+    }
+    batch = last = E->pool_cache;
+    for (n = 1; n < count && last->next; ++n) {
+        last = last->next;
+    }
+    E->pool_cache = last->next;
+    E->pool_cache_count -= n;
+    last->next = 0;
+    if (pool_push_batch(pool, batch, n)) {
+        free_chain(batch);
+        atomic_fetch_sub(&pool->pages_allocated, n);
+    }
+}
+
+static flatcc_emitter_page_t *pool_alloc_page(flatcc_emitter_t *E)
+{
+    flatcc_emitter_pool_t *pool = E->pool;
+    flatcc_emitter_page_t *p;
+
+    if (!E->pool_cache) {
+        E->pool_cache = pool_pop_batch(pool, &E->pool_cache_count);
+    }
+    if ((p = E->pool_cache)) {
+        E->pool_cache = p->next;
+        --E->pool_cache_count;
+#if FLATCC_BUILDER_STATS
+        ++E->page_reuse_count;
+#endif
+        return p;
+    }
+    if ((p = new_page(pool_page_size(pool)))) {
+        atomic_fetch_add(&pool->pages_allocated, 1);
+#if FLATCC_BUILDER_STATS
+        ++E->page_alloc_count;
+#endif
+    }
+    return p;
+}
+
+static void pool_release_page(flatcc_emitter_t *E, flatcc_emitter_page_t *p)
+{
+    p->next = E->pool_cache;
+    E->pool_cache = p;
+    if (++E->pool_cache_count > 2 * FLATCC_EMITTER_POOL_BATCH) {
+        pool_return_cache(E, FLATCC_EMITTER_POOL_BATCH);
+    }
+}
+
+flatcc_emitter_pool_t *flatcc_emitter_pool_create(size_t page_size, size_t max_cached)
+{
+    flatcc_emitter_pool_t *pool;
+    int i;
+
+    if (!(pool = malloc(sizeof(*pool)))) {
+        return 0;
+    }
+    for (i = 0; i < FLATCC_EMITTER_POOL_SLOTS; ++i) {
+        atomic_init(&pool->slots[i], (flatcc_emitter_page_t *)0);
+    }
+    atomic_init(&pool->hint, 0);
+    atomic_init(&pool->pages_allocated, 0);
+    atomic_init(&pool->pages_cached, 0);
+    pool->page_size = page_size ? page_size_roundup(page_size) : 0;
+    pool->max_cached = max_cached;
+    return pool;
+}
+
+void flatcc_emitter_pool_trim(flatcc_emitter_pool_t *pool, size_t keep)
+{
+    flatcc_emitter_page_t *batch;
+    size_t n;
+
+    while (atomic_load(&pool->pages_cached) > keep) {
+        if (!(batch = pool_pop_batch(pool, &n))) {
+            return;
+        }
+        free_chain(batch);
+        atomic_fetch_sub(&pool->pages_allocated, n);
+    }
+}
+
+void flatcc_emitter_pool_destroy(flatcc_emitter_pool_t *pool)
+{
+    if (!pool) {
+        return;
+    }
+    flatcc_emitter_pool_trim(pool, 0);
+    if (pool != &global_pool) {
+        free(pool);
+    }
+}
+
+flatcc_emitter_pool_t *flatcc_emitter_get_global_pool(void)
+{
+    return &global_pool;
+}
+
+void flatcc_emitter_pool_get_stats(flatcc_emitter_pool_t *pool, flatcc_emitter_pool_stats_t *stats)
+{
+    size_t allocated = atomic_load(&pool->pages_allocated);
+    size_t cached = atomic_load(&pool->pages_cached);
+
+    stats->page_size = pool_page_size(pool);
+    stats->pages_cached = cached;
+    stats->pages_in_use = allocated > cached ? allocated - cached : 0;
+}
+
+int flatcc_emitter_set_pool(flatcc_emitter_t *E, flatcc_emitter_pool_t *pool)
+{
+    if (E->front || E->pool_cache) {
+        return -1;
+    }
+    E->pool = pool;
+    return 0;
+}
+
+#else
+
+/* Minimal stubs so emitters work without pool support. */
+
+static inline flatcc_emitter_page_t *pool_alloc_page(flatcc_emitter_t *E)
+{
+    (void)E;
+    return 0;
+}
+
+static inline void pool_release_page(flatcc_emitter_t *E, flatcc_emitter_page_t *p)
+{
+    (void)E;
+    free(p);
+}
+
+static inline void pool_return_cache(flatcc_emitter_t *E, size_t count)
+{
+    (void)E;
+    (void)count;
+}
+
+flatcc_emitter_pool_t *flatcc_emitter_pool_create(size_t page_size, size_t max_cached)
+{
+    (void)page_size;
+    (void)max_cached;
+    return 0;
+}
+
+void flatcc_emitter_pool_destroy(flatcc_emitter_pool_t *pool)
+{
+    (void)pool;
+}
+
+flatcc_emitter_pool_t *flatcc_emitter_get_global_pool(void)
+{
+    return 0;
+}
+
+void flatcc_emitter_pool_trim(flatcc_emitter_pool_t *pool, size_t keep)
+{
+    (void)pool;
+    (void)keep;
+}
+
+void flatcc_emitter_pool_get_stats(flatcc_emitter_pool_t *pool, flatcc_emitter_pool_stats_t *stats)
+{
+    (void)pool;
+    memset(stats, 0, sizeof(*stats));
+}
+
+int flatcc_emitter_set_pool(flatcc_emitter_t *E, flatcc_emitter_pool_t *pool)
+{
+    if (pool == 0) {
+        E->pool = 0;
+        return 0;
+    }
+    return -1;
+}
+
+#endif /* FLATCC_EMITTER_HAVE_POOL */
+
+static inline void release_page(flatcc_emitter_t *E, flatcc_emitter_page_t *p)
+{
+    if (E->pool) {
+        pool_release_page(E, p);
+    } else {
+        free(p);
+    }
+}
+
+static flatcc_emitter_page_t *alloc_page(flatcc_emitter_t *E)
+{
+    flatcc_emitter_page_t *p;
+    size_t size;
+
+    if (E->pool) {
+        if (!(p = pool_alloc_page(E))) {
+            return 0;
+        }
+        E->capacity += p->page_size;
+        return p;
+    }
+    size = E->page_size ? E->page_size : FLATCC_EMITTER_PAGE_SIZE;
+    /*
+     * In adaptive mode each additional page doubles the capacity so
+     * large buffers only need a few pages.
+     */
+    if (E->max_page_size && E->front) {
+        if (size < E->capacity) {
+            size = E->capacity;
+        }
+        if (size > E->max_page_size) {
+            size = E->max_page_size;
+        }
+    }
+    if (!(p = new_page(size))) {
+        return 0;
+    }
+#if FLATCC_BUILDER_STATS
+    ++E->page_alloc_count;
+#endif
+    E->capacity += size;
+    return p;
+}
+
+/*
+ * The first page is shared between front and back to avoid
+ * double unecessary extra allocation.
+ */
+static void init_first_page(flatcc_emitter_t *E, flatcc_emitter_page_t *p)
+{
+    E->front = p;
+    E->back = p;
+    E->front_cursor = p->page + p->page_size / 2;
+    E->back_cursor = E->front_cursor;
+    E->front_left = p->page_size / 2;
+    E->back_left = p->page_size - E->front_left;
+    p->page_offset = -(flatbuffers_soffset_t)E->front_left;
+}
+
 static int advance_front(flatcc_emitter_t *E)
 {
     flatcc_emitter_page_t *p = 0;
 
     if (E->front && E->front->prev != E->back) {
-        E->front->prev->page_offset = E->front->page_offset - FLATCC_EMITTER_PAGE_SIZE;
+#if FLATCC_BUILDER_STATS
+        ++E->page_reuse_count;
+#endif
         E->front = E->front->prev;
         goto done;
     }
-    if (!(p = FLATCC_EMITTER_ALLOC(sizeof(flatcc_emitter_page_t)))) {
+    if (!(p = alloc_page(E))) {
         return -1;
     }
-    E->capacity += FLATCC_EMITTER_PAGE_SIZE;
     if (E->front) {
         p->prev = E->back;
         p->next = E->front;
@@ -24,24 +403,14 @@ static int advance_front(flatcc_emitter_t *E)
         E->front = p;
         goto done;
     }
-    /*
-     * The first page is shared between front and back to avoid
-     * double unecessary extra allocation.
-     */
-    E->front = p;
-    E->back = p;
     p->next = p;
     p->prev = p;
-    E->front_cursor = E->front->page + FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->back_cursor = E->front_cursor;
-    E->front_left = FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->back_left = FLATCC_EMITTER_PAGE_SIZE - E->front_left;
-    p->page_offset = -(flatbuffers_soffset_t)E->front_left;
+    init_first_page(E, p);
     return 0;
 done:
-    E->front_cursor = E->front->page + FLATCC_EMITTER_PAGE_SIZE;
-    E->front_left = FLATCC_EMITTER_PAGE_SIZE;
-    E->front->page_offset = E->front->next->page_offset - FLATCC_EMITTER_PAGE_SIZE;
+    E->front_cursor = E->front->page + E->front->page_size;
+    E->front_left = E->front->page_size;
+    E->front->page_offset = E->front->next->page_offset - (flatbuffers_soffset_t)E->front->page_size;
     return 0;
 }
 
@@ -50,13 +419,15 @@ static int advance_back(flatcc_emitter_t *E)
     flatcc_emitter_page_t *p = 0;
 
     if (E->back && E->back->next != E->front) {
+#if FLATCC_BUILDER_STATS
+        ++E->page_reuse_count;
+#endif
         E->back = E->back->next;
         goto done;
     }
-    if (!(p = FLATCC_EMITTER_ALLOC(sizeof(flatcc_emitter_page_t)))) {
+    if (!(p = alloc_page(E))) {
         return -1;
     }
-    E->capacity += FLATCC_EMITTER_PAGE_SIZE;
     if (E->back) {
         p->prev = E->back;
         p->next = E->front;
@@ -65,24 +436,14 @@ static int advance_back(flatcc_emitter_t *E)
         E->back = p;
         goto done;
     }
-    /*
-     * The first page is shared between front and back to avoid
-     * double unecessary extra allocation.
-     */
-    E->front = p;
-    E->back = p;
     p->next = p;
     p->prev = p;
-    E->front_cursor = E->front->page + FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->back_cursor = E->front_cursor;
-    E->front_left = FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->back_left = FLATCC_EMITTER_PAGE_SIZE - E->front_left;
-    p->page_offset = -(flatbuffers_soffset_t)E->front_left;
+    init_first_page(E, p);
     return 0;
 done:
     E->back_cursor = E->back->page;
-    E->back_left = FLATCC_EMITTER_PAGE_SIZE;
-    E->back->page_offset = E->back->prev->page_offset + FLATCC_EMITTER_PAGE_SIZE;
+    E->back_left = E->back->page_size;
+    E->back->page_offset = E->back->prev->page_offset + (flatbuffers_soffset_t)E->back->prev->page_size;
     return 0;
 }
 
@@ -149,49 +510,172 @@ int flatcc_emitter_recycle_page(flatcc_emitter_t *E, flatcc_emitter_page_t *p)
     return 0;
 }
 
+int flatcc_emitter_rewind(flatcc_emitter_t *E, flatbuffers_soffset_t start, flatbuffers_soffset_t end)
+{
+    flatcc_emitter_page_t *p;
+    flatbuffers_soffset_t cur_start, cur_end;
+
+    if (!E->front) {
+        return start == 0 && end == 0 ? 0 : -1;
+    }
+    cur_start = E->front->page_offset + (flatbuffers_soffset_t)(E->front_cursor - E->front->page);
+    cur_end = E->back->page_offset + (flatbuffers_soffset_t)(E->back_cursor - E->back->page);
+    if (start < cur_start || start > 0 || end > cur_end || end < 0) {
+        return -1;
+    }
+    /*
+     * The first page holds address 0, so neither walk can pass it.
+     * Pages left behind are between back and front and are reused by
+     * the advance functions.
+     */
+    p = E->front;
+    while (start >= p->page_offset + (flatbuffers_soffset_t)p->page_size) {
+        p = p->next;
+    }
+    E->front = p;
+    E->front_left = (size_t)(start - p->page_offset);
+    E->front_cursor = p->page + E->front_left;
+    p = E->back;
+    while (end < p->page_offset) {
+        p = p->prev;
+    }
+    E->back = p;
+    E->back_cursor = p->page + (end - p->page_offset);
+    E->back_left = p->page_size - (size_t)(end - p->page_offset);
+    E->used = (size_t)(end - start);
+    return 0;
+}
+
+static void free_pages(flatcc_emitter_t *E)
+{
+    flatcc_emitter_page_t *p = E->front;
+
+    if (!p) {
+        return;
+    }
+    p->prev->next = 0;
+    while (p->next) {
+        p = p->next;
+        release_page(E, p->prev);
+    }
+    release_page(E, p);
+    E->front = 0;
+    E->back = 0;
+    E->capacity = 0;
+}
+
+void flatcc_emitter_set_page_size(flatcc_emitter_t *E, size_t page_size)
+{
+    E->page_size = page_size ? page_size_roundup(page_size) : 0;
+    E->min_page_size = 0;
+    E->max_page_size = 0;
+}
+
+void flatcc_emitter_set_adaptive_page_size(flatcc_emitter_t *E,
+        size_t min_page_size, size_t max_page_size)
+{
+    min_page_size = min_page_size ? min_page_size : FLATCC_EMITTER_PAGE_SIZE;
+    max_page_size = max_page_size ? max_page_size : FLATCC_EMITTER_ADAPTIVE_MAX_PAGE_SIZE;
+    E->min_page_size = page_size_roundup(min_page_size);
+    E->max_page_size = page_size_roundup(max_page_size);
+    if (E->max_page_size < E->min_page_size) {
+        E->max_page_size = E->min_page_size;
+    }
+    if (E->page_size < E->min_page_size) {
+        E->page_size = E->min_page_size;
+    }
+    if (E->page_size > E->max_page_size) {
+        E->page_size = E->max_page_size;
+    }
+}
+
 void flatcc_emitter_reset(flatcc_emitter_t *E)
 {
     flatcc_emitter_page_t *p = E->front;
+    size_t size;
 
     if (!E->front) {
         return;
     }
-    E->back = E->front;
-    E->front_cursor = E->front->page + FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->back_cursor = E->front_cursor;
-    E->front_left = FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->back_left = FLATCC_EMITTER_PAGE_SIZE - FLATCC_EMITTER_PAGE_SIZE / 2;
-    E->front->page_offset = -(flatbuffers_soffset_t)E->front_left;
     /* Heuristic to reduce peak allocation over time. */
     if (E->used_average == 0) {
         E->used_average = E->used;
     }
     E->used_average = E->used_average * 3 / 4 + E->used / 4;
     E->used = 0;
+    if (E->max_page_size) {
+        /*
+         * Size the first page so an average buffer fits in the front
+         * half. Only replace the pages when the size is off by more
+         * than a factor 2 to avoid churn.
+         */
+        size = page_size_roundup(E->used_average * 2);
+        if (size < E->min_page_size) {
+            size = E->min_page_size;
+        }
+        if (size > E->max_page_size) {
+            size = E->max_page_size;
+        }
+        E->page_size = size;
+        if (size > 2 * E->front->page_size || 2 * size < E->front->page_size) {
+            free_pages(E);
+            E->front_cursor = 0;
+            E->back_cursor = 0;
+            E->front_left = 0;
+            E->back_left = 0;
+            return;
+        }
+    }
+#if FLATCC_BUILDER_STATS
+    ++E->page_reuse_count;
+#endif
+    init_first_page(E, E->front);
     while (E->used_average * 2 < E->capacity && E->back->next != E->front) {
         /* We deallocate the page after back since it is less likely to be hot in cache. */
         p = E->back->next;
         E->back->next = p->next;
         p->next->prev = E->back;
-        free(p);
-        E->capacity -= FLATCC_EMITTER_PAGE_SIZE;
+        E->capacity -= p->page_size;
+        release_page(E, p);
     }
 }
 
-void flatcc_emitter_clear(flatcc_emitter_t *E)
+int flatcc_emitter_reserve(flatcc_emitter_t *E, size_t size)
 {
-    flatcc_emitter_page_t *p = E->front;
+    flatcc_emitter_page_t *p;
+    size_t page_size = page_size_roundup(2 * size);
 
-    if (!p) {
-        return;
+    if (E->used || E->pool || (E->front && E->front->page_size >= page_size)) {
+        return 0;
     }
-    p->prev->next = 0;
-    while (p->next) {
-        p = p->next;
-        free(p->prev);
+    free_pages(E);
+    if (!(p = new_page(page_size))) {
+        return -1;
     }
-    free(p);
+#if FLATCC_BUILDER_STATS
+    ++E->page_alloc_count;
+#endif
+    E->capacity = page_size;
+    p->next = p;
+    p->prev = p;
+    init_first_page(E, p);
+    return 0;
+}
+
+void flatcc_emitter_clear(flatcc_emitter_t *E)
+{
+    size_t page_size = E->page_size;
+    size_t min_page_size = E->min_page_size;
+    size_t max_page_size = E->max_page_size;
+    flatcc_emitter_pool_t *pool = E->pool;
+
+    free_pages(E);
+    pool_return_cache(E, E->pool_cache_count);
     memset(E, 0, sizeof(*E));
+    E->page_size = page_size;
+    E->min_page_size = min_page_size;
+    E->max_page_size = max_page_size;
+    E->pool = pool;
 }
 
 int flatcc_emitter(void *emit_context,
@@ -240,6 +724,57 @@ copy:
     return 0;
 }
 
+int flatcc_emitter_get_buffer_iov(flatcc_emitter_t *E, flatcc_iovec_t *iov, int iov_max)
+{
+    flatcc_emitter_page_t *p;
+    int count;
+    size_t len;
+
+    if (!E->front || E->used == 0) {
+        return 0;
+    }
+    if (E->front == E->back) {
+        if (iov) {
+            if (iov_max < 1) {
+                return -1;
+            }
+            iov[0].iov_base = E->front_cursor;
+            iov[0].iov_len = E->used;
+        }
+        return 1;
+    }
+    count = 2;
+    for (p = E->front->next; p != E->back; p = p->next) {
+        ++count;
+    }
+    if (!iov) {
+        return count;
+    }
+    if (iov_max < count) {
+        return -1;
+    }
+    count = 0;
+    /* End pages are not expected to be empty, but do not emit empty entries. */
+    len = E->front->page_size - E->front_left;
+    if (len) {
+        iov[count].iov_base = E->front_cursor;
+        iov[count].iov_len = len;
+        ++count;
+    }
+    for (p = E->front->next; p != E->back; p = p->next) {
+        iov[count].iov_base = p->page;
+        iov[count].iov_len = p->page_size;
+        ++count;
+    }
+    len = p->page_size - E->back_left;
+    if (len) {
+        iov[count].iov_base = p->page;
+        iov[count].iov_len = len;
+        ++count;
+    }
+    return count;
+}
+
 void *flatcc_emitter_copy_buffer(flatcc_emitter_t *E, void *buf, size_t size)
 {
     flatcc_emitter_page_t *p;
@@ -255,15 +790,15 @@ void *flatcc_emitter_copy_buffer(flatcc_emitter_t *E, void *buf, size_t size)
         memcpy(buf, E->front_cursor, E->used);
         return buf;
     }
-    len = FLATCC_EMITTER_PAGE_SIZE - E->front_left;
+    len = E->front->page_size - E->front_left;
     memcpy(buf, E->front_cursor, len);
     buf = (uint8_t *)buf + len;
     p = E->front->next;
     while (p != E->back) {
-        memcpy(buf, p->page, FLATCC_EMITTER_PAGE_SIZE);
-        buf = (uint8_t *)buf + FLATCC_EMITTER_PAGE_SIZE;
+        memcpy(buf, p->page, p->page_size);
+        buf = (uint8_t *)buf + p->page_size;
         p = p->next;
     }
-    memcpy(buf, p->page, FLATCC_EMITTER_PAGE_SIZE - E->back_left);
+    memcpy(buf, p->page, p->page_size - E->back_left);
     return buf;
 }
@@ -0,0 +1,199 @@
+/*
+ * Streaming file descriptor emitter, see `flatcc_fd_emitter.h`.
+ *
+ * Requires POSIX `pwrite`.
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_fd_emitter.h"
+
+static int write_at(flatcc_fd_emitter_t *E, const uint8_t *data, size_t size, flatbuffers_soffset_t offset)
+{
+    off_t pos = E->origin + (off_t)offset;
+    ssize_t n;
+
+    if (pos < 0) {
+        /* The front of the buffer grew beyond the reserved origin. */
+        return -1;
+    }
+    while (size) {
+        n = pwrite(E->fd, data, size, pos);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        size -= (size_t)n;
+        pos += n;
+    }
+    return 0;
+}
+
+static int alloc_pages(flatcc_fd_emitter_t *E)
+{
+    if (!(E->front_page = malloc(2 * E->page_size))) {
+        return -1;
+    }
+    E->back_page = E->front_page + E->page_size;
+    E->front_left = E->page_size;
+    return 0;
+}
+
+static inline int flush_front(flatcc_fd_emitter_t *E)
+{
+    size_t len = E->page_size - E->front_left;
+
+    if (len == 0) {
+        return 0;
+    }
+    E->front_base -= (flatbuffers_soffset_t)len;
+    E->front_left = E->page_size;
+    return write_at(E, E->front_page + E->page_size - len, len, E->front_base);
+}
+
+static inline int flush_back(flatcc_fd_emitter_t *E)
+{
+    size_t len = E->back_used;
+
+    if (len == 0) {
+        return 0;
+    }
+    E->back_used = 0;
+    E->back_base += (flatbuffers_soffset_t)len;
+    return write_at(E, E->back_page, len, E->back_base - (flatbuffers_soffset_t)len);
+}
+
+static int copy_front(flatcc_fd_emitter_t *E, const uint8_t *data, size_t size)
+{
+    size_t k;
+
+    /* Large blocks bypass the staging page when it is empty. */
+    if (size >= E->page_size && E->front_left == E->page_size) {
+        E->front_base -= (flatbuffers_soffset_t)size;
+        return write_at(E, data, size, E->front_base);
+    }
+    data += size;
+    while (size) {
+        if (E->front_left == 0) {
+            if (flush_front(E)) {
+                return -1;
+            }
+        }
+        k = size < E->front_left ? size : E->front_left;
+        E->front_left -= k;
+        data -= k;
+        size -= k;
+        memcpy(E->front_page + E->front_left, data, k);
+    }
+    return 0;
+}
+
+static int copy_back(flatcc_fd_emitter_t *E, const uint8_t *data, size_t size)
+{
+    size_t k;
+
+    if (size >= E->page_size && E->back_used == 0) {
+        E->back_base += (flatbuffers_soffset_t)size;
+        return write_at(E, data, size, E->back_base - (flatbuffers_soffset_t)size);
+    }
+    while (size) {
+        if (E->back_used == E->page_size) {
+            if (flush_back(E)) {
+                return -1;
+            }
+        }
+        k = E->page_size - E->back_used;
+        k = size < k ? size : k;
+        memcpy(E->back_page + E->back_used, data, k);
+        E->back_used += k;
+        data += k;
+        size -= k;
+    }
+    return 0;
+}
+
+void flatcc_fd_emitter_init(flatcc_fd_emitter_t *E, int fd, off_t origin, size_t page_size)
+{
+    memset(E, 0, sizeof(*E));
+    E->fd = fd;
+    E->origin = origin;
+    E->page_size = page_size ? page_size : FLATCC_FD_EMITTER_PAGE_SIZE;
+}
+
+void flatcc_fd_emitter_reset(flatcc_fd_emitter_t *E, off_t origin)
+{
+    E->origin = origin;
+    E->front_left = E->page_size;
+    E->back_used = 0;
+    E->front_base = 0;
+    E->back_base = 0;
+    E->start = 0;
+    E->end = 0;
+    E->used = 0;
+}
+
+void flatcc_fd_emitter_clear(flatcc_fd_emitter_t *E)
+{
+    if (E->front_page) {
+        free(E->front_page);
+    }
+    flatcc_fd_emitter_init(E, E->fd, E->origin, E->page_size);
+}
+
+int flatcc_fd_emitter_finalize(flatcc_fd_emitter_t *E, off_t *offset_out, size_t *size_out)
+{
+    int ret = 0;
+
+    if (E->front_page) {
+        ret = flush_front(E) | flush_back(E);
+    }
+    if (offset_out) {
+        *offset_out = ret ? 0 : E->origin + (off_t)E->start;
+    }
+    if (size_out) {
+        *size_out = ret ? 0 : E->used;
+    }
+    return ret ? -1 : 0;
+}
+
+int flatcc_fd_emitter(void *emit_context,
+        const flatcc_iovec_t *iov, int iov_count,
+        flatbuffers_soffset_t offset, size_t len)
+{
+    flatcc_fd_emitter_t *E = emit_context;
+
+    if (!E->front_page && alloc_pages(E)) {
+        return -1;
+    }
+    E->used += len;
+    if (offset < 0) {
+        E->start = offset;
+        iov += iov_count;
+        while (iov_count--) {
+            --iov;
+            if (copy_front(E, iov->iov_base, iov->iov_len)) {
+                return -1;
+            }
+        }
+    } else {
+        E->end = offset + (flatbuffers_soffset_t)len;
+        while (iov_count--) {
+            if (copy_back(E, iov->iov_base, iov->iov_len)) {
+                return -1;
+            }
+            ++iov;
+        }
+    }
+    return 0;
+}
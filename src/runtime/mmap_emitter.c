@@ -0,0 +1,158 @@
+/*
+ * Memory mapped file emitter, see `flatcc_mmap_emitter.h`.
+ *
+ * Requires POSIX `mmap` and `ftruncate`.
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_mmap_emitter.h"
+
+static size_t os_page_roundup(size_t n)
+{
+    long k = sysconf(_SC_PAGESIZE);
+    size_t page = k > 0 ? (size_t)k : 4096;
+
+    return (n + page - 1) / page * page;
+}
+
+static int map_file(flatcc_mmap_emitter_t *E, size_t size)
+{
+    void *p;
+
+    if (ftruncate(E->fd, (off_t)size)) {
+        return -1;
+    }
+    p = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, E->fd, 0);
+    if (p == MAP_FAILED) {
+        return -1;
+    }
+    E->map = p;
+    E->map_size = size;
+    return 0;
+}
+
+static void unmap_file(flatcc_mmap_emitter_t *E)
+{
+    if (E->map) {
+        munmap(E->map, E->map_size);
+    }
+    E->map = 0;
+    E->map_size = 0;
+}
+
+/*
+ * Grows the mapping by at least `front` bytes below and `back` bytes
+ * above the current range. Each end that grows at least doubles so
+ * repeated growth is amortized.
+ */
+static int grow(flatcc_mmap_emitter_t *E, size_t front, size_t back)
+{
+    size_t back_size = E->map_size - E->origin;
+    size_t origin;
+
+    if (front) {
+        front = os_page_roundup(front > E->origin ? front : E->origin);
+    }
+    if (back) {
+        back = os_page_roundup(back > back_size ? back : back_size);
+    }
+    origin = E->origin + front;
+    back_size += back;
+    unmap_file(E);
+    if (map_file(E, origin + back_size)) {
+        return -1;
+    }
+    if (front && E->used) {
+        memmove(E->map + origin + E->start, E->map + E->origin + E->start, E->used);
+    }
+    E->origin = origin;
+    return 0;
+}
+
+int flatcc_mmap_emitter_init(flatcc_mmap_emitter_t *E, int fd, size_t reserve)
+{
+    memset(E, 0, sizeof(*E));
+    E->fd = fd;
+    reserve = os_page_roundup(reserve ? reserve : FLATCC_MMAP_EMITTER_RESERVE);
+    /* Keep the origin page aligned so both halves are whole pages. */
+    E->origin = os_page_roundup(reserve / 2);
+    if (E->origin >= reserve) {
+        reserve = 2 * E->origin;
+    }
+    return map_file(E, reserve);
+}
+
+void flatcc_mmap_emitter_clear(flatcc_mmap_emitter_t *E)
+{
+    int fd = E->fd;
+
+    unmap_file(E);
+    memset(E, 0, sizeof(*E));
+    E->fd = fd;
+}
+
+void *flatcc_mmap_emitter_finalize(flatcc_mmap_emitter_t *E, size_t *size_out)
+{
+    size_t size = E->used;
+
+    if (size_out) {
+        *size_out = 0;
+    }
+    if (!E->map || size == 0) {
+        return 0;
+    }
+    /* The buffer is typically much smaller than the reservation. */
+    memmove(E->map, E->map + E->origin + E->start, size);
+    unmap_file(E);
+    if (map_file(E, size)) {
+        return 0;
+    }
+    E->origin = (size_t)-E->start;
+    if (size_out) {
+        *size_out = size;
+    }
+    return E->map;
+}
+
+int flatcc_mmap_emitter(void *emit_context,
+        const flatcc_iovec_t *iov, int iov_count,
+        flatbuffers_soffset_t offset, size_t len)
+{
+    flatcc_mmap_emitter_t *E = emit_context;
+    uint8_t *p;
+    size_t k;
+
+    if (!E->map) {
+        return -1;
+    }
+    if (offset < 0) {
+        k = (size_t)-offset;
+        if (k > E->origin && grow(E, k - E->origin, 0)) {
+            return -1;
+        }
+        E->start = offset;
+    } else {
+        k = (size_t)offset + len;
+        if (k > E->map_size - E->origin && grow(E, 0, k - (E->map_size - E->origin))) {
+            return -1;
+        }
+        E->end = offset + (flatbuffers_soffset_t)len;
+    }
+    E->used += len;
+    p = E->map + E->origin + offset;
+    while (iov_count--) {
+        memcpy(p, iov->iov_base, iov->iov_len);
+        p += iov->iov_len;
+        ++iov;
+    }
+    return 0;
+}
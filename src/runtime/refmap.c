@@ -0,0 +1,135 @@
+/*
+ * Pointer to reference map for cloning, see `flatcc_refmap.h`.
+ *
+ * Open addressing with linear probing. Entries are never removed
+ * individually so no tombstones are needed. A null `table` means the
+ * entries are stored in `min_table`, which keeps the refmap safe to
+ * copy while it is small.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_refmap.h"
+
+/* Grow when more than 3/4 of the buckets are in use. */
+#define is_full(count, buckets) ((count) * 4 >= (buckets) * 3)
+
+static inline size_t hash_ptr(const void *p, size_t mask)
+{
+    uint64_t x = (uint64_t)(uintptr_t)p;
+
+    /* Fibonacci hashing, the low bits of pointers are mostly zero. */
+    x *= 0x9e3779b97f4a7c15ULL;
+    return (size_t)(x >> 32) & mask;
+}
+
+static inline flatcc_refmap_item_t *get_table(flatcc_refmap_t *refmap)
+{
+    return refmap->table ? refmap->table : refmap->min_table;
+}
+
+void flatcc_refmap_init(flatcc_refmap_t *refmap)
+{
+    memset(refmap, 0, sizeof(*refmap));
+    refmap->buckets = FLATCC_REFMAP_MIN_BUCKETS;
+}
+
+void flatcc_refmap_clear(flatcc_refmap_t *refmap)
+{
+    if (refmap->table) {
+        free(refmap->table);
+    }
+    flatcc_refmap_init(refmap);
+}
+
+void flatcc_refmap_reset(flatcc_refmap_t *refmap)
+{
+    if (refmap->count) {
+        memset(get_table(refmap), 0, refmap->buckets * sizeof(flatcc_refmap_item_t));
+    }
+    refmap->count = 0;
+}
+
+static void insert_item(flatcc_refmap_item_t *table, size_t mask,
+        const void *src, flatcc_builder_ref_t ref)
+{
+    size_t i = hash_ptr(src, mask);
+
+    while (table[i].src && table[i].src != src) {
+        i = (i + 1) & mask;
+    }
+    table[i].src = src;
+    table[i].ref = ref;
+}
+
+static int resize(flatcc_refmap_t *refmap, size_t buckets)
+{
+    flatcc_refmap_item_t *table, *old = get_table(refmap);
+    size_t i;
+
+    if (!(table = calloc(buckets, sizeof(table[0])))) {
+        return -1;
+    }
+    for (i = 0; i < refmap->buckets; ++i) {
+        if (old[i].src) {
+            insert_item(table, buckets - 1, old[i].src, old[i].ref);
+        }
+    }
+    if (refmap->table) {
+        free(refmap->table);
+    }
+    refmap->table = table;
+    refmap->buckets = buckets;
+    return 0;
+}
+
+flatcc_builder_ref_t flatcc_refmap_insert(flatcc_refmap_t *refmap,
+        const void *src, flatcc_builder_ref_t ref)
+{
+    flatcc_refmap_item_t *table;
+    size_t i, mask;
+
+    if (src == 0 || ref == 0) {
+        return ref;
+    }
+    if (is_full(refmap->count + 1, refmap->buckets)) {
+        if (resize(refmap, refmap->buckets * 2)) {
+            return 0;
+        }
+    }
+    table = get_table(refmap);
+    mask = refmap->buckets - 1;
+    i = hash_ptr(src, mask);
+    while (table[i].src && table[i].src != src) {
+        i = (i + 1) & mask;
+    }
+    if (!table[i].src) {
+        ++refmap->count;
+    }
+    table[i].src = src;
+    table[i].ref = ref;
+    return ref;
+}
+
+flatcc_builder_ref_t flatcc_refmap_find(flatcc_refmap_t *refmap, const void *src)
+{
+    flatcc_refmap_item_t *table;
+    size_t i, mask;
+
+    if (src == 0 || refmap->count == 0) {
+        return 0;
+    }
+    table = get_table(refmap);
+    mask = refmap->buckets - 1;
+    i = hash_ptr(src, mask);
+    while (table[i].src) {
+        if (table[i].src == src) {
+            return table[i].ref;
+        }
+        i = (i + 1) & mask;
+    }
+    return 0;
+}
@@ -11,6 +11,27 @@
 #include "flatcc/flatcc_flatbuffers.h"
 #include "flatcc/flatcc_verifier.h"
 
+/*
+ * String content checks use SSE2 when available at compile time and
+ * AVX2 when the CPU supports it at runtime, as in `byteswap.c`.
+ */
+#if FLATCC_VERIFIER_SIMD && (defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define HAVE_SSE2 0
+#endif
+
+#if HAVE_SSE2 && (defined(__x86_64__) || defined(__i386__)) && \
+        ((defined(__clang__) && __clang_major__ >= 4) || \
+        (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 5))
+#define HAVE_AVX2 1
+#include <immintrin.h>
+#else
+#define HAVE_AVX2 0
+#endif
+
 /* Customization for testing. */
 #if FLATCC_DEBUG_VERIFY
 #define FLATCC_VERIFIER_ASSERT_ON_ERROR 1
@@ -30,6 +51,16 @@
 #define FLATCC_VERIFIER_ASSERT_ON_ERROR 0
 #endif
 
+/* Offset vectors shorter than this are not split for parallel verification. */
+#ifndef FLATCC_VERIFIER_PARALLEL_MIN_COUNT
+#define FLATCC_VERIFIER_PARALLEL_MIN_COUNT 4096
+#endif
+
+/* Largest number of tasks an offset vector is split into. */
+#ifndef FLATCC_VERIFIER_PARALLEL_MAX_TASKS
+#define FLATCC_VERIFIER_PARALLEL_MAX_TASKS 64
+#endif
+
 /*
  * Generally a check should tell if a buffer is valid or not such
  * that runtime can take appropriate actions rather than crash,
@@ -84,7 +115,11 @@ const char *flatcc_verify_error_string(int err)
  */
 #define verify_runtime(cond, reason) verify(cond, reason)
 
-#define check_result(x) if (x) { return (x); }
+/* `x` is evaluated once, otherwise a failing table would be verified twice at every level. */
+#define check_result(x) do { int ret_ = (x); if (ret_) { return ret_; } } while (0)
+
+/* Fields left out of the mask of a restricted verification are not verified. */
+#define check_selected(td, id) do { if (!field_selected((td)->mask, id)) { return flatcc_verify_ok; }} while (0)
 
 #define check_field(td, id, required, base) do {                   \
     int ret = get_offset_field(td, id, required, &base);                    \
@@ -132,6 +167,81 @@ static inline int verify_struct(uoffset_t end, uoffset_t base, uint16_t align, u
     return flatcc_verify_ok;
 }
 
+/* Kinds of objects recorded in the visited set. */
+enum { memo_table, memo_table_vector, memo_string_vector };
+
+/*
+ * Finds the entry for the object or the empty slot where it belongs.
+ * The set is kept at most half full so probing always ends.
+ */
+static flatcc_verify_memo_entry_t *memo_find(flatcc_verify_memo_t *memo, const void *buf,
+        uoffset_t offset, int kind, flatcc_table_verifier_f *tvf)
+{
+    flatcc_verify_memo_entry_t *e;
+    size_t i;
+
+    /* Objects are at least uoffset aligned. */
+    i = (size_t)(((offset / offset_size) + (uoffset_t)kind) * (uoffset_t)2654435761UL) & memo->mask;
+    for (;;) {
+        e = memo->entries + i;
+        if (e->buf == 0 || (e->buf == buf && e->offset == offset && e->kind == kind && e->tvf == tvf)) {
+            return e;
+        }
+        i = (i + 1) & memo->mask;
+    }
+}
+
+/*
+ * An object verified with no more nesting levels left than `ttl` also
+ * verifies with `ttl` levels left.
+ */
+static inline int memo_visited(flatcc_verify_memo_t *memo, const void *buf,
+        uoffset_t offset, int kind, flatcc_table_verifier_f *tvf, int ttl)
+{
+    flatcc_verify_memo_entry_t *e;
+
+    if (!memo) {
+        return 0;
+    }
+    e = memo_find(memo, buf, offset, kind, tvf);
+    return e->buf != 0 && e->ttl <= ttl;
+}
+
+/* Objects that do not fit are not recorded and will be verified again. */
+static inline void memo_insert(flatcc_verify_memo_t *memo, const void *buf,
+        uoffset_t offset, int kind, flatcc_table_verifier_f *tvf, int ttl)
+{
+    flatcc_verify_memo_entry_t *e;
+
+    if (!memo) {
+        return;
+    }
+    /* Recursive inserts may have taken the slot found before verification. */
+    e = memo_find(memo, buf, offset, kind, tvf);
+    if (e->buf == 0) {
+        if (2 * (memo->count + 1) > memo->mask + 1) {
+            return;
+        }
+        e->buf = buf;
+        e->tvf = tvf;
+        e->offset = offset;
+        e->kind = (uint16_t)kind;
+        ++memo->count;
+    }
+    e->ttl = (uint16_t)ttl;
+}
+
+static inline int field_selected(const flatcc_verify_mask_t *mask, voffset_t id)
+{
+    return !mask || (id / 32 < mask->count && (mask->fields[id / 32] >> (id % 32)) & 1);
+}
+
+/* Null, verifying the whole subtree, unless the mask restricts it. */
+static inline const flatcc_verify_mask_t *child_mask(flatcc_table_verifier_descriptor_t *td, voffset_t id)
+{
+    return td->mask && td->mask->children && id / 32 < td->mask->count ? td->mask->children[id] : 0;
+}
+
 static inline uoffset_t read_vt_entry(flatcc_table_verifier_descriptor_t *td, voffset_t id)
 {
     voffset_t vo = (id + 2) * sizeof(voffset_t);
@@ -216,7 +326,216 @@ static int get_offset_field(flatcc_table_verifier_descriptor_t *td, voffset_t id
     return flatcc_verify_ok;
 }
 
-static inline int verify_string(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset)
+#if HAVE_SSE2
+/*
+ * Returns the length of the prefix of whole 16 byte blocks that needs
+ * no scalar check: ASCII when validating UTF-8, and without zeroes
+ * when they are rejected.
+ */
+static inline size_t skip_text_sse2(const uint8_t *s, size_t n, int flags)
+{
+    size_t i, m = n & ~(size_t)15;
+    __m128i x, zero = _mm_setzero_si128();
+    int bits;
+
+    for (i = 0; i < m; i += 16) {
+        x = _mm_loadu_si128((const __m128i *)(const void *)(s + i));
+        bits = 0;
+        if (flags & flatcc_verify_flag_utf8) {
+            bits |= _mm_movemask_epi8(x);
+        }
+        if (flags & flatcc_verify_flag_no_zero) {
+            bits |= _mm_movemask_epi8(_mm_cmpeq_epi8(x, zero));
+        }
+        if (bits) {
+            break;
+        }
+    }
+    return i;
+}
+#endif
+
+#if HAVE_AVX2
+/*
+ * Error classes of a byte and the byte before it in the lookup
+ * validation of Keiser and Lemire, "Validating UTF-8 In Less Than One
+ * Instruction Per Byte". A pair is invalid when the classes found for
+ * the high and low nibble of the first byte and the high nibble of the
+ * second byte share a bit.
+ */
+enum {
+    utf8_too_short = 1 << 0,
+    utf8_too_long = 1 << 1,
+    utf8_overlong_3 = 1 << 2,
+    utf8_too_large = 1 << 3,
+    utf8_surrogate = 1 << 4,
+    utf8_overlong_2 = 1 << 5,
+    utf8_too_large_1000 = 1 << 6,
+    utf8_overlong_4 = 1 << 6,
+    utf8_two_conts = 1 << 7,
+    utf8_carry = utf8_too_short | utf8_too_long | utf8_two_conts,
+    utf8_large = utf8_carry | utf8_too_large | utf8_too_large_1000,
+    utf8_cont = utf8_too_long | utf8_overlong_2 | utf8_two_conts
+};
+
+static const uint8_t utf8_byte_1_high[16] = {
+    /* ASCII. */
+    utf8_too_long, utf8_too_long, utf8_too_long, utf8_too_long,
+    utf8_too_long, utf8_too_long, utf8_too_long, utf8_too_long,
+    /* Continuation. */
+    utf8_two_conts, utf8_two_conts, utf8_two_conts, utf8_two_conts,
+    /* Two, three and four byte leads. */
+    utf8_too_short | utf8_overlong_2,
+    utf8_too_short,
+    utf8_too_short | utf8_overlong_3 | utf8_surrogate,
+    utf8_too_short | utf8_too_large | utf8_too_large_1000 | utf8_overlong_4
+};
+
+static const uint8_t utf8_byte_1_low[16] = {
+    utf8_carry | utf8_overlong_3 | utf8_overlong_2 | utf8_overlong_4,
+    utf8_carry | utf8_overlong_2,
+    utf8_carry, utf8_carry,
+    utf8_carry | utf8_too_large,
+    utf8_large, utf8_large, utf8_large, utf8_large,
+    utf8_large, utf8_large, utf8_large, utf8_large,
+    utf8_large | utf8_surrogate,
+    utf8_large, utf8_large
+};
+
+static const uint8_t utf8_byte_2_high[16] = {
+    /* ASCII. */
+    utf8_too_short, utf8_too_short, utf8_too_short, utf8_too_short,
+    utf8_too_short, utf8_too_short, utf8_too_short, utf8_too_short,
+    /* Continuation 0x80..0x8f, 0x90..0x9f, 0xa0..0xbf. */
+    utf8_cont | utf8_overlong_3 | utf8_too_large_1000 | utf8_overlong_4,
+    utf8_cont | utf8_overlong_3 | utf8_too_large,
+    utf8_cont | utf8_surrogate | utf8_too_large,
+    utf8_cont | utf8_surrogate | utf8_too_large,
+    /* Lead. */
+    utf8_too_short, utf8_too_short, utf8_too_short, utf8_too_short
+};
+
+/* Nonzero where a block ends inside a sequence. */
+static const uint8_t utf8_incomplete_max[32] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1
+};
+
+__attribute__((target("avx2")))
+static inline __m256i lookup_avx2(const uint8_t *table, __m256i nibbles)
+{
+    return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(
+            _mm_loadu_si128((const __m128i *)(const void *)table)), nibbles);
+}
+
+/*
+ * Checks whole 32 byte blocks and sets `*checked` to the number of
+ * bytes that need no scalar check. This excludes a sequence left
+ * incomplete by the last block, which is not an error here. Zeroes are
+ * recorded in `*zero` rather than reported so invalid UTF-8 is
+ * reported first, as by the scalar check.
+ */
+__attribute__((target("avx2")))
+static int check_text_avx2(const uint8_t *s, size_t n, int flags, size_t *checked, int *zero)
+{
+    size_t i, m = n & ~(size_t)31;
+    __m256i x, prev, prev1, prev2, prev3, t, sc, must23;
+    __m256i nul = _mm256_setzero_si256(), err = _mm256_setzero_si256(), zeroes = _mm256_setzero_si256();
+    __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i incomplete = _mm256_loadu_si256((const __m256i *)(const void *)utf8_incomplete_max);
+
+    prev = nul;
+    for (i = 0; i < m; i += 32) {
+        x = _mm256_loadu_si256((const __m256i *)(const void *)(s + i));
+        zeroes = _mm256_or_si256(zeroes, _mm256_cmpeq_epi8(x, nul));
+        if (!(flags & flatcc_verify_flag_utf8)) {
+            continue;
+        }
+        if (!_mm256_movemask_epi8(x)) {
+            /* ASCII is valid unless a sequence is cut short. */
+            err = _mm256_or_si256(err, _mm256_subs_epu8(prev, incomplete));
+            prev = x;
+            continue;
+        }
+        t = _mm256_permute2x128_si256(prev, x, 0x21);
+        prev1 = _mm256_alignr_epi8(x, t, 15);
+        prev2 = _mm256_alignr_epi8(x, t, 14);
+        prev3 = _mm256_alignr_epi8(x, t, 13);
+        sc = lookup_avx2(utf8_byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low));
+        sc = _mm256_and_si256(sc, lookup_avx2(utf8_byte_1_low, _mm256_and_si256(prev1, low)));
+        sc = _mm256_and_si256(sc, lookup_avx2(utf8_byte_2_high, _mm256_and_si256(_mm256_srli_epi16(x, 4), low)));
+        /* The second byte after a three or four byte lead, and the third after a four byte lead. */
+        must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xe0 - 0x80))),
+                _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xf0 - 0x80))));
+        must23 = _mm256_and_si256(must23, _mm256_set1_epi8((char)0x80));
+        err = _mm256_or_si256(err, _mm256_xor_si256(must23, sc));
+        prev = x;
+    }
+    *zero |= _mm256_movemask_epi8(zeroes) != 0;
+    verify(_mm256_testz_si256(err, err), flatcc_verify_error_string_not_valid_utf8);
+    if (flags & flatcc_verify_flag_utf8) {
+        /* Back up to the lead of the last sequence, which may be incomplete. */
+        for (i = 0; i < 3 && m > 0 && (s[m - 1] & 0xc0) == 0x80; ++i) {
+            --m;
+        }
+        if (m > 0 && s[m - 1] >= 0xc0) {
+            --m;
+        }
+    }
+    *checked = m;
+    return flatcc_verify_ok;
+}
+#endif
+
+/*
+ * Checks string content for `flatcc_verify_table_as_root_with_flags`.
+ * Invalid UTF-8 is reported before embedded zeroes, wherever they are.
+ */
+static int verify_string_text(const uint8_t *s, size_t n, int flags)
+{
+    size_t i = 0, k, len;
+    int zero = 0;
+    uint8_t lead, lo, hi;
+
+#if HAVE_AVX2
+    if (n >= 32 && __builtin_cpu_supports("avx2")) {
+        check_result(check_text_avx2(s, n, flags, &i, &zero));
+    }
+#endif
+    while (i < n) {
+#if HAVE_SSE2
+        if ((i += skip_text_sse2(s + i, n - i, flags)) == n) {
+            break;
+        }
+#endif
+        /* Up to the next ASCII byte, where whole blocks may be skipped again. */
+        do {
+            lead = s[i];
+            if (lead < 0x80 || !(flags & flatcc_verify_flag_utf8)) {
+                zero |= lead == 0;
+                ++i;
+                continue;
+            }
+            verify(lead >= 0xc2 && lead <= 0xf4, flatcc_verify_error_string_not_valid_utf8);
+            len = lead < 0xe0 ? 2 : lead < 0xf0 ? 3 : 4;
+            verify(n - i >= len, flatcc_verify_error_string_not_valid_utf8);
+            /* Excludes overlong forms, surrogates and code points above U+10FFFF. */
+            lo = lead == 0xe0 ? 0xa0 : lead == 0xf0 ? 0x90 : 0x80;
+            hi = lead == 0xed ? 0x9f : lead == 0xf4 ? 0x8f : 0xbf;
+            verify(s[i + 1] >= lo && s[i + 1] <= hi, flatcc_verify_error_string_not_valid_utf8);
+            for (k = 2; k < len; ++k) {
+                verify((s[i + k] & 0xc0) == 0x80, flatcc_verify_error_string_not_valid_utf8);
+            }
+            i += len;
+        } while (i < n && s[i] >= 0x80 && (flags & flatcc_verify_flag_utf8));
+    }
+    verify(!zero || !(flags & flatcc_verify_flag_no_zero), flatcc_verify_error_string_has_embedded_zero);
+    return flatcc_verify_ok;
+}
+
+static inline int verify_string(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset, int flags)
 {
     uoffset_t n;
 
@@ -224,8 +543,11 @@ static inline int verify_string(const void *buf, uoffset_t end, uoffset_t base,
     base += offset;
     n = read_uoffset(buf, base);
     base += offset_size;
-    verify(end - base >= n + 1, flatcc_verify_error_string_out_of_range);
+    verify(end - base > n, flatcc_verify_error_string_out_of_range);
     verify(((uint8_t *)buf + base)[n] == 0, flatcc_verify_error_string_not_zero_terminated);
+    if (flags) {
+        check_result(verify_string_text((const uint8_t *)buf + base, n, flags));
+    }
     return flatcc_verify_ok;
 }
 
@@ -247,67 +569,181 @@ static inline int verify_vector(const void *buf, uoffset_t end, uoffset_t base,
     return flatcc_verify_ok;
 }
 
-static inline int verify_string_vector(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset)
-{
-    uoffset_t i, n;
-
-    check_result(verify_vector(buf, end, base, offset, offset_size, offset_size, FLATBUFFERS_COUNT_MAX(offset_size)));
-    base += offset;
-    n = read_uoffset(buf, base);
-    base += offset_size;
-    for (i = 0; i < n; ++i, base += offset_size) {
-        check_result(verify_string(buf, end, base, read_uoffset(buf, base)));
-    }
-    return flatcc_verify_ok;
-}
-
-static inline int verify_table(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset, int ttl, flatcc_table_verifier_f tvf)
+/* Verifies the vtable of the table at `td->table` and fills in the descriptor. */
+static inline int verify_table_header(flatcc_table_verifier_descriptor_t *td, const void *buf, uoffset_t end)
 {
     uoffset_t vbase, vend;
-    flatcc_table_verifier_descriptor_t td;
 
-    verify((td.ttl = ttl - 1), flatcc_verify_error_max_nesting_level_reached);
-    verify(check_header(end, base, offset), flatcc_verify_error_table_header_out_of_range_or_unaligned);
-    td.table = base + offset;
     /* Read vtable offset - it is signed, but we want it unsigned, assuming 2's complement works. */
-    vbase = td.table - read_uoffset(buf, td.table);
+    vbase = td->table - read_uoffset(buf, td->table);
     verify((soffset_t)vbase >= 0 && !(vbase & (voffset_size - 1)), flatcc_verify_error_vtable_offset_out_of_range_or_unaligned);
     verify(vbase + voffset_size <= end, flatcc_verify_error_vtable_header_out_of_range);
     /* Read vtable size. */
-    td.vsize = read_voffset(buf, vbase);
-    vend = vbase + td.vsize;
-    verify(vend <= end && !(td.vsize & (voffset_size - 1)), flatcc_verify_error_vtable_size_out_of_range_or_unaligned);
+    td->vsize = read_voffset(buf, vbase);
+    vend = vbase + td->vsize;
+    verify(vend <= end && !(td->vsize & (voffset_size - 1)), flatcc_verify_error_vtable_size_out_of_range_or_unaligned);
     /* Optimizes away overflow check if uoffset_t is large enough. */
     verify(uoffset_size > voffset_size || vend >= vbase, flatcc_verify_error_vtable_size_overflow);
 
-    verify(td.vsize >= 2 * voffset_size, flatcc_verify_error_vtable_header_too_small);
+    verify(td->vsize >= 2 * voffset_size, flatcc_verify_error_vtable_header_too_small);
     /* Read table size. */
-    td.tsize = read_voffset(buf, vbase + voffset_size);
-    verify(end - td.table >= td.tsize, flatcc_verify_error_table_size_out_of_range);
-    td.vtable = (uint8_t *)buf + vbase;
-    td.buf = buf;
-    td.end = end;
-    return tvf(&td);
+    td->tsize = read_voffset(buf, vbase + voffset_size);
+    verify(end - td->table >= td->tsize, flatcc_verify_error_table_size_out_of_range);
+    td->vtable = (uint8_t *)buf + vbase;
+    td->buf = buf;
+    td->end = end;
+    return flatcc_verify_ok;
+}
+
+static inline int verify_table(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset, int ttl, flatcc_table_verifier_f tvf,
+        flatcc_verify_memo_t *memo, flatcc_verify_parallel_t *parallel, const flatcc_verify_mask_t *mask, int flags)
+{
+    flatcc_table_verifier_descriptor_t td;
+
+    verify((td.ttl = ttl - 1) > 0, flatcc_verify_error_max_nesting_level_reached);
+    verify(check_header(end, base, offset), flatcc_verify_error_table_header_out_of_range_or_unaligned);
+    td.table = base + offset;
+    if (memo_visited(memo, buf, td.table, memo_table, tvf, td.ttl)) {
+        return flatcc_verify_ok;
+    }
+    check_result(verify_table_header(&td, buf, end));
+    td.memo = memo;
+    td.parallel = parallel;
+    td.mask = mask;
+    td.flags = flags;
+    check_result(tvf(&td));
+    memo_insert(memo, buf, td.table, memo_table, tvf, td.ttl);
+    return flatcc_verify_ok;
+}
+
+/*
+ * A large offset vector is split into chunks verified as separate tasks
+ * by the caller's runner. Tasks have their own descriptors and do not
+ * split nested vectors, so a runner is never entered from a task. Each
+ * task stops at its first error, and the error of the first failing
+ * chunk is returned, which is the error sequential verification finds.
+ */
+typedef struct parallel_vector parallel_vector_t;
+struct parallel_vector {
+    const void *buf;
+    uoffset_t end;
+    /* Position of the first element. */
+    uoffset_t base;
+    uoffset_t count;
+    uoffset_t chunk;
+    int ttl;
+    int flags;
+    /* Null for string vectors. */
+    flatcc_table_verifier_f *tvf;
+    int results[FLATCC_VERIFIER_PARALLEL_MAX_TASKS];
+};
+
+static void verify_vector_chunk(void *context, size_t index)
+{
+    parallel_vector_t *pv = context;
+    uoffset_t i, n, base;
+    int ret = flatcc_verify_ok;
+
+    i = (uoffset_t)index * pv->chunk;
+    n = pv->count - i < pv->chunk ? pv->count : i + pv->chunk;
+    base = pv->base + i * offset_size;
+    for (; i < n && !ret; ++i, base += offset_size) {
+        if (pv->tvf) {
+            ret = verify_table(pv->buf, pv->end, base, read_uoffset(pv->buf, base), pv->ttl, pv->tvf, 0, 0, 0, pv->flags);
+        } else {
+            ret = verify_string(pv->buf, pv->end, base, read_uoffset(pv->buf, base), pv->flags);
+        }
+    }
+    pv->results[index] = ret;
+}
+
+/* `base` is the vector header, which has been verified. Returns -1 if the vector is verified sequentially. */
+static int verify_vector_parallel(flatcc_verify_parallel_t *parallel, const void *buf, uoffset_t end,
+        uoffset_t base, int ttl, flatcc_table_verifier_f *tvf, int flags)
+{
+    parallel_vector_t pv;
+    uoffset_t n = read_uoffset(buf, base);
+    size_t i, tasks;
+
+    if (!parallel || n < FLATCC_VERIFIER_PARALLEL_MIN_COUNT) {
+        return -1;
+    }
+    tasks = n / FLATCC_VERIFIER_PARALLEL_MIN_COUNT;
+    if (tasks > FLATCC_VERIFIER_PARALLEL_MAX_TASKS) {
+        tasks = FLATCC_VERIFIER_PARALLEL_MAX_TASKS;
+    }
+    pv.chunk = (uoffset_t)((n + tasks - 1) / tasks);
+    tasks = (n + pv.chunk - 1) / pv.chunk;
+    pv.buf = buf;
+    pv.end = end;
+    pv.base = base + offset_size;
+    pv.count = n;
+    pv.ttl = ttl;
+    pv.tvf = tvf;
+    pv.flags = flags;
+    for (i = 0; i < tasks; ++i) {
+        pv.results[i] = flatcc_verify_error_runtime_task_not_run;
+    }
+    parallel->runner(parallel->runner_context, verify_vector_chunk, &pv, tasks);
+    for (i = 0; i < tasks; ++i) {
+        check_result(pv.results[i]);
+    }
+    return flatcc_verify_ok;
+}
+
+static inline int verify_string_vector(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset,
+        flatcc_verify_memo_t *memo, flatcc_verify_parallel_t *parallel, int flags)
+{
+    uoffset_t i, n, vec;
+    int ret;
+
+    check_result(verify_vector(buf, end, base, offset, offset_size, offset_size, FLATBUFFERS_COUNT_MAX(offset_size)));
+    base += offset;
+    vec = base;
+    if (memo_visited(memo, buf, vec, memo_string_vector, 0, 0)) {
+        return flatcc_verify_ok;
+    }
+    if ((ret = verify_vector_parallel(parallel, buf, end, vec, 0, 0, flags)) >= 0) {
+        return ret;
+    }
+    n = read_uoffset(buf, base);
+    base += offset_size;
+    for (i = 0; i < n; ++i, base += offset_size) {
+        check_result(verify_string(buf, end, base, read_uoffset(buf, base), flags));
+    }
+    memo_insert(memo, buf, vec, memo_string_vector, 0, 0);
+    return flatcc_verify_ok;
 }
 
-static inline int verify_table_vector(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset, int ttl, flatcc_table_verifier_f tvf)
+static inline int verify_table_vector(const void *buf, uoffset_t end, uoffset_t base, uoffset_t offset, int ttl, flatcc_table_verifier_f tvf,
+        flatcc_verify_memo_t *memo, flatcc_verify_parallel_t *parallel, const flatcc_verify_mask_t *mask, int flags)
 {
-    uoffset_t i, n;
+    uoffset_t i, n, vec;
+    int ret;
 
     verify(ttl-- > 0, flatcc_verify_error_max_nesting_level_reached);
     check_result(verify_vector(buf, end, base, offset, offset_size, offset_size, FLATBUFFERS_COUNT_MAX(offset_size)));
     base += offset;
+    vec = base;
+    if (memo_visited(memo, buf, vec, memo_table_vector, tvf, ttl)) {
+        return flatcc_verify_ok;
+    }
+    if ((ret = verify_vector_parallel(parallel, buf, end, vec, ttl, tvf, flags)) >= 0) {
+        return ret;
+    }
     n = read_uoffset(buf, base);
     base += offset_size;
     for (i = 0; i < n; ++i, base += offset_size) {
-        check_result(verify_table(buf, end, base, read_uoffset(buf, base), ttl, tvf));
+        check_result(verify_table(buf, end, base, read_uoffset(buf, base), ttl, tvf, memo, parallel, mask, flags));
     }
+    memo_insert(memo, buf, vec, memo_table_vector, tvf, ttl);
     return flatcc_verify_ok;
 }
 
 int flatcc_verify_field(flatcc_table_verifier_descriptor_t *td,
         voffset_t id, uint16_t align, size_t size)
 {
+    check_selected(td, id);
     check_result(verify_field(td, id, 0, align, (uoffset_t)size));
     return flatcc_verify_ok;
 }
@@ -317,8 +753,9 @@ int flatcc_verify_string_field(flatcc_table_verifier_descriptor_t *td,
 {
     uoffset_t base;
 
+    check_selected(td, id);
     check_field(td, id, required, base);
-    return verify_string(td->buf, td->end, base, read_uoffset(td->buf, base));
+    return verify_string(td->buf, td->end, base, read_uoffset(td->buf, base), td->flags);
 }
 
 int flatcc_verify_vector_field(flatcc_table_verifier_descriptor_t *td,
@@ -326,6 +763,7 @@ int flatcc_verify_vector_field(flatcc_table_verifier_descriptor_t *td,
 {
     uoffset_t base;
 
+    check_selected(td, id);
     check_field(td, id, required, base);
     return verify_vector(td->buf, td->end, base, read_uoffset(td->buf, base),
         align, (uoffset_t)elem_size, (uoffset_t)max_count);
@@ -336,8 +774,9 @@ int flatcc_verify_string_vector_field(flatcc_table_verifier_descriptor_t *td,
 {
     uoffset_t base;
 
+    check_selected(td, id);
     check_field(td, id, required, base);
-    return verify_string_vector(td->buf, td->end, base, read_uoffset(td->buf, base));
+    return verify_string_vector(td->buf, td->end, base, read_uoffset(td->buf, base), td->memo, td->parallel, td->flags);
 }
 
 int flatcc_verify_table_field(flatcc_table_verifier_descriptor_t *td,
@@ -345,8 +784,9 @@ int flatcc_verify_table_field(flatcc_table_verifier_descriptor_t *td,
 {
     uoffset_t base;
 
+    check_selected(td, id);
     check_field(td, id, required, base);
-    return verify_table(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf);
+    return verify_table(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf, td->memo, td->parallel, child_mask(td, id), td->flags);
 }
 
 int flatcc_verify_table_vector_field(flatcc_table_verifier_descriptor_t *td,
@@ -354,8 +794,9 @@ int flatcc_verify_table_vector_field(flatcc_table_verifier_descriptor_t *td,
 {
     uoffset_t base;
 
+    check_selected(td, id);
     check_field(td, id, required, base);
-    return verify_table_vector(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf);
+    return verify_table_vector(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf, td->memo, td->parallel, child_mask(td, id), td->flags);
 }
 
 int flatcc_verify_buffer_header(const void *buf, size_t bufsiz, const char *fid)
@@ -383,7 +824,72 @@ int flatcc_verify_struct_as_root(const void *buf, size_t bufsiz, const char *fid
 int flatcc_verify_table_as_root(const void *buf, size_t bufsiz, const char *fid, flatcc_table_verifier_f *tvf)
 {
     check_result(flatcc_verify_buffer_header(buf, (uoffset_t)bufsiz, fid));
-    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf);
+    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0, 0, 0);
+}
+
+int flatcc_verify_table_as_root_memoized(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, void *scratch, size_t scratch_size)
+{
+    flatcc_verify_memo_t memo, *pmemo = 0;
+    size_t n = scratch_size / sizeof(flatcc_verify_memo_entry_t);
+    size_t need = bufsiz / 2 + 2, size = 2;
+
+    check_result(flatcc_verify_buffer_header(buf, (uoffset_t)bufsiz, fid));
+    /* Don't clear more of the scratch area than the buffer can use. */
+    while (size < need && size * 2 <= n) {
+        size *= 2;
+    }
+    if (scratch && size <= n) {
+        memset(scratch, 0, size * sizeof(flatcc_verify_memo_entry_t));
+        memo.entries = scratch;
+        memo.mask = size - 1;
+        memo.count = 0;
+        pmemo = &memo;
+    }
+    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf, pmemo, 0, 0, 0);
+}
+
+int flatcc_verify_table_as_root_parallel(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, flatcc_verify_runner_f *runner, void *runner_context)
+{
+    flatcc_verify_parallel_t parallel;
+
+    check_result(flatcc_verify_buffer_header(buf, (uoffset_t)bufsiz, fid));
+    parallel.runner = runner;
+    parallel.runner_context = runner_context;
+    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0,
+            runner ? &parallel : 0, 0, 0);
+}
+
+int flatcc_verify_table_as_root_with_mask(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, const flatcc_verify_mask_t *mask)
+{
+    check_result(flatcc_verify_buffer_header(buf, (uoffset_t)bufsiz, fid));
+    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0, mask, 0);
+}
+
+int flatcc_verify_table_as_root_with_flags(const void *buf, size_t bufsiz, const char *fid,
+        flatcc_table_verifier_f *tvf, int flags)
+{
+    check_result(flatcc_verify_buffer_header(buf, (uoffset_t)bufsiz, fid));
+    return verify_table(buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0), FLATCC_VERIFIER_MAX_LEVELS, tvf, 0, 0, 0, flags);
+}
+
+/* `*buf` is null if the field is absent. */
+static int get_nested_buffer(flatcc_table_verifier_descriptor_t *td, voffset_t id, int required, uint16_t align,
+        const uoffset_t **buf, uoffset_t *bufsiz)
+{
+    const uoffset_t *p;
+
+    *buf = 0;
+    check_result(flatcc_verify_vector_field(td, id, required, align, 1, FLATBUFFERS_COUNT_MAX(1)));
+    if (0 == (p = get_field_ptr(td, id))) {
+        return flatcc_verify_ok;
+    }
+    p = (const uoffset_t *)((size_t)p + read_uoffset(p, 0));
+    *bufsiz = read_uoffset(p, 0);
+    *buf = p + 1;
+    return flatcc_verify_ok;
 }
 
 int flatcc_verify_struct_as_nested_root(flatcc_table_verifier_descriptor_t *td,
@@ -392,13 +898,11 @@ int flatcc_verify_struct_as_nested_root(flatcc_table_verifier_descriptor_t *td,
     const uoffset_t *buf;
     uoffset_t bufsiz;
 
-    check_result(flatcc_verify_vector_field(td, id, required, align, 1, FLATBUFFERS_COUNT_MAX(1)));
-    if (0 == (buf = get_field_ptr(td, id))) {
+    check_selected(td, id);
+    check_result(get_nested_buffer(td, id, required, align, &buf, &bufsiz));
+    if (!buf) {
         return flatcc_verify_ok;
     }
-    buf = (const uoffset_t *)((size_t)buf + read_uoffset(buf, 0));
-    bufsiz = read_uoffset(buf, 0);
-    ++buf;
     return flatcc_verify_struct_as_root(buf, bufsiz, fid, align, size);
 }
 
@@ -409,27 +913,25 @@ int flatcc_verify_table_as_nested_root(flatcc_table_verifier_descriptor_t *td,
     const uoffset_t *buf;
     uoffset_t bufsiz;
 
-    check_result(flatcc_verify_vector_field(td, id, required, align, 1, FLATBUFFERS_COUNT_MAX(1)));
-    if (0 == (buf = get_field_ptr(td, id))) {
+    check_selected(td, id);
+    check_result(get_nested_buffer(td, id, required, align, &buf, &bufsiz));
+    if (!buf) {
         return flatcc_verify_ok;
     }
-    buf = (const uoffset_t *)((size_t)buf + read_uoffset(buf, 0));
-    bufsiz = read_uoffset(buf, 0);
-    ++buf;
     /*
      * Don't verify nested buffers identifier - information is difficult to get and
      * might not be what is desired anyway. User can do it later.
      */
     check_result(flatcc_verify_buffer_header(buf, bufsiz, fid));
-    return verify_table(buf, bufsiz, 0, read_uoffset(buf, 0), td->ttl, tvf);
+    return verify_table(buf, bufsiz, 0, read_uoffset(buf, 0), td->ttl, tvf, td->memo, td->parallel, child_mask(td, id), td->flags);
 }
 
-int flatcc_verify_union_field(flatcc_table_verifier_descriptor_t *td,
-        voffset_t id, int required, flatcc_union_verifier_f *uvf)
+/* `*type` is NONE if the union is absent. */
+static int verify_union_type(flatcc_table_verifier_descriptor_t *td, voffset_t id, int required, uint8_t *type)
 {
     voffset_t vte_type, vte_table;
-    const uint8_t *type;
 
+    *type = 0;
     if (0 == (vte_type = read_vt_entry(td, id - 1))) {
         vte_table = read_vt_entry(td, id);
         verify(vte_table == 0, flatcc_verify_error_union_cannot_have_a_table_without_a_type);
@@ -440,7 +942,150 @@ int flatcc_verify_union_field(flatcc_table_verifier_descriptor_t *td,
     check_result(verify_field(td, id - 1, 0, 1, 1));
     /* Only now is it safe to read the type. */
     vte_table = read_vt_entry(td, id);
-    type = (const uint8_t *)td->buf + td->table + vte_type;
+    *type = *((const uint8_t *)td->buf + td->table + vte_type);
     verify(*type || vte_table == 0, flatcc_verify_error_union_type_NONE_cannot_have_a_table);
-    return uvf(td, id, *type);
+    return flatcc_verify_ok;
+}
+
+int flatcc_verify_union_field(flatcc_table_verifier_descriptor_t *td,
+        voffset_t id, int required, flatcc_union_verifier_f *uvf)
+{
+    uint8_t type;
+
+    /* Selecting either the type or the value field selects the union. */
+    if (!field_selected(td->mask, id) && !field_selected(td->mask, id - 1)) {
+        return flatcc_verify_ok;
+    }
+    check_result(verify_union_type(td, id, required, &type));
+    return type ? uvf(td, id, type) : flatcc_verify_ok;
+}
+
+int flatcc_verify_union_table(flatcc_table_verifier_descriptor_t *td,
+        voffset_t id, flatcc_table_verifier_f tvf)
+{
+    uoffset_t base;
+
+    check_field(td, id, 0, base);
+    return verify_table(td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, tvf, td->memo, td->parallel, child_mask(td, id), td->flags);
+}
+
+/*
+ * Table driven verification. Each frame is a table being verified,
+ * with the next field spec to check, and the remaining elements if
+ * that field was a table vector. A frame is pushed where the generated
+ * verifier would recurse, and the nesting limit bounds the stack at
+ * `FLATCC_VERIFIER_MAX_LEVELS` frames.
+ */
+typedef struct spec_frame spec_frame_t;
+struct spec_frame {
+    flatcc_table_verifier_descriptor_t td;
+    const flatcc_verify_table_spec_t *spec;
+    size_t field;
+    /* Table vector elements not yet verified. */
+    uoffset_t count;
+    uoffset_t elem;
+    int elem_ttl;
+    const flatcc_verify_table_spec_t *elem_spec;
+};
+
+static int push_spec_frame(spec_frame_t *stack, int *sp, const void *buf, uoffset_t end,
+        uoffset_t base, uoffset_t offset, int ttl, const flatcc_verify_table_spec_t *spec)
+{
+    spec_frame_t *f = stack + *sp;
+
+    verify((f->td.ttl = ttl - 1) > 0, flatcc_verify_error_max_nesting_level_reached);
+    verify(check_header(end, base, offset), flatcc_verify_error_table_header_out_of_range_or_unaligned);
+    f->td.table = base + offset;
+    check_result(verify_table_header(&f->td, buf, end));
+    f->td.memo = 0;
+    f->td.parallel = 0;
+    f->td.mask = 0;
+    f->td.flags = 0;
+    f->spec = spec;
+    f->field = 0;
+    f->count = 0;
+    ++*sp;
+    return flatcc_verify_ok;
+}
+
+static int verify_spec_field(spec_frame_t *stack, int *sp, const flatcc_verify_field_spec_t *fs)
+{
+    spec_frame_t *f = stack + *sp - 1;
+    flatcc_table_verifier_descriptor_t *td = &f->td;
+    const flatcc_verify_union_spec_t *us;
+    const uoffset_t *nested;
+    uoffset_t base, nested_size;
+    uint8_t type;
+
+    switch (fs->kind) {
+    case flatcc_verify_spec_field:
+        return verify_field(td, fs->id, 0, fs->align, fs->size);
+    case flatcc_verify_spec_string:
+        return flatcc_verify_string_field(td, fs->id, fs->required);
+    case flatcc_verify_spec_vector:
+        return flatcc_verify_vector_field(td, fs->id, fs->required, fs->align, fs->size,
+                fs->size ? FLATBUFFERS_COUNT_MAX(fs->size) : FLATBUFFERS_UOFFSET_MAX);
+    case flatcc_verify_spec_string_vector:
+        return flatcc_verify_string_vector_field(td, fs->id, fs->required);
+    case flatcc_verify_spec_nested_struct:
+        return flatcc_verify_struct_as_nested_root(td, fs->id, fs->required, 0, fs->align, fs->size);
+    case flatcc_verify_spec_table:
+        check_field(td, fs->id, fs->required, base);
+        return push_spec_frame(stack, sp, td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, fs->child);
+    case flatcc_verify_spec_table_vector:
+        check_field(td, fs->id, fs->required, base);
+        verify(td->ttl > 0, flatcc_verify_error_max_nesting_level_reached);
+        check_result(verify_vector(td->buf, td->end, base, read_uoffset(td->buf, base),
+                offset_size, offset_size, FLATBUFFERS_COUNT_MAX(offset_size)));
+        base += read_uoffset(td->buf, base);
+        f->count = read_uoffset(td->buf, base);
+        f->elem = base + offset_size;
+        f->elem_ttl = td->ttl - 1;
+        f->elem_spec = fs->child;
+        return flatcc_verify_ok;
+    case flatcc_verify_spec_union:
+        check_result(verify_union_type(td, fs->id, fs->required, &type));
+        us = fs->child;
+        if (type >= us->count || !us->members[type]) {
+            return flatcc_verify_ok;
+        }
+        check_field(td, fs->id, 0, base);
+        return push_spec_frame(stack, sp, td->buf, td->end, base, read_uoffset(td->buf, base), td->ttl, us->members[type]);
+    case flatcc_verify_spec_nested_table:
+        check_result(get_nested_buffer(td, fs->id, fs->required, fs->align, &nested, &nested_size));
+        if (!nested) {
+            return flatcc_verify_ok;
+        }
+        check_result(flatcc_verify_buffer_header(nested, nested_size, 0));
+        return push_spec_frame(stack, sp, nested, nested_size, 0, read_uoffset(nested, 0), td->ttl, fs->child);
+    default:
+        return flatcc_verify_error_not_supported;
+    }
+}
+
+int flatcc_verify_table_as_root_with_spec(const void *buf, size_t bufsiz, const char *fid,
+        const flatcc_verify_table_spec_t *spec)
+{
+    spec_frame_t stack[FLATCC_VERIFIER_MAX_LEVELS], *f;
+    int sp = 0;
+    uoffset_t base;
+
+    check_result(flatcc_verify_buffer_header(buf, (uoffset_t)bufsiz, fid));
+    check_result(push_spec_frame(stack, &sp, buf, (uoffset_t)bufsiz, 0, read_uoffset(buf, 0),
+            FLATCC_VERIFIER_MAX_LEVELS, spec));
+    while (sp > 0) {
+        f = stack + sp - 1;
+        if (f->count) {
+            --f->count;
+            base = f->elem;
+            f->elem += offset_size;
+            check_result(push_spec_frame(stack, &sp, f->td.buf, f->td.end, base,
+                    read_uoffset(f->td.buf, base), f->elem_ttl, f->elem_spec));
+        } else if (f->field < f->spec->count) {
+            check_result(verify_spec_field(stack, &sp, f->spec->fields + f->field++));
+        } else {
+            --sp;
+        }
+    }
+    return flatcc_verify_ok;
 }
@@ -0,0 +1,262 @@
+/*
+ * Background writer thread emitter, see `flatcc_writer_emitter.h`.
+ *
+ * Requires POSIX `pwrite` and pthreads.
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_writer_emitter.h"
+
+#define ring_slot(E, i) ((E)->ring[(i) % FLATCC_WRITER_EMITTER_RING_SIZE])
+
+static int write_at(flatcc_writer_emitter_t *E, const uint8_t *data, size_t size, flatbuffers_soffset_t offset)
+{
+    off_t pos = E->origin + (off_t)offset;
+    ssize_t n;
+
+    if (pos < 0) {
+        /* The front of the buffer grew beyond the reserved origin. */
+        return -1;
+    }
+    while (size) {
+        n = pwrite(E->fd, data, size, pos);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        size -= (size_t)n;
+        pos += n;
+    }
+    return 0;
+}
+
+static void *writer_thread(void *arg)
+{
+    flatcc_writer_emitter_t *E = arg;
+    flatcc_emitter_page_t *p;
+    int error;
+
+    pthread_mutex_lock(&E->lock);
+    for (;;) {
+        while (E->written == E->queued && !E->stop) {
+            pthread_cond_wait(&E->queue_cond, &E->lock);
+        }
+        if (E->written == E->queued) {
+            break;
+        }
+        p = ring_slot(E, E->written);
+        error = E->error;
+        /* Completed pages are not modified until recycled. */
+        pthread_mutex_unlock(&E->lock);
+        if (!error) {
+            error = write_at(E, p->page, p->page_size, p->page_offset);
+        }
+        pthread_mutex_lock(&E->lock);
+        if (error) {
+            E->error = 1;
+        }
+        ++E->written;
+        pthread_cond_signal(&E->written_cond);
+    }
+    pthread_mutex_unlock(&E->lock);
+    return 0;
+}
+
+/* Returns pages that have been written to the emitter for reuse. */
+static void recycle_written(flatcc_writer_emitter_t *E, size_t written)
+{
+    while (E->recycled != written) {
+        flatcc_emitter_recycle_page(&E->emitter, ring_slot(E, E->recycled));
+        ++E->recycled;
+    }
+}
+
+/* Waits until at most `max_pending` pages are queued or being written. */
+static int wait_written(flatcc_writer_emitter_t *E, size_t max_pending)
+{
+    size_t written;
+    int error;
+
+    pthread_mutex_lock(&E->lock);
+    while (E->queued - E->written > max_pending) {
+        pthread_cond_wait(&E->written_cond, &E->lock);
+    }
+    written = E->written;
+    error = E->error;
+    pthread_mutex_unlock(&E->lock);
+    recycle_written(E, written);
+    return error ? -1 : 0;
+}
+
+static int queue_page(flatcc_writer_emitter_t *E, flatcc_emitter_page_t *p)
+{
+    if (E->queued - E->recycled == FLATCC_WRITER_EMITTER_RING_SIZE) {
+        if (wait_written(E, FLATCC_WRITER_EMITTER_RING_SIZE - 1)) {
+            return -1;
+        }
+    }
+    pthread_mutex_lock(&E->lock);
+    ring_slot(E, E->queued) = p;
+    ++E->queued;
+    pthread_cond_signal(&E->queue_cond);
+    pthread_mutex_unlock(&E->lock);
+    return 0;
+}
+
+/*
+ * A page is complete when both front and back have moved past it.
+ * Front pages complete from the top of the buffer down, back pages from
+ * the bottom up, and the first page, which is shared between front and
+ * back, completes when the last of the two leaves it. Both marks start
+ * on the first page so neither walk crosses into the other side.
+ * Recycled pages are relinked outside the range between front and
+ * back, so walking from the current front or back towards the
+ * previously seen one only visits pages that completed since the last
+ * call.
+ */
+static int queue_completed(flatcc_writer_emitter_t *E)
+{
+    flatcc_emitter_t *em = &E->emitter;
+    flatcc_emitter_page_t *p, *next;
+
+    /* Queueing may recycle earlier pages, so links are read first. */
+    if (em->front != E->front_mark) {
+        for (p = em->front->next; p != em->back; p = next) {
+            next = p->next;
+            if (queue_page(E, p)) {
+                return -1;
+            }
+            if (p == E->front_mark) {
+                break;
+            }
+        }
+        E->front_mark = em->front;
+    }
+    if (em->back != E->back_mark) {
+        for (p = em->back->prev; p != em->front; p = next) {
+            next = p->prev;
+            if (queue_page(E, p)) {
+                return -1;
+            }
+            if (p == E->back_mark) {
+                break;
+            }
+        }
+        E->back_mark = em->back;
+    }
+    return 0;
+}
+
+int flatcc_writer_emitter_init(flatcc_writer_emitter_t *E, int fd, off_t origin)
+{
+    memset(E, 0, sizeof(*E));
+    E->fd = fd;
+    E->origin = origin;
+    if (pthread_mutex_init(&E->lock, 0)) {
+        return -1;
+    }
+    if (pthread_cond_init(&E->queue_cond, 0)) {
+        goto fail_queue_cond;
+    }
+    if (pthread_cond_init(&E->written_cond, 0)) {
+        goto fail_written_cond;
+    }
+    if (pthread_create(&E->thread, 0, writer_thread, E)) {
+        goto fail_thread;
+    }
+    return 0;
+fail_thread:
+    pthread_cond_destroy(&E->written_cond);
+fail_written_cond:
+    pthread_cond_destroy(&E->queue_cond);
+fail_queue_cond:
+    pthread_mutex_destroy(&E->lock);
+    return -1;
+}
+
+void flatcc_writer_emitter_reset(flatcc_writer_emitter_t *E, off_t origin)
+{
+    wait_written(E, 0);
+    flatcc_emitter_reset(&E->emitter);
+    pthread_mutex_lock(&E->lock);
+    E->queued = 0;
+    E->written = 0;
+    E->error = 0;
+    pthread_mutex_unlock(&E->lock);
+    E->recycled = 0;
+    E->front_mark = 0;
+    E->back_mark = 0;
+    E->origin = origin;
+}
+
+void flatcc_writer_emitter_clear(flatcc_writer_emitter_t *E)
+{
+    pthread_mutex_lock(&E->lock);
+    E->stop = 1;
+    pthread_cond_signal(&E->queue_cond);
+    pthread_mutex_unlock(&E->lock);
+    pthread_join(E->thread, 0);
+    pthread_cond_destroy(&E->written_cond);
+    pthread_cond_destroy(&E->queue_cond);
+    pthread_mutex_destroy(&E->lock);
+    flatcc_emitter_clear(&E->emitter);
+}
+
+int flatcc_writer_emitter_finalize(flatcc_writer_emitter_t *E, off_t *offset_out, size_t *size_out)
+{
+    flatcc_emitter_t *em = &E->emitter;
+    flatbuffers_soffset_t start = 0;
+    int ret;
+
+    ret = wait_written(E, 0);
+    if (!ret && em->front) {
+        start = em->front->page_offset + (flatbuffers_soffset_t)(em->front_cursor - em->front->page);
+        if (em->front == em->back) {
+            ret = write_at(E, em->front_cursor, (size_t)(em->back_cursor - em->front_cursor), start);
+        } else {
+            ret = write_at(E, em->front_cursor,
+                    (size_t)(em->front->page + em->front->page_size - em->front_cursor), start);
+            ret |= write_at(E, em->back->page,
+                    (size_t)(em->back_cursor - em->back->page), em->back->page_offset);
+        }
+    }
+    if (offset_out) {
+        *offset_out = ret ? 0 : E->origin + (off_t)start;
+    }
+    if (size_out) {
+        *size_out = ret ? 0 : em->used;
+    }
+    return ret ? -1 : 0;
+}
+
+int flatcc_writer_emitter(void *emit_context,
+        const flatcc_iovec_t *iov, int iov_count,
+        flatbuffers_soffset_t offset, size_t len)
+{
+    flatcc_writer_emitter_t *E = emit_context;
+
+    if (flatcc_emitter(&E->emitter, iov, iov_count, offset, len)) {
+        return -1;
+    }
+    if (!E->front_mark) {
+        /*
+         * A call only moves one side, so the other is still on the
+         * first page which may just have been created.
+         */
+        E->front_mark = offset < 0 ? E->emitter.back : E->emitter.front;
+        E->back_mark = E->front_mark;
+    }
+    return queue_completed(E);
+}
@@ -0,0 +1,136 @@
+/*
+ * Times buffer verification on the flatbench and monster schemas. The
+ * same source is compiled against verifiers generated as functions and
+ * as field specs (flatcc --verifier-specs), see run.sh.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "flatbench_builder.h"
+#include "flatbench_verifier.h"
+#include "monster_test_builder.h"
+#include "monster_test_verifier.h"
+#include "flatcc/support/elapsed.h"
+
+#ifndef VERIFIER_MODE
+#define VERIFIER_MODE "functions"
+#endif
+
+#ifdef NDEBUG
+#define COMPILE_TYPE "(optimized)"
+#else
+#define COMPILE_TYPE "(debug)"
+#endif
+
+#define C(x) FLATBUFFERS_WRAP_NAMESPACE(benchfb_FooBarContainer, x)
+#define FooBar(x) FLATBUFFERS_WRAP_NAMESPACE(benchfb_FooBar, x)
+#define Enum(x) FLATBUFFERS_WRAP_NAMESPACE(benchfb_Enum, x)
+#define M(x) FLATBUFFERS_WRAP_NAMESPACE(MyGame_Example_Monster, x)
+
+static void encode_flatbench(flatcc_builder_t *B)
+{
+    int i;
+
+    C(start_as_root(B));
+    C(list_start(B));
+    for (i = 0; i < 3; ++i) {
+        C(list_push_start(B));
+        FooBar(sibling_create(B,
+                0xABADCAFEABADCAFE + i, 10000 + i, '@' + i, 1000000 + i,
+                123456 + i, 3.14159f + i, 10000 + i));
+        FooBar(name_create_str(B, "Hello, World!"));
+        FooBar(rating_add(B, 3.1415432432445543543 + i));
+        FooBar(postfix_add(B, '!' + i));
+        C(list_push_end(B));
+    }
+    C(list_end(B));
+    C(location_create_str(B, "https://www.example.com/myurl/"));
+    C(fruit_add(B, Enum(Bananas)));
+    C(initialized_add(B, flatbuffers_true));
+    C(end_as_root(B));
+}
+
+static void encode_monster(flatcc_builder_t *B)
+{
+    static uint8_t inventory[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    int i;
+
+    M(start_as_root(B));
+    M(name_create_str(B, "MyMonster"));
+    M(hp_add(B, 80));
+    M(inventory_create(B, inventory, sizeof(inventory)));
+    M(testarrayofstring_start(B));
+    M(testarrayofstring_push_create_str(B, "Hello"));
+    M(testarrayofstring_push_create_str(B, "world!"));
+    M(testarrayofstring_end(B));
+    M(testarrayoftables_start(B));
+    for (i = 0; i < 10; ++i) {
+        M(testarrayoftables_push_start(B));
+        M(name_create_str(B, "Joker"));
+        M(hp_add(B, (int16_t)i));
+        M(testarrayoftables_push_end(B));
+    }
+    M(testarrayoftables_end(B));
+    M(enemy_start(B));
+    M(name_create_str(B, "the enemy"));
+    M(enemy_end(B));
+    M(testempty_start(B));
+    M(testempty_end(B));
+    M(end_as_root(B));
+}
+
+static int bench(const char *title, void *buffer, size_t size,
+        int (*verify)(const void *, size_t), int rep)
+{
+    double t1, t2;
+    int i, ret = 0;
+
+    t1 = elapsed_realtime();
+    for (i = 0; i < rep; ++i) {
+        ret |= verify(buffer, size);
+    }
+    t2 = elapsed_realtime();
+    if (ret) {
+        printf("ABORT ON VERIFICATION FAILURE\n");
+        return -1;
+    }
+    printf("----\n");
+    show_benchmark(title, t1, t2, size, rep, "1M");
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    flatcc_builder_t builder, *B = &builder;
+    void *buffer;
+    size_t size;
+    int ret = -1, rep = 1000000;
+
+    (void)argc;
+    (void)argv;
+
+    flatcc_builder_init(B);
+    encode_flatbench(B);
+    if (!(buffer = flatcc_builder_finalize_aligned_buffer(B, &size))) {
+        goto done;
+    }
+    ret = bench("flatbench verify, " VERIFIER_MODE " " COMPILE_TYPE,
+            buffer, size, benchfb_FooBarContainer_verify_as_root, rep);
+    flatcc_builder_aligned_free(buffer);
+    if (ret) {
+        goto done;
+    }
+    flatcc_builder_reset(B);
+    encode_monster(B);
+    if (!(buffer = flatcc_builder_finalize_aligned_buffer(B, &size))) {
+        ret = -1;
+        goto done;
+    }
+    ret = bench("monster verify, " VERIFIER_MODE " " COMPILE_TYPE,
+            buffer, size, MyGame_Example_Monster_verify_as_root, rep);
+    flatcc_builder_aligned_free(buffer);
+    printf("----\n");
+done:
+    flatcc_builder_clear(B);
+    return ret;
+}
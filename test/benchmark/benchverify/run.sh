@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+
+set -e
+cd `dirname $0`/../../..
+ROOT=`pwd`
+TMP=build/tmp/test/benchmark/benchverify
+${ROOT}/scripts/build.sh
+mkdir -p ${TMP}/functions ${TMP}/specs
+rm -rf ${TMP}/functions/* ${TMP}/specs/*
+
+for schema in test/benchmark/schema/flatbench.fbs test/monster_test/monster_test.fbs; do
+    bin/flatcc -a -o ${TMP}/functions $schema
+    bin/flatcc -a --verifier-specs -o ${TMP}/specs $schema
+done
+
+CC=${CC:-cc}
+cp test/benchmark/benchverify/benchverify.c ${TMP}
+cd ${TMP}
+for mode in functions specs; do
+    $CC -O3 -DNDEBUG -std=c11 -I ${ROOT}/include -I $mode \
+        -DVERIFIER_MODE=\"$mode\" benchverify.c \
+        ${ROOT}/lib/libflatccrt.a -o benchverify_$mode
+    echo "verifier code size with $mode:"
+    $CC -O3 -DNDEBUG -std=c11 -I ${ROOT}/include -I $mode -c \
+        -x c - -o verifier_$mode.o <<EOT
+#include "monster_test_verifier.h"
+#include "flatbench_verifier.h"
+int (*verifiers[])(const void *, size_t) = {
+    MyGame_Example_Monster_verify_as_root, benchfb_FooBarContainer_verify_as_root
+};
+EOT
+    size verifier_$mode.o
+done
+for mode in functions specs; do
+    echo "running verifier benchmark with $mode (optimized)"
+    ./benchverify_$mode
+done
@@ -1,6 +1,18 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define TEST_FD_EMITTER 1
+#include <unistd.h>
+#include <pthread.h>
+#include "flatcc/flatcc_fd_emitter.h"
+#include "flatcc/flatcc_writer_emitter.h"
+#include "flatcc/flatcc_mmap_emitter.h"
+#include <sys/stat.h>
+#endif
+
 #include <stdio.h>
 #include <assert.h>
 #include "emit_test_builder.h"
+#include "flatcc/flatcc_rtconfig.h"
 #include "flatcc/support/hexdump.h"
 
 #define test_assert(x) do { if (!(x)) { assert(0); return -1; }} while(0)
@@ -110,6 +122,551 @@ int emit_test()
     return 0;
 }
 
+/*
+ * Gathers the iov export of a multi-page buffer and compares it to the
+ * finalized copy.
+ */
+int iov_test()
+{
+    const size_t count = 10000;
+    flatcc_builder_t builder, *B;
+    flatcc_iovec_t *iov;
+    uint8_t *expect, *buf, *p;
+    size_t size, i;
+    int n, k;
+    float *v;
+    int ret = -1;
+
+    B = &builder;
+    flatcc_builder_init(B);
+    main_start_as_root(B);
+    main_time_add(B, 42);
+    main_samples_start(B);
+    v = flatbuffers_float_vec_extend(B, count);
+    test_assert(v);
+    for (i = 0; i < count; ++i) {
+        v[i] = (float)i;
+    }
+    main_samples_end(B);
+    test_assert(main_end_as_root(B));
+
+    expect = flatcc_builder_finalize_buffer(B, &size);
+    test_assert(expect);
+    n = flatcc_builder_get_buffer_iov(B, 0, 0);
+    iov = malloc(sizeof(*iov) * (size_t)n);
+    buf = malloc(size);
+    if (n < 2 || !iov || !buf) {
+        goto done;
+    }
+    if (flatcc_builder_get_buffer_iov(B, iov, n - 1) != -1) {
+        goto done;
+    }
+    if (flatcc_builder_get_buffer_iov(B, iov, n) != n) {
+        goto done;
+    }
+    for (p = buf, k = 0; k < n; ++k) {
+        if ((size_t)(p - buf) + iov[k].iov_len > size) {
+            goto done;
+        }
+        memcpy(p, iov[k].iov_base, iov[k].iov_len);
+        p += iov[k].iov_len;
+    }
+    if ((size_t)(p - buf) == size && 0 == memcmp(buf, expect, size)) {
+        ret = 0;
+    }
+done:
+    free(iov);
+    free(buf);
+    free(expect);
+    flatcc_builder_clear(B);
+    test_assert(ret == 0);
+    return ret;
+}
+
+static int build_sample_buffer(flatcc_builder_t *B, size_t count)
+{
+    float *v;
+    size_t i;
+
+    flatcc_builder_reset(B);
+    main_start_as_root(B);
+    main_time_add(B, 42);
+    main_samples_start(B);
+    if (!(v = flatbuffers_float_vec_extend(B, count))) {
+        return -1;
+    }
+    for (i = 0; i < count; ++i) {
+        v[i] = (float)i;
+    }
+    main_samples_end(B);
+    return main_end_as_root(B) ? 0 : -1;
+}
+
+/*
+ * Runtime page sizes: a fixed large page holds a buffer that needs many
+ * default pages, and adaptive pages grow geometrically within a buffer
+ * and shrink again for small buffers after a few resets.
+ */
+int page_size_test()
+{
+    flatcc_builder_t builder, *B;
+    flatcc_emitter_t *E;
+    main_table_t mt;
+    void *buf;
+    size_t size;
+    int i, n;
+
+    B = &builder;
+    flatcc_builder_init(B);
+    E = flatcc_builder_get_emit_context(B);
+
+    flatcc_emitter_set_page_size(E, 100000);
+    test_assert(0 == build_sample_buffer(B, 10000));
+    test_assert(flatcc_builder_get_buffer_iov(B, 0, 0) == 1);
+    test_assert((buf = flatcc_builder_get_direct_buffer(B, &size)));
+    mt = main_as_root(buf);
+    test_assert(flatbuffers_float_vec_at(main_samples(mt), 9999) == 9999.0f);
+    flatcc_builder_clear(B);
+
+    flatcc_builder_init(B);
+    E = flatcc_builder_get_emit_context(B);
+    flatcc_emitter_set_adaptive_page_size(E, 1024, 1 << 20);
+    test_assert(0 == build_sample_buffer(B, 100000));
+    n = flatcc_builder_get_buffer_iov(B, 0, 0);
+    /* 400KB from 1KB pages doubling in capacity. */
+    test_assert(n > 1 && n <= 12);
+    buf = flatcc_builder_finalize_buffer(B, &size);
+    test_assert(buf);
+    mt = main_as_root(buf);
+    test_assert(flatbuffers_float_vec_at(main_samples(mt), 99999) == 99999.0f);
+    free(buf);
+    for (i = 0; i < 40; ++i) {
+        test_assert(0 == build_sample_buffer(B, 10));
+    }
+    test_assert(flatcc_builder_get_direct_buffer(B, &size));
+    test_assert(E->front->page_size < 4096);
+    flatcc_builder_clear(B);
+    return 0;
+}
+
+/*
+ * Two builders share a page pool: pages released by one builder are
+ * reused by the other, and nothing is in use once both are cleared.
+ */
+int pool_test()
+{
+    flatcc_builder_t builder1, builder2, *B1, *B2;
+    flatcc_emitter_pool_t *pool;
+    flatcc_emitter_pool_stats_t stats;
+    flatcc_builder_stats_t builder_stats;
+    size_t allocated;
+    int i;
+
+    if (!(pool = flatcc_emitter_pool_create(4096, 0))) {
+        /* Pools are not supported by this compiler. */
+        return 0;
+    }
+    B1 = &builder1;
+    B2 = &builder2;
+    flatcc_builder_init(B1);
+    flatcc_builder_init(B2);
+    test_assert(0 == flatcc_emitter_set_pool(flatcc_builder_get_emit_context(B1), pool));
+    test_assert(0 == flatcc_emitter_set_pool(flatcc_builder_get_emit_context(B2), pool));
+
+    test_assert(0 == build_sample_buffer(B1, 20000));
+    flatcc_emitter_pool_get_stats(pool, &stats);
+    test_assert(stats.page_size == 4096);
+    test_assert(stats.pages_in_use >= 20);
+    flatcc_builder_clear(B1);
+    flatcc_emitter_pool_get_stats(pool, &stats);
+    test_assert(stats.pages_in_use == 0);
+    test_assert(stats.pages_cached > 0);
+    allocated = stats.pages_cached;
+
+    flatcc_builder_set_stats(B2, 1);
+    for (i = 0; i < 10; ++i) {
+        test_assert(0 == build_sample_buffer(B2, 10000));
+        test_assert(flatcc_builder_get_buffer_size(B2) > 40000);
+    }
+    /* Pages taken from the pool are not counted as allocated. */
+    flatcc_builder_get_stats(B2, &builder_stats);
+    test_assert(!FLATCC_BUILDER_STATS || (builder_stats.emitter_pages_allocated == 0 &&
+            builder_stats.emitter_pages_recycled > 0));
+    flatcc_builder_clear(B2);
+    flatcc_emitter_pool_get_stats(pool, &stats);
+    test_assert(stats.pages_in_use == 0);
+    /* The second builder only needed half as many pages. */
+    test_assert(stats.pages_cached == allocated);
+
+    flatcc_emitter_pool_trim(pool, 0);
+    flatcc_emitter_pool_get_stats(pool, &stats);
+    test_assert(stats.pages_cached == 0);
+    flatcc_emitter_pool_destroy(pool);
+    return 0;
+}
+
+#if TEST_FD_EMITTER
+
+/* Builds a root with `count` float samples. */
+static int build_samples(flatcc_builder_t *B, size_t count)
+{
+    float *v;
+    size_t i;
+
+    main_start_as_root(B);
+    main_time_add(B, 42);
+    main_device_add(B, 1);
+    main_samples_start(B);
+    if (!(v = flatbuffers_float_vec_extend(B, count))) {
+        return -1;
+    }
+    for (i = 0; i < count; ++i) {
+        v[i] = (float)i;
+    }
+    main_samples_end(B);
+    return main_end_as_root(B) ? 0 : -1;
+}
+
+/*
+ * Builds a buffer larger than several staging pages with the file
+ * descriptor emitter and compares the file content with the same
+ * buffer built by the default emitter.
+ */
+int fd_emitter_test()
+{
+    const size_t count = 10000;
+    flatcc_builder_t builder, *B;
+    flatcc_fd_emitter_t E;
+    FILE *fp;
+    void *expect, *buf;
+    size_t expect_size, size;
+    off_t offset;
+    main_table_t mt;
+    int ret = -1;
+
+    B = &builder;
+    flatcc_builder_init(B);
+    test_assert(0 == build_samples(B, count));
+    expect = flatcc_builder_finalize_buffer(B, &expect_size);
+    flatcc_builder_clear(B);
+    test_assert(expect);
+
+    if (!(fp = tmpfile())) {
+        free(expect);
+        return -1;
+    }
+    /* Small pages to exercise page flushing. */
+    flatcc_fd_emitter_init(&E, fileno(fp), 1 << 20, 256);
+    flatcc_builder_custom_init(B, flatcc_fd_emitter, &E, 0, 0);
+    if (build_samples(B, count)) {
+        goto done;
+    }
+    if (flatcc_fd_emitter_finalize(&E, &offset, &size)) {
+        goto done;
+    }
+    if (size != expect_size || size != flatcc_builder_get_buffer_size(B)) {
+        goto done;
+    }
+    if (!(buf = malloc(size))) {
+        goto done;
+    }
+    if (pread(fileno(fp), buf, size, offset) == (ssize_t)size &&
+            0 == memcmp(buf, expect, size)) {
+        mt = main_as_root(buf);
+        if (main_time(mt) == 42 &&
+                flatbuffers_float_vec_len(main_samples(mt)) == count &&
+                flatbuffers_float_vec_at(main_samples(mt), count - 1) == (float)(count - 1)) {
+            ret = 0;
+        }
+    }
+    free(buf);
+done:
+    flatcc_builder_clear(B);
+    flatcc_fd_emitter_clear(&E);
+    fclose(fp);
+    free(expect);
+    test_assert(ret == 0);
+    return ret;
+}
+
+/*
+ * Builds two buffers with small pages through the background writer so
+ * the page ring fills up and pages are recycled, and compares the file
+ * content with the same buffer built by the default emitter.
+ */
+int writer_emitter_test()
+{
+    const size_t count = 10000;
+    flatcc_builder_t builder, *B;
+    flatcc_writer_emitter_t E;
+    FILE *fp;
+    void *expect, *buf = 0;
+    size_t expect_size, size;
+    off_t offset, origin = 1 << 20;
+    int i, ret = -1;
+
+    B = &builder;
+    flatcc_builder_init(B);
+    test_assert(0 == build_samples(B, count));
+    expect = flatcc_builder_finalize_buffer(B, &expect_size);
+    flatcc_builder_clear(B);
+    test_assert(expect);
+
+    if (!(fp = tmpfile())) {
+        free(expect);
+        return -1;
+    }
+    if (flatcc_writer_emitter_init(&E, fileno(fp), origin)) {
+        fclose(fp);
+        free(expect);
+        return -1;
+    }
+    flatcc_emitter_set_page_size(&E.emitter, 256);
+    flatcc_builder_custom_init(B, flatcc_writer_emitter, &E, 0, 0);
+    if (!(buf = malloc(expect_size))) {
+        goto done;
+    }
+    for (i = 0; i < 2; ++i) {
+        if (i > 0) {
+            origin *= 2;
+            flatcc_builder_reset(B);
+            flatcc_writer_emitter_reset(&E, origin);
+        }
+        if (build_samples(B, count)) {
+            goto done;
+        }
+        if (flatcc_writer_emitter_finalize(&E, &offset, &size)) {
+            goto done;
+        }
+        if (size != expect_size || offset >= origin) {
+            goto done;
+        }
+        if (pread(fileno(fp), buf, size, offset) != (ssize_t)size ||
+                0 != memcmp(buf, expect, size)) {
+            goto done;
+        }
+    }
+    ret = 0;
+done:
+    free(buf);
+    flatcc_builder_clear(B);
+    flatcc_writer_emitter_clear(&E);
+    fclose(fp);
+    free(expect);
+    test_assert(ret == 0);
+    return ret;
+}
+
+/*
+ * The first emission is a vector spanning many small pages. Every full
+ * page must be queued for the writer exactly once, so the pages queued
+ * cannot hold more than the buffer.
+ */
+int writer_emitter_first_emission_test()
+{
+    const size_t count = 1250;
+    const size_t page_size = 256;
+    flatcc_builder_t builder, *B;
+    flatcc_writer_emitter_t E;
+    FILE *fp;
+    void *expect, *buf = 0;
+    size_t expect_size, size;
+    off_t offset;
+    int ret = -1;
+
+    B = &builder;
+    flatcc_builder_init(B);
+    test_assert(0 == build_samples(B, count));
+    expect = flatcc_builder_finalize_buffer(B, &expect_size);
+    flatcc_builder_clear(B);
+    test_assert(expect);
+
+    if (!(fp = tmpfile())) {
+        free(expect);
+        return -1;
+    }
+    if (flatcc_writer_emitter_init(&E, fileno(fp), 1 << 20)) {
+        fclose(fp);
+        free(expect);
+        return -1;
+    }
+    flatcc_emitter_set_page_size(&E.emitter, page_size);
+    flatcc_builder_custom_init(B, flatcc_writer_emitter, &E, 0, 0);
+    if (build_samples(B, count)) {
+        goto done;
+    }
+    if (flatcc_writer_emitter_finalize(&E, &offset, &size)) {
+        goto done;
+    }
+    if (size != expect_size || E.queued * page_size > size ||
+            E.queued + 2 < size / page_size) {
+        goto done;
+    }
+    if (!(buf = malloc(size))) {
+        goto done;
+    }
+    if (pread(fileno(fp), buf, size, offset) == (ssize_t)size &&
+            0 == memcmp(buf, expect, size)) {
+        ret = 0;
+    }
+done:
+    free(buf);
+    flatcc_builder_clear(B);
+    flatcc_writer_emitter_clear(&E);
+    fclose(fp);
+    free(expect);
+    test_assert(ret == 0);
+    return ret;
+}
+
+#define POOL_STRESS_THREADS 4
+#define POOL_STRESS_MAX_CACHED 64
+
+typedef struct pool_stress pool_stress_t;
+struct pool_stress {
+    flatcc_emitter_pool_t *pool;
+    pthread_mutex_t lock;
+    int running;
+};
+
+static void *pool_stress_worker(void *arg)
+{
+    pool_stress_t *ps = arg;
+    flatcc_builder_t builder, *B = &builder;
+    void *ret = 0;
+    int i;
+
+    for (i = 0; i < 2000 && !ret; ++i) {
+        flatcc_builder_init(B);
+        if (flatcc_emitter_set_pool(flatcc_builder_get_emit_context(B), ps->pool) ||
+                build_sample_buffer(B, 1000 + (size_t)i % 7 * 500)) {
+            ret = (void *)1;
+        }
+        /* Returns all pages to the pool. */
+        flatcc_builder_clear(B);
+    }
+    pthread_mutex_lock(&ps->lock);
+    --ps->running;
+    pthread_mutex_unlock(&ps->lock);
+    return ret;
+}
+
+/*
+ * Threads sharing a pool allocate and return pages concurrently while
+ * the counters are sampled: the freelist never appears to exceed its
+ * limit, and nothing is in use once all threads are done.
+ */
+int pool_thread_test()
+{
+    pthread_t threads[POOL_STRESS_THREADS];
+    flatcc_emitter_pool_t *pool;
+    flatcc_emitter_pool_stats_t stats;
+    pool_stress_t ps;
+    void *result;
+    int i, started, running, ret = 0;
+
+    if (!(pool = flatcc_emitter_pool_create(256, POOL_STRESS_MAX_CACHED))) {
+        return 0;
+    }
+    ps.pool = pool;
+    ps.running = POOL_STRESS_THREADS;
+    pthread_mutex_init(&ps.lock, 0);
+    for (started = 0; started < POOL_STRESS_THREADS; ++started) {
+        if (pthread_create(&threads[started], 0, pool_stress_worker, &ps)) {
+            pthread_mutex_lock(&ps.lock);
+            ps.running -= POOL_STRESS_THREADS - started;
+            pthread_mutex_unlock(&ps.lock);
+            ret = -1;
+            break;
+        }
+    }
+    do {
+        flatcc_emitter_pool_get_stats(pool, &stats);
+        if (stats.pages_cached > POOL_STRESS_MAX_CACHED) {
+            ret = -1;
+        }
+        pthread_mutex_lock(&ps.lock);
+        running = ps.running;
+        pthread_mutex_unlock(&ps.lock);
+    } while (running > 0);
+    for (i = 0; i < started; ++i) {
+        pthread_join(threads[i], &result);
+        if (result) {
+            ret = -1;
+        }
+    }
+    flatcc_emitter_pool_get_stats(pool, &stats);
+    if (stats.pages_in_use != 0 || stats.pages_cached > POOL_STRESS_MAX_CACHED) {
+        ret = -1;
+    }
+    flatcc_emitter_pool_destroy(pool);
+    pthread_mutex_destroy(&ps.lock);
+    test_assert(ret == 0);
+    return ret;
+}
+
+/*
+ * Builds a buffer in a minimal mapped reservation so the mapping must
+ * grow several times, and checks the finalized mapping and the
+ * truncated file.
+ */
+int mmap_emitter_test()
+{
+    const size_t count = 10000;
+    flatcc_builder_t builder, *B;
+    flatcc_mmap_emitter_t E;
+    FILE *fp;
+    void *expect, *buf;
+    size_t expect_size, size;
+    struct stat st;
+    main_table_t mt;
+    int ret = -1;
+
+    B = &builder;
+    flatcc_builder_init(B);
+    test_assert(0 == build_samples(B, count));
+    expect = flatcc_builder_finalize_buffer(B, &expect_size);
+    flatcc_builder_clear(B);
+    test_assert(expect);
+
+    if (!(fp = tmpfile())) {
+        free(expect);
+        return -1;
+    }
+    if (flatcc_mmap_emitter_init(&E, fileno(fp), 1)) {
+        fclose(fp);
+        free(expect);
+        return -1;
+    }
+    flatcc_builder_custom_init(B, flatcc_mmap_emitter, &E, 0, 0);
+    if (build_samples(B, count)) {
+        goto done;
+    }
+    if (!(buf = flatcc_mmap_emitter_finalize(&E, &size))) {
+        goto done;
+    }
+    if (size != expect_size || 0 != memcmp(buf, expect, size)) {
+        goto done;
+    }
+    mt = main_as_root(buf);
+    if (main_time(mt) != 42 || flatbuffers_float_vec_len(main_samples(mt)) != count) {
+        goto done;
+    }
+    if (fstat(fileno(fp), &st) || (size_t)st.st_size != size) {
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_clear(B);
+    flatcc_mmap_emitter_clear(&E);
+    fclose(fp);
+    free(expect);
+    test_assert(ret == 0);
+    return ret;
+}
+
+#endif
+
 int main(int argc, char *argv[])
 {
     int ret = 0;
@@ -119,5 +676,15 @@ int main(int argc, char *argv[])
 
     ret |= debug_test();
     ret |= emit_test();
+    ret |= iov_test();
+    ret |= page_size_test();
+    ret |= pool_test();
+#if TEST_FD_EMITTER
+    ret |= fd_emitter_test();
+    ret |= pool_thread_test();
+    ret |= writer_emitter_test();
+    ret |= writer_emitter_first_emission_test();
+    ret |= mmap_emitter_test();
+#endif
     return ret;
 }
@@ -2,6 +2,9 @@
 
 #include "monster_test_builder.h"
 #include "monster_test_verifier.h"
+#include "flatcc/flatcc_rtconfig.h"
+#include "flatcc/flatcc_arena_alloc.h"
+#include "flatcc/flatcc_byteswap.h"
 
 #include "flatcc/support/hexdump.h"
 #include "flatcc/support/elapsed.h"
@@ -883,6 +886,200 @@ int test_monster(flatcc_builder_t *B)
     return ret;
 }
 
+int test_arena_alloc(void)
+{
+    flatcc_builder_t builder, *B = &builder;
+    flatcc_arena_alloc_t A;
+    flatcc_arena_alloc_profile_t profile;
+    void *buffer = 0, *expect = 0;
+    size_t size, expect_size;
+    int ret = -1;
+
+    /* Tiny regions overflow to the heap. */
+    memset(&profile, 0, sizeof(profile));
+    if (flatcc_arena_alloc_init(&A, &profile, 0)) {
+        printf("arena init failed\n");
+        return -1;
+    }
+    flatcc_builder_custom_init(B, 0, 0, flatcc_arena_alloc, &A);
+    gen_monster(B);
+    expect = flatcc_builder_finalize_buffer(B, &expect_size);
+    flatcc_arena_alloc_get_profile(&A, &profile);
+    flatcc_builder_clear(B);
+    flatcc_arena_alloc_clear(&A);
+
+    /* Regions sized from the first build need no reallocation. */
+    if (flatcc_arena_alloc_init(&A, &profile, flatcc_arena_alloc_mmap | flatcc_arena_alloc_hugepages)) {
+        printf("mapped arena init failed\n");
+        goto done;
+    }
+    flatcc_builder_custom_init(B, 0, 0, flatcc_arena_alloc, &A);
+    gen_monster(B);
+    flatcc_builder_reset(B);
+    gen_monster(B);
+    buffer = flatcc_builder_finalize_buffer(B, &size);
+    flatcc_builder_clear(B);
+    if (A.overflow_count != 0) {
+        printf("arena with profile was not large enough\n");
+        goto done;
+    }
+    /* Struct padding in `gen_monster` is not initialized, so compare sizes only. */
+    if (size != expect_size || verify_monster(expect)) {
+        printf("arena allocated builder produced a different buffer\n");
+        goto done;
+    }
+    ret = verify_monster(buffer);
+done:
+    flatcc_arena_alloc_clear(&A);
+    free(buffer);
+    free(expect);
+    return ret;
+}
+
+/* Always moves the vtable descriptor stack when it grows, and poisons the old copy. */
+static int moving_vd_alloc(void *alloc_context, flatcc_iovec_t *b, size_t request, int zero_fill, int alloc_type)
+{
+    flatcc_iovec_t old = *b;
+
+    if (alloc_type != flatcc_builder_alloc_vd || request <= old.iov_len) {
+        return flatcc_builder_default_alloc(alloc_context, b, request, zero_fill, alloc_type);
+    }
+    b->iov_base = 0;
+    b->iov_len = 0;
+    if (flatcc_builder_default_alloc(alloc_context, b, request, zero_fill, alloc_type)) {
+        *b = old;
+        return -1;
+    }
+    if (old.iov_base) {
+        memcpy(b->iov_base, old.iov_base, old.iov_len);
+        memset(old.iov_base, 0xff, old.iov_len);
+    }
+    return flatcc_builder_default_alloc(alloc_context, &old, 0, 0, alloc_type);
+}
+
+/* A table with only field `id`, so each id has its own vtable. */
+static flatcc_builder_ref_t create_single_field_table(flatcc_builder_t *B, int id)
+{
+    uint8_t *p;
+
+    if (flatcc_builder_start_table(B, id + 1) || !(p = flatcc_builder_table_add(B, id, 1, 1))) {
+        return 0;
+    }
+    *p = (uint8_t)id;
+    return flatcc_builder_end_table(B);
+}
+
+/*
+ * A nested buffer reuses vtables cached by the enclosing buffer, and
+ * allocates new descriptors for them while holding on to the cached
+ * ones.
+ */
+int test_vtable_reuse_across_buffers(void)
+{
+    flatcc_builder_t builder, *B = &builder;
+    flatcc_builder_ref_t refs[200];
+    const uint8_t *buffer = 0, *vec, *t, *t2, *vt;
+    size_t size;
+    int i, n = 200, ret = -1;
+
+    flatcc_builder_custom_init(B, 0, 0, moving_vd_alloc, 0);
+    if (flatcc_builder_start_buffer(B, 0, 0)) {
+        goto done;
+    }
+    for (i = 0; i < n; ++i) {
+        if (!(refs[i] = create_single_field_table(B, i))) {
+            goto done;
+        }
+    }
+    /* Each table twice, the second time from the cache of the nested buffer. */
+    if (flatcc_builder_start_buffer(B, 0, 0) || flatcc_builder_start_offset_vector(B)) {
+        goto done;
+    }
+    for (i = 0; i < 2 * n; ++i) {
+        if (!flatcc_builder_offset_vector_push(B, create_single_field_table(B, i % n))) {
+            goto done;
+        }
+    }
+    refs[0] = flatcc_builder_end_buffer(B, flatcc_builder_end_offset_vector(B));
+    if (!refs[0] || !flatcc_builder_end_buffer(B, flatcc_builder_create_offset_vector(B, refs, 1)) ||
+            !(buffer = flatcc_builder_finalize_aligned_buffer(B, &size))) {
+        printf("vtable reuse test setup failed\n");
+        goto done;
+    }
+    /* The root vector holds the nested buffer as a ubyte vector. */
+    vec = buffer + __flatbuffers_uoffset_read_from_pe(buffer) + sizeof(flatbuffers_uoffset_t);
+    vec += __flatbuffers_uoffset_read_from_pe(vec) + sizeof(flatbuffers_uoffset_t);
+    vec += __flatbuffers_uoffset_read_from_pe(vec) + sizeof(flatbuffers_uoffset_t);
+    for (i = 0; i < n; ++i) {
+        t = vec + i * sizeof(flatbuffers_uoffset_t);
+        t += __flatbuffers_uoffset_read_from_pe(t);
+        t2 = vec + (n + i) * sizeof(flatbuffers_uoffset_t);
+        t2 += __flatbuffers_uoffset_read_from_pe(t2);
+        vt = t - __flatbuffers_soffset_read_from_pe(t);
+        if (vt != t2 - __flatbuffers_soffset_read_from_pe(t2) ||
+                __flatbuffers_voffset_read_from_pe(vt) != (i + 3) * sizeof(flatbuffers_voffset_t) ||
+                t[__flatbuffers_voffset_read_from_pe(vt + (i + 2) * sizeof(flatbuffers_voffset_t))] != i) {
+            printf("vtable reused across buffers was not cached correctly\n");
+            goto done;
+        }
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free((void *)buffer);
+    flatcc_builder_clear(B);
+    return ret;
+}
+
+/*
+ * Looks up cached vtables in reverse order of creation so most hits are
+ * deep in a hash chain and are moved to the front, then looks all of
+ * them up again. A broken chain loses vtables or never ends.
+ */
+int test_vtable_cache_move_to_front(void)
+{
+    flatcc_builder_t builder, *B = &builder;
+    const int n = 200;
+    const uint8_t *buffer = 0, *vec, *t, *t2, *t3;
+    size_t size;
+    int i, ret = -1;
+
+    flatcc_builder_init(B);
+    if (flatcc_builder_start_buffer(B, 0, 0) || flatcc_builder_start_offset_vector(B)) {
+        goto done;
+    }
+    for (i = 0; i < 3 * n; ++i) {
+        if (!flatcc_builder_offset_vector_push(B,
+                create_single_field_table(B, i / n == 1 ? 2 * n - 1 - i : i % n))) {
+            goto done;
+        }
+    }
+    if (!flatcc_builder_end_buffer(B, flatcc_builder_end_offset_vector(B)) ||
+            !(buffer = flatcc_builder_finalize_aligned_buffer(B, &size))) {
+        printf("vtable cache move to front test setup failed\n");
+        goto done;
+    }
+    vec = buffer + __flatbuffers_uoffset_read_from_pe(buffer);
+    vec += sizeof(flatbuffers_uoffset_t);
+    for (i = 0; i < n; ++i) {
+        t = vec + i * sizeof(flatbuffers_uoffset_t);
+        t += __flatbuffers_uoffset_read_from_pe(t);
+        t2 = vec + (2 * n - 1 - i) * sizeof(flatbuffers_uoffset_t);
+        t2 += __flatbuffers_uoffset_read_from_pe(t2);
+        t3 = vec + (2 * n + i) * sizeof(flatbuffers_uoffset_t);
+        t3 += __flatbuffers_uoffset_read_from_pe(t3);
+        if (t - __flatbuffers_soffset_read_from_pe(t) != t2 - __flatbuffers_soffset_read_from_pe(t2) ||
+                t - __flatbuffers_soffset_read_from_pe(t) != t3 - __flatbuffers_soffset_read_from_pe(t3)) {
+            printf("vtable cache lost a vtable after move to front\n");
+            goto done;
+        }
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free((void *)buffer);
+    flatcc_builder_clear(B);
+    return ret;
+}
+
 int test_string(flatcc_builder_t *B)
 {
     ns(Monster_table_t) mon;
@@ -1397,130 +1594,1500 @@ int test_nested_buffer(flatcc_builder_t *B)
     return 0;
 }
 
-int test_struct_buffer(flatcc_builder_t *B)
+/*
+ * Builds the same monster twice, the second time with speculative
+ * content, including nested tables, new vtables and a vector spanning
+ * several emitter pages, that is rolled back before completing the
+ * buffer. Both buffers must be identical.
+ */
+static int build_rollback_monster(flatcc_builder_t *B, int speculate)
 {
-    uint8_t buffer[100];
-
-    size_t size;
-    ns(Vec3_t) *v;
-    ns(Vec3_struct_t) vec3;
+    flatcc_builder_checkpoint_t cp, cp2;
+    uint8_t *inv;
+    size_t n = 100000;
 
     flatcc_builder_reset(B);
-    ns(Vec3_create_as_root(B, 1, 2, 3, 4.2, ns(Color_Blue), 2730, -17));
-    size = flatcc_builder_get_buffer_size(B);
-    assert(size == 48);
-    printf("dbg: struct buffer size: %d\n", (int)size);
-    assert(flatcc_emitter_get_buffer_size(flatcc_builder_get_emit_context(B)) == size);
-    if (!flatcc_builder_copy_buffer(B, buffer, 100)) {
-        printf("Copy failed\n");
-        return -1;
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "MyMonster"));
+    ns(Monster_mana_add(B, 42));
+    if (speculate) {
+        flatcc_builder_checkpoint(B, &cp);
+        ns(Monster_hp_add(B, 99));
+        ns(Monster_testempty_create(B, nsc(string_create_str(B, "hello")), -100, 2));
+        if (!(inv = calloc(n, 1))) {
+            return -1;
+        }
+        ns(Monster_inventory_create(B, inv, n));
+        free(inv);
+        if (flatcc_builder_rollback(B, &cp)) {
+            printf("rollback failed at checkpoint level\n");
+            return -1;
+        }
+        /* Roll back from within nested frames. */
+        flatcc_builder_checkpoint(B, &cp);
+        ns(Monster_enemy_start(B));
+        ns(Monster_name_create_str(B, "speculative enemy"));
+        ns(Monster_color_add(B, ns(Color_Blue)));
+        ns(Monster_testarrayofstring_start(B));
+        flatcc_builder_checkpoint(B, &cp2);
+        ns(Monster_testarrayofstring_push_create_str(B, "discarded"));
+        if (flatcc_builder_rollback(B, &cp2)) {
+            printf("rollback failed in vector\n");
+            return -1;
+        }
+        ns(Monster_testarrayofstring_push_create_str(B, "discarded too"));
+        if (flatcc_builder_rollback(B, &cp)) {
+            printf("rollback failed in nested table\n");
+            return -1;
+        }
     }
-    hexdump("Vec3 struct buffer", buffer, size, stderr);
-    if (!nsc(has_identifier(buffer, "MONS"))) {
-        printf("wrong Vec3 identifier (explicit)\n");
+    ns(Monster_hp_add(B, 10));
+    ns(Monster_enemy_start(B));
+    ns(Monster_name_create_str(B, "the enemy"));
+    ns(Monster_enemy_end(B));
+    ns(Monster_end_as_root(B));
+    return 0;
+}
+
+int test_checkpoint_rollback(flatcc_builder_t *B)
+{
+    void *buffer, *expect;
+    size_t size, expect_size;
+    int ret = -1;
+
+    if (build_rollback_monster(B, 0)) {
         return -1;
     }
-    if (nsc(has_identifier(buffer, "mons"))) {
-        printf("accepted wrong Vec3 identifier (explicit)\n");
+    expect = flatcc_builder_finalize_buffer(B, &expect_size);
+    if (build_rollback_monster(B, 1)) {
+        free(expect);
         return -1;
     }
-    if (!nsc(has_identifier(buffer, ns(Vec3_identifier)))) {
-        printf("wrong Vec3 identifier (via define)\n");
-        return -1;
+    buffer = flatcc_builder_finalize_buffer(B, &size);
+    if (size != expect_size || memcmp(buffer, expect, size)) {
+        printf("rolled back buffer differs from expected buffer\n");
+        hexdump("expected", expect, expect_size, stderr);
+        hexdump("rolled back", buffer, size, stderr);
+        goto done;
     }
-    vec3 = ns(Vec3_as_root(buffer));
-    /* Convert buffer to native in place - a nop on native platform. */
-    v = (ns(Vec3_t) *)vec3;
-    ns(Vec3_from_pe(v));
-    if (v->x != 1.0f || v->y != 2.0f || v->z != 3.0f
-        || v->test1 != 4.2 || v->test2 != ns(Color_Blue)
-        || v->test3.a != 2730 || v->test3.b != -17
-       ) {
-        printf("struct buffer not valid\n");
-        return -1;
+    if (ns(Monster_verify_as_root(buffer, size))) {
+        printf("rolled back buffer does not verify\n");
+        goto done;
     }
-    assert(ns(Color_Red) == 1 << 0);
-    assert(ns(Color_Green) == 1 << 1);
-    assert(ns(Color_Blue) == 1 << 3);
-    assert(sizeof(ns(Color_Blue) == 1));
-    return 0;
+    ret = 0;
+done:
+    free(buffer);
+    free(expect);
+    return ret;
 }
 
-int test_typed_struct_buffer(flatcc_builder_t *B)
+/*
+ * Rolls back vtables cached after a checkpoint while older cached
+ * vtables have been moved in front of them in their hash chains, then
+ * checks that tables built after the rollback get valid vtables.
+ */
+int test_rollback_vtable_cache(void)
 {
-    uint8_t buffer[100];
-
+    flatcc_builder_t builder, *B = &builder;
+    flatcc_builder_checkpoint_t cp;
+    const int n = 100;
+    const uint8_t *buffer = 0, *vec, *t, *vt;
     size_t size;
-    ns(Vec3_t) *v;
-    ns(Vec3_struct_t) vec3;
+    int i, id, ret = -1;
 
-    flatcc_builder_reset(B);
-    ns(Vec3_create_as_typed_root(B, 1, 2, 3, 4.2, ns(Color_Blue), 2730, -17));
-    size = flatcc_builder_get_buffer_size(B);
-    assert(size == 48);
-    printf("dbg: struct buffer size: %d\n", (int)size);
-    assert(flatcc_emitter_get_buffer_size(flatcc_builder_get_emit_context(B)) == size);
-    if (!flatcc_builder_copy_buffer(B, buffer, 100)) {
-        printf("Copy failed\n");
-        return -1;
+    flatcc_builder_init(B);
+    if (flatcc_builder_start_buffer(B, 0, 0) || flatcc_builder_start_offset_vector(B)) {
+        goto done;
     }
-    hexdump("typed Vec3 struct buffer", buffer, size, stderr);
-    if (!nsc(has_identifier(buffer, "\xd2\x3e\xf5\xa8"))) {
-        printf("wrong Vec3 identifier (explicit)\n");
-        return -1;
+    for (i = 0; i < n; ++i) {
+        if (!flatcc_builder_offset_vector_push(B, create_single_field_table(B, i))) {
+            goto done;
+        }
     }
-    if (nsc(has_identifier(buffer, "mons"))) {
-        printf("accepted wrong Vec3 identifier (explicit)\n");
-        return -1;
+    flatcc_builder_checkpoint(B, &cp);
+    for (i = 0; i < 2 * n; ++i) {
+        if (!create_single_field_table(B, i < n ? n + i : 2 * n - 1 - i)) {
+            goto done;
+        }
     }
-    if (!nsc(has_identifier(buffer, ns(Vec3_type_identifier)))) {
-        printf("wrong Vec3 identifier (via define)\n");
-        return -1;
+    if (flatcc_builder_rollback(B, &cp)) {
+        goto done;
     }
-    if (!ns(Vec3_as_root_with_type_hash(buffer, ns(Vec3_type_hash)))) {
-        printf("wrong Vec3 type identifier (via define)\n");
-        return -1;
+    for (i = 0; i < 2 * n; ++i) {
+        if (!flatcc_builder_offset_vector_push(B, create_single_field_table(B, (n + i) % (2 * n)))) {
+            goto done;
+        }
     }
-    if (!ns(Vec3_verify_as_root_with_type_hash(buffer, size, ns(Vec3_type_hash)))) {
-        printf("verify failed with Vec3 type hash)\n");
-        return -1;
+    if (!flatcc_builder_end_buffer(B, flatcc_builder_end_offset_vector(B)) ||
+            !(buffer = flatcc_builder_finalize_aligned_buffer(B, &size))) {
+        printf("vtable cache rollback test setup failed\n");
+        goto done;
     }
-    vec3 = ns(Vec3_as_typed_root(buffer));
-    if (!vec3) {
-        printf("typed Vec3 could not be read\n");
-        return -1;
+    vec = buffer + __flatbuffers_uoffset_read_from_pe(buffer);
+    vec += sizeof(flatbuffers_uoffset_t);
+    for (i = 0; i < 3 * n; ++i) {
+        id = i < n ? i : i % (2 * n);
+        t = vec + i * sizeof(flatbuffers_uoffset_t);
+        t += __flatbuffers_uoffset_read_from_pe(t);
+        vt = t - __flatbuffers_soffset_read_from_pe(t);
+        if (vt < buffer || vt >= buffer + size ||
+                __flatbuffers_voffset_read_from_pe(vt) != (id + 3) * sizeof(flatbuffers_voffset_t) ||
+                t[__flatbuffers_voffset_read_from_pe(vt + (id + 2) * sizeof(flatbuffers_voffset_t))] != (uint8_t)id) {
+            printf("vtable cache not valid after rollback\n");
+            goto done;
+        }
     }
-    if (!ns(Vec3_verify_as_typed_root(buffer, size))) {
-        printf("verify failed with Vec3 type hash)\n");
-        return -1;
+    ret = 0;
+done:
+    flatcc_builder_aligned_free((void *)buffer);
+    flatcc_builder_clear(B);
+    return ret;
+}
+
+/*
+ * Rolls back a table whose vtable was cached by an earlier buffer in
+ * stream mode, or seeded by a dictionary, then uses the same vtable
+ * again after other content was emitted in the discarded range.
+ */
+static int build_rollback_stale_vtable(flatcc_builder_t *B)
+{
+    flatcc_builder_checkpoint_t cp;
+    const uint8_t *buffer = 0, *root, *vec, *t, *vt;
+    const int ids[2] = { 1, 0 };
+    size_t size;
+    int i, ret = -1;
+
+    flatcc_builder_reset(B);
+    if (flatcc_builder_start_buffer(B, 0, 0) || flatcc_builder_start_offset_vector(B)) {
+        goto done;
     }
-    /* Convert buffer to native in place - a nop on native platform. */
-    v = (ns(Vec3_t) *)vec3;
-    ns(Vec3_from_pe(v));
-    if (v->x != 1.0f || v->y != 2.0f || v->z != 3.0f
-        || v->test1 != 4.2 || v->test2 != ns(Color_Blue)
-        || v->test3.a != 2730 || v->test3.b != -17
-       ) {
-        printf("struct buffer not valid\n");
-        return -1;
+    flatcc_builder_checkpoint(B, &cp);
+    if (!create_single_field_table(B, 0) || flatcc_builder_rollback(B, &cp)) {
+        goto done;
     }
-    assert(ns(Color_Red) == 1 << 0);
-    assert(ns(Color_Green) == 1 << 1);
-    assert(ns(Color_Blue) == 1 << 3);
-    assert(sizeof(ns(Color_Blue) == 1));
-    return 0;
+    for (i = 0; i < 2; ++i) {
+        if (!flatcc_builder_offset_vector_push(B, create_single_field_table(B, ids[i]))) {
+            goto done;
+        }
+    }
+    if (!flatcc_builder_end_buffer(B, flatcc_builder_end_offset_vector(B)) ||
+            !(buffer = flatcc_builder_finalize_aligned_buffer(B, &size))) {
+        goto done;
+    }
+    /* Stream mode buffers are size prefixed. */
+    root = buffer + (B->stream_mode ? sizeof(flatbuffers_uoffset_t) : 0);
+    vec = root + __flatbuffers_uoffset_read_from_pe(root);
+    vec += sizeof(flatbuffers_uoffset_t);
+    for (i = 0; i < 2; ++i) {
+        t = vec + i * sizeof(flatbuffers_uoffset_t);
+        t += __flatbuffers_uoffset_read_from_pe(t);
+        vt = t - __flatbuffers_soffset_read_from_pe(t);
+        if (vt < buffer || vt >= buffer + size ||
+                __flatbuffers_voffset_read_from_pe(vt) != (ids[i] + 3) * sizeof(flatbuffers_voffset_t) ||
+                t[__flatbuffers_voffset_read_from_pe(vt + (ids[i] + 2) * sizeof(flatbuffers_voffset_t))] != ids[i]) {
+            goto done;
+        }
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free((void *)buffer);
+    return ret;
 }
 
+int test_rollback_stale_vtable(void)
+{
+    static const flatcc_builder_vtable_field_t fields[] = { { 0, 1, 1 } };
+    static const flatcc_builder_vtable_shape_t shapes[] = { { fields, 1 } };
+    static const flatcc_builder_vtable_dict_t dict = { shapes, 1 };
+    flatcc_builder_t builder, *B = &builder;
+    int ret = -1;
 
-/* A stable test snapshot for reference. */
-int gen_monster_benchmark(flatcc_builder_t *B)
+    flatcc_builder_init(B);
+    flatcc_builder_set_stream_mode(B, 1);
+    if (flatcc_builder_start_buffer(B, 0, 0) ||
+            !flatcc_builder_end_buffer(B, create_single_field_table(B, 0)) ||
+            build_rollback_stale_vtable(B)) {
+        printf("rollback of a vtable cached in stream mode failed\n");
+        goto done;
+    }
+    flatcc_builder_clear(B);
+    flatcc_builder_init(B);
+    if (flatcc_builder_set_vtable_dict(B, &dict) || build_rollback_stale_vtable(B)) {
+        printf("rollback of a vtable seeded by a dictionary failed\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_clear(B);
+    return ret;
+}
+
+int test_shared_strings(flatcc_builder_t *B)
 {
-    uint8_t inv[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
-    ns(Vec3_t) *vec;
-    ns(Test_t) *test, x;
+    static const char *tags[] = { "red", "green", "blue" };
+    flatcc_builder_checkpoint_t cp;
+    flatbuffers_string_vec_t strings;
+    ns(Monster_table_t) mon;
+    ns(Monster_vec_t) children;
+    ns(Monster_ref_t) refs[30];
+    void *buffer;
+    size_t size;
+    int i, ret = -1;
 
     flatcc_builder_reset(B);
-
+    ns(Monster_start_as_root(B));
+    for (i = 0; i < 30; ++i) {
+        ns(Monster_start(B));
+        ns(Monster_name_create_shared_str(B, tags[i % 3]));
+        refs[i] = ns(Monster_end(B));
+    }
+    ns(Monster_testarrayoftables_create(B, refs, 30));
+    /* Discarded strings must not be returned after rollback. */
+    flatcc_builder_checkpoint(B, &cp);
+    flatbuffers_string_create_shared_str(B, "discarded");
+    flatcc_builder_rollback(B, &cp);
+    ns(Monster_testarrayofstring_start(B));
+    ns(Monster_testarrayofstring_push_create_shared_str(B, "discarded"));
+    ns(Monster_testarrayofstring_push_create_shared_str(B, "red"));
+    /* Interning is opt-in. */
+    ns(Monster_testarrayofstring_push_create_str(B, "red"));
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_name_create_shared_str(B, "green"));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_get_direct_buffer(B, &size);
+
+    if (ns(Monster_verify_as_root(buffer, size))) {
+        printf("buffer with shared strings does not verify\n");
+        goto done;
+    }
+    mon = ns(Monster_as_root(buffer));
+    children = ns(Monster_testarrayoftables(mon));
+    strings = ns(Monster_testarrayofstring(mon));
+    for (i = 3; i < 30; ++i) {
+        if (ns(Monster_name(ns(Monster_vec_at(children, i)))) !=
+                ns(Monster_name(ns(Monster_vec_at(children, i % 3))))) {
+            printf("child name was not shared\n");
+            goto done;
+        }
+    }
+    if (strcmp(ns(Monster_name(ns(Monster_vec_at(children, 2)))), "blue") ||
+            ns(Monster_name(mon)) != ns(Monster_name(ns(Monster_vec_at(children, 1)))) ||
+            strcmp(flatbuffers_string_vec_at(strings, 0), "discarded") ||
+            flatbuffers_string_vec_at(strings, 1) != ns(Monster_name(ns(Monster_vec_at(children, 0)))) ||
+            flatbuffers_string_vec_at(strings, 2) == flatbuffers_string_vec_at(strings, 1)) {
+        printf("shared strings not as expected\n");
+        goto done;
+    }
+
+    /* All strings are interned in interning mode, except when too long for the cache. */
+    flatcc_builder_reset(B);
+    flatcc_builder_set_string_interning(B, 1);
+    flatcc_builder_set_string_cache_limit(B, 8);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "interned"));
+    ns(Monster_testarrayofstring_start(B));
+    ns(Monster_testarrayofstring_push_create_str(B, "interned"));
+    ns(Monster_testarrayofstring_push_create_str(B, "not interned"));
+    ns(Monster_testarrayofstring_push_create_str(B, "not interned"));
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_get_direct_buffer(B, &size);
+    mon = ns(Monster_as_root(buffer));
+    strings = ns(Monster_testarrayofstring(mon));
+    if (ns(Monster_verify_as_root(buffer, size)) ||
+            flatbuffers_string_vec_at(strings, 0) != ns(Monster_name(mon)) ||
+            flatbuffers_string_vec_at(strings, 1) == flatbuffers_string_vec_at(strings, 2) ||
+            strcmp(flatbuffers_string_vec_at(strings, 2), "not interned")) {
+        printf("interning mode not as expected\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_custom_reset(B, 1, 0);
+    return ret;
+}
+
+static int build_dedup_monster(flatcc_builder_t *B, void **buffer, size_t *size)
+{
+    static uint8_t inv[] = { 1, 2, 3, 4, 5 };
+    ns(Monster_ref_t) refs[20];
+    ns(Vec3_t) v = { 1, 2, 3, 0, 0, { 0, 0 } };
+    flatcc_builder_ref_t s1, s2;
+    int i;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "parent"));
+    for (i = 0; i < 20; ++i) {
+        ns(Monster_start(B));
+        ns(Monster_name_create_shared_str(B, "child"));
+        ns(Monster_inventory_create(B, inv, 5));
+        ns(Monster_testempty_start(B));
+        ns(Stat_val_add(B, i % 2 + 1));
+        ns(Monster_testempty_end(B));
+        refs[i] = ns(Monster_end(B));
+    }
+    ns(Monster_testarrayoftables_create(B, refs, 20));
+    s1 = flatcc_builder_create_struct(B, &v, sizeof(v), 16);
+    s2 = flatcc_builder_create_struct(B, &v, sizeof(v), 16);
+    ns(Monster_end_as_root(B));
+    *buffer = flatcc_builder_finalize_buffer(B, size);
+    return flatcc_builder_get_buffer_start(B) != 0 && (s1 == s2) == B->dedup_objects ? 0 : -1;
+}
+
+int test_object_dedup(flatcc_builder_t *B)
+{
+    void *buffer = 0, *expect = 0;
+    size_t size, expect_size, saved;
+    ns(Monster_table_t) mon;
+    ns(Monster_vec_t) children;
+    ns(Monster_table_t) c0, c1, c2;
+    int ret = -1;
+
+    if (build_dedup_monster(B, &expect, &expect_size)) {
+        printf("building monster without dedup failed\n");
+        goto done;
+    }
+    flatcc_builder_set_object_dedup(B, 1);
+    if (build_dedup_monster(B, &buffer, &size)) {
+        printf("building monster with dedup failed\n");
+        goto done;
+    }
+    saved = flatcc_builder_get_shared_bytes_saved(B);
+    /* 19 names, inventories and stats, and one struct, all reused. */
+    if (saved != 19 * (4 + 6) + 19 * (4 + 5) + 18 * (4 + 8) + sizeof(ns(Vec3_t))) {
+        printf("unexpected number of bytes saved by dedup: %d\n", (int)saved);
+        goto done;
+    }
+    if (size >= expect_size || ns(Monster_verify_as_root(buffer, size))) {
+        printf("dedup buffer not as expected\n");
+        goto done;
+    }
+    mon = ns(Monster_as_root(buffer));
+    children = ns(Monster_testarrayoftables(mon));
+    c0 = ns(Monster_vec_at(children, 0));
+    c1 = ns(Monster_vec_at(children, 1));
+    c2 = ns(Monster_vec_at(children, 2));
+    if (ns(Monster_inventory(c0)) != ns(Monster_inventory(c1)) ||
+            ns(Monster_testempty(c0)) != ns(Monster_testempty(c2)) ||
+            ns(Monster_testempty(c0)) == ns(Monster_testempty(c1)) ||
+            ns(Stat_val(ns(Monster_testempty(c1)))) != 2 ||
+            flatbuffers_uint8_vec_at(ns(Monster_inventory(c1)), 4) != 5) {
+        printf("dedup objects not shared as expected\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_custom_reset(B, 1, 0);
+    free(buffer);
+    free(expect);
+    return ret;
+}
+
+/*
+ * Child monsters built in separate fragment builders, as worker threads
+ * would, and spliced into a main builder must give the same buffer as
+ * building all children in the main builder.
+ */
+static flatcc_builder_ref_t create_child_monster(flatcc_builder_t *B, int i)
+{
+    char name[20];
+
+    sprintf(name, "child%d", i);
+    ns(Monster_start(B));
+    ns(Monster_name_create_str(B, name));
+    ns(Monster_hp_add(B, (int16_t)i));
+    if (i % 3 == 0) {
+        ns(Monster_mana_add(B, (int16_t)(i % 100)));
+    }
+    return ns(Monster_end(B));
+}
+
+int test_splice_fragments(flatcc_builder_t *B)
+{
+    enum { nfrag = 3, per_frag = 1000, total = nfrag * per_frag };
+    flatcc_builder_t fragments[nfrag];
+    flatcc_builder_ref_t refs[total];
+    ns(Monster_table_t) mon;
+    ns(Monster_vec_t) children;
+    void *buffer = 0, *expect = 0;
+    size_t size, expect_size;
+    int i, k, ret = -1;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "parent"));
+    for (i = 0; i < total; ++i) {
+        refs[i] = create_child_monster(B, i);
+    }
+    ns(Monster_testarrayoftables_add(B, ns(Monster_vec_create(B, refs, total))));
+    ns(Monster_end_as_root(B));
+    expect = flatcc_builder_finalize_buffer(B, &expect_size);
+
+    for (k = 0; k < nfrag; ++k) {
+        flatcc_builder_init(&fragments[k]);
+        flatcc_builder_set_fragment_mode(&fragments[k], 1);
+        for (i = 0; i < per_frag; ++i) {
+            refs[k * per_frag + i] = create_child_monster(&fragments[k], k * per_frag + i);
+        }
+    }
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "parent"));
+    for (k = 0; k < nfrag; ++k) {
+        if (flatcc_builder_splice_fragment(B, &fragments[k], refs + k * per_frag, per_frag)) {
+            printf("fragment splice failed\n");
+            goto done;
+        }
+    }
+    ns(Monster_testarrayoftables_add(B, ns(Monster_vec_create(B, refs, total))));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_buffer(B, &size);
+
+    if (ns(Monster_verify_as_root(buffer, size))) {
+        printf("spliced buffer does not verify\n");
+        goto done;
+    }
+    mon = ns(Monster_as_root(buffer));
+    children = ns(Monster_testarrayoftables(mon));
+    if (ns(Monster_vec_len(children)) != total ||
+            ns(Monster_hp(ns(Monster_vec_at(children, total - 1)))) != total - 1 ||
+            ns(Monster_mana(ns(Monster_vec_at(children, 3)))) != 3 ||
+            strcmp(ns(Monster_name(ns(Monster_vec_at(children, 1234)))), "child1234")) {
+        printf("spliced children not as expected\n");
+        goto done;
+    }
+    /* Vtables are shared, so nothing but alignment can differ. */
+    if (size != expect_size || memcmp(buffer, expect, size)) {
+        printf("spliced buffer differs from directly built buffer\n");
+        goto done;
+    }
+    /* A spliced table shares its vtable with a table built natively. */
+    free(buffer);
+    flatcc_builder_reset(&fragments[0]);
+    refs[1] = create_child_monster(&fragments[0], 1);
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "parent"));
+    refs[0] = create_child_monster(B, 2);
+    if (flatcc_builder_splice_fragment(B, &fragments[0], refs + 1, 1)) {
+        printf("fragment splice failed\n");
+        buffer = 0;
+        goto done;
+    }
+    ns(Monster_testarrayoftables_add(B, ns(Monster_vec_create(B, refs, 2))));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_buffer(B, &size);
+    children = ns(Monster_testarrayoftables(ns(Monster_as_root(buffer))));
+    if (ns(Monster_verify_as_root(buffer, size)) ||
+            (const uint8_t *)ns(Monster_vec_at(children, 0)) -
+            __flatbuffers_soffset_read_from_pe(ns(Monster_vec_at(children, 0))) !=
+            (const uint8_t *)ns(Monster_vec_at(children, 1)) -
+            __flatbuffers_soffset_read_from_pe(ns(Monster_vec_at(children, 1)))) {
+        printf("spliced table did not share the vtable of a native table\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    for (k = 0; k < nfrag; ++k) {
+        flatcc_builder_clear(&fragments[k]);
+    }
+    free(buffer);
+    free(expect);
+    return ret;
+}
+
+int test_builder_stats(flatcc_builder_t *B)
+{
+    flatcc_builder_stats_t stats, stats2;
+    void *buffer = 0;
+    size_t size;
+    int ret = -1;
+
+    flatcc_builder_set_stats(B, 1);
+    /* Shrink the stacks so they must grow again. */
+    flatcc_builder_custom_reset(B, 0, 1);
+    if (build_dedup_monster(B, &buffer, &size)) {
+        printf("building monster with statistics failed\n");
+        goto done;
+    }
+    flatcc_builder_get_stats(B, &stats);
+#if FLATCC_BUILDER_STATS
+    /* 21 monsters and 20 stats sharing 3 distinct vtables. */
+    if (stats.vtable_lookups != 41 || stats.vtable_hits != 38 ||
+            stats.vtable_chain_steps < stats.vtable_hits ||
+            stats.vtable_max_chain < 1 ||
+            stats.alloc_calls[flatcc_builder_alloc_ds] == 0 ||
+            stats.alloc_bytes[flatcc_builder_alloc_ds] == 0 ||
+            stats.refresh_ds_count == 0 || stats.peak_level != 4 ||
+            stats.emitter_pages_allocated + stats.emitter_pages_recycled == 0 ||
+            stats.front_bytes + stats.back_bytes != size) {
+        printf("builder statistics not as expected\n");
+        goto done;
+    }
+#endif
+    flatcc_builder_set_stats(B, 0);
+    free(buffer);
+    buffer = 0;
+    if (build_dedup_monster(B, &buffer, &size)) {
+        printf("building monster without statistics failed\n");
+        goto done;
+    }
+    flatcc_builder_get_stats(B, &stats2);
+    if (memcmp(&stats, &stats2, sizeof(stats))) {
+        printf("builder statistics updated while disabled\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_custom_reset(B, 1, 0);
+    free(buffer);
+    return ret;
+}
+
+int test_finalize_into(flatcc_builder_t *B)
+{
+    uint8_t mem[512];
+    void *buffer = 0, *aligned = 0, *p;
+    size_t size, size2, align, capacity;
+    ns(Vec3_t) *v;
+    int ret = -1;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "ring"));
+    v = ns(Monster_pos_start(B));
+    v->x = 1, v->y = 2, v->z = 3;
+    ns(Monster_pos_end(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_buffer(B, &size);
+    align = flatcc_builder_get_buffer_alignment(B);
+    capacity = flatcc_builder_get_aligned_buffer_size(B);
+    if (!buffer || align < 16 || capacity != size + align - 1 || capacity > sizeof(mem) - 1) {
+        printf("unexpected buffer size or alignment for finalize into\n");
+        goto done;
+    }
+    /* Find a misaligned start so the buffer must be moved up. */
+    p = mem;
+    while (((size_t)p & (align - 1)) != 1) {
+        p = (uint8_t *)p + 1;
+    }
+    if (flatcc_builder_finalize_buffer_into(B, p, size, &size2) || size2 != 0) {
+        printf("finalize into misaligned memory should need more space\n");
+        goto done;
+    }
+    p = flatcc_builder_finalize_buffer_into(B, p, capacity, &size2);
+    if (!p || ((size_t)p & (align - 1)) || size2 != size || memcmp(p, buffer, size) ||
+            ns(Monster_verify_as_root(p, size))) {
+        printf("finalize into caller memory failed\n");
+        goto done;
+    }
+    aligned = flatcc_builder_finalize_aligned_buffer(B, &size2);
+    if (!aligned || ((size_t)aligned & (align - 1)) || size2 != size || memcmp(aligned, buffer, size)) {
+        printf("finalize aligned buffer failed\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(aligned);
+    free(buffer);
+    return ret;
+}
+
+int test_stream_mode(flatcc_builder_t *B)
+{
+    enum { count = 10 };
+    uint8_t stream[4096];
+    size_t used = 0, size, vd_end = 0;
+    flatbuffers_stream_iter_t it;
+    flatcc_builder_stats_t stats;
+    const void *buffer;
+    ns(Monster_table_t) mon;
+    char name[20];
+    int i, ret = -1;
+
+    flatcc_builder_custom_reset(B, 1, 0);
+    flatcc_builder_set_stream_mode(B, 1);
+    flatcc_builder_set_stats(B, 1);
+    for (i = 0; i < count; ++i) {
+        flatcc_builder_reset(B);
+        sprintf(name, "stream%d", i);
+        ns(Monster_start_as_root(B));
+        ns(Monster_name_create_str(B, name));
+        ns(Monster_hp_add(B, (int16_t)i));
+        ns(Monster_end_as_root(B));
+        size = flatcc_builder_get_buffer_size(B);
+        if (size % 4 || !flatcc_builder_copy_buffer(B, stream + used, sizeof(stream) - used)) {
+            printf("stream record could not be copied\n");
+            goto done;
+        }
+        used += size;
+        if (i == 1) {
+            vd_end = B->vd_end;
+        }
+    }
+    /* Only the first buffer adds the vtable to the cache. */
+    flatcc_builder_get_stats(B, &stats);
+    if (B->vd_end != vd_end || (FLATCC_BUILDER_STATS && stats.vtable_hits != count - 1)) {
+        printf("stream mode vtable cache not kept warm\n");
+        goto done;
+    }
+    flatbuffers_stream_iter_init(&it, stream, used);
+    for (i = 0; (buffer = flatbuffers_stream_iter_next(&it, &size)); ++i) {
+        sprintf(name, "stream%d", i);
+        mon = ns(Monster_as_root(buffer));
+        if (ns(Monster_verify_as_root(buffer, size)) ||
+                strcmp(ns(Monster_name(mon)), name) || ns(Monster_hp(mon)) != i) {
+            printf("stream buffer %d not as expected\n", i);
+            goto done;
+        }
+    }
+    if (i != count || !flatbuffers_stream_iter_done(&it)) {
+        printf("stream iterator did not visit all buffers\n");
+        goto done;
+    }
+    /* A truncated record stops the iterator. */
+    flatbuffers_stream_iter_init(&it, stream, used - 1);
+    for (i = 0; flatbuffers_stream_iter_next(&it, 0); ++i) {
+    }
+    if (i != count - 1 || flatbuffers_stream_iter_done(&it)) {
+        printf("stream iterator accepted truncated record\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_custom_reset(B, 1, 0);
+    return ret;
+}
+
+/* Builds a monster DAG where each level refers `fanout` times to the level below. */
+static void *build_monster_dag(flatcc_builder_t *B, int levels, size_t *size)
+{
+    ns(Monster_ref_t) mon, refs[4];
+    int i, j;
+
+    flatcc_builder_reset(B);
+    flatbuffers_buffer_start(B, ns(Monster_identifier));
+    ns(Monster_start(B));
+    ns(Monster_name_create_str(B, "leaf"));
+    mon = ns(Monster_end(B));
+    for (i = 0; i < levels; ++i) {
+        for (j = 0; j < 4; ++j) {
+            refs[j] = mon;
+        }
+        ns(Monster_start(B));
+        ns(Monster_name_create_str(B, "dag"));
+        ns(Monster_testarrayoftables_create(B, refs, 4));
+        mon = ns(Monster_end(B));
+    }
+    flatbuffers_buffer_end(B, mon);
+    return flatcc_builder_finalize_aligned_buffer(B, size);
+}
+
+int test_verify_memoized(flatcc_builder_t *B)
+{
+    void *buffer, *scratch = 0;
+    char *p;
+    size_t size, scratch_size;
+    int ret = -1;
+
+    /* Without room for the visited set, objects are verified as usual. */
+    buffer = build_monster_dag(B, 3, &size);
+    if (!buffer || ns(Monster_verify_as_root_memoized(buffer, size, 0, 0)) ||
+            ns(Monster_verify_as_root(buffer, size))) {
+        printf("small monster dag did not verify\n");
+        goto done;
+    }
+    flatcc_builder_aligned_free(buffer);
+    /* Plain verification would visit 4^20 tables. */
+    buffer = build_monster_dag(B, 20, &size);
+    scratch_size = flatcc_verify_memo_size(size);
+    if (!buffer || !(scratch = malloc(scratch_size))) {
+        printf("memoized verify test setup failed\n");
+        goto done;
+    }
+    if ((ret = ns(Monster_verify_as_root_memoized(buffer, size, scratch, scratch_size)))) {
+        printf("memoized verify failed: %s\n", flatcc_verify_error_string(ret));
+        goto done;
+    }
+    ret = -1;
+    /* A shared subtree that does not verify must still fail. */
+    for (p = buffer; memcmp(p, "leaf", 5); ++p) {
+    }
+    p[4] = 'x';
+    if (flatcc_verify_error_string_not_zero_terminated !=
+            ns(Monster_verify_as_root_memoized(buffer, size, scratch, scratch_size))) {
+        printf("memoized verify accepted an invalid shared table\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    free(scratch);
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+/* Runs tasks last to first, so chunks complete out of vector order. */
+static void reverse_runner(void *runner_context, flatcc_verify_task_f *task, void *task_context, size_t count)
+{
+    (void)runner_context;
+    while (count--) {
+        task(task_context, count);
+    }
+}
+
+static void lazy_runner(void *runner_context, flatcc_verify_task_f *task, void *task_context, size_t count)
+{
+    (void)runner_context; (void)task; (void)task_context; (void)count;
+}
+
+static char *find_name(void *buffer, size_t size, const char *name)
+{
+    char *p = buffer, *end = p + size;
+    size_t n = strlen(name) + 1;
+
+    for (; p + n <= end; ++p) {
+        if (!memcmp(p, name, n)) {
+            return p;
+        }
+    }
+    return 0;
+}
+
+int test_verify_parallel(flatcc_builder_t *B)
+{
+    void *buffer;
+    char name[20], *p, *q;
+    size_t size;
+    /* Above the default split threshold of 4096 elements. */
+    int i, n = 10000, ret = -1;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "parallel"));
+    ns(Monster_testarrayofstring_start(B));
+    for (i = 0; i < n; ++i) {
+        sprintf(name, "s%d", i);
+        ns(Monster_testarrayofstring_push_create_str(B, name));
+    }
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_testarrayoftables_start(B));
+    for (i = 0; i < n; ++i) {
+        sprintf(name, "m%d", i);
+        ns(Monster_testarrayoftables_push_start(B));
+        ns(Monster_name_create_str(B, name));
+        ns(Monster_testarrayoftables_push_end(B));
+    }
+    ns(Monster_testarrayoftables_end(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+    if (!buffer) {
+        printf("parallel verify test setup failed\n");
+        goto done;
+    }
+    if ((ret = ns(Monster_verify_as_root_parallel(buffer, size, reverse_runner, 0)))) {
+        printf("parallel verify failed: %s\n", flatcc_verify_error_string(ret));
+        goto done;
+    }
+    ret = -1;
+    if (flatcc_verify_error_runtime_task_not_run !=
+            ns(Monster_verify_as_root_parallel(buffer, size, lazy_runner, 0))) {
+        printf("parallel verify ignored tasks that did not run\n");
+        goto done;
+    }
+    /* Different errors in the first and last chunk of each vector. */
+    p = find_name(buffer, size, "s10");
+    q = find_name(buffer, size, "m10");
+    if (!p || !q) {
+        printf("parallel verify test setup failed\n");
+        goto done;
+    }
+    memset(p - 4, 0xff, 4);
+    memset(q - 4, 0xff, 4);
+    sprintf(name, "s%d", n - 10);
+    p = find_name(buffer, size, name);
+    sprintf(name, "m%d", n - 10);
+    q = find_name(buffer, size, name);
+    if (!p || !q) {
+        printf("parallel verify test setup failed\n");
+        goto done;
+    }
+    p[strlen(p)] = 'x';
+    q[strlen(q)] = 'x';
+    if (flatcc_verify_error_string_out_of_range != ns(Monster_verify_as_root(buffer, size)) ||
+            flatcc_verify_error_string_out_of_range !=
+            ns(Monster_verify_as_root_parallel(buffer, size, reverse_runner, 0))) {
+        printf("parallel verify did not report the first error\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+int test_verify_with_mask(flatcc_builder_t *B)
+{
+    static const uint32_t enemy_fields[] = {
+        flatcc_verify_mask_word(ns(Monster_hp_field_id), 0)
+    };
+    static const flatcc_verify_mask_t enemy_mask = { enemy_fields, 1, 0 };
+    static const uint32_t root_fields[] = {
+        flatcc_verify_mask_word(ns(Monster_name_field_id), 0) |
+        flatcc_verify_mask_word(ns(Monster_enemy_field_id), 0)
+    };
+    const flatcc_verify_mask_t *root_children[32] = { 0 };
+    flatcc_verify_mask_t root_mask = { root_fields, 1, 0 };
+    uint32_t fields[1] = { 0 };
+    flatcc_verify_mask_t mask = { fields, 1, 0 };
+    ns(Monster_table_t) mon;
+    void *buffer;
+    char *p;
+    size_t size;
+    int ret = -1;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_enemy_start(B));
+    ns(Monster_name_create_str(B, "enemy"));
+    ns(Monster_hp_add(B, 7));
+    ns(Monster_enemy_end(B));
+    ns(Monster_testarrayofstring_start(B));
+    ns(Monster_testarrayofstring_push_create_str(B, "unread"));
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+    if (!buffer || !(p = find_name(buffer, size, "unread"))) {
+        printf("masked verify test setup failed\n");
+        goto done;
+    }
+    /* Fields outside the mask are not looked at. */
+    p[6] = 'x';
+    if (!ns(Monster_verify_as_root(buffer, size)) ||
+            ns(Monster_verify_as_root_with_mask(buffer, size, &root_mask))) {
+        printf("masked verify checked an unselected field\n");
+        goto done;
+    }
+    fields[0] = flatcc_verify_mask_word(ns(Monster_testarrayofstring_field_id), 0);
+    if (flatcc_verify_error_string_not_zero_terminated !=
+            ns(Monster_verify_as_root_with_mask(buffer, size, &mask))) {
+        printf("masked verify missed an error in a selected field\n");
+        goto done;
+    }
+    p[6] = '\0';
+    p = find_name(buffer, size, "enemy");
+    p[5] = 'x';
+    /* Without a child mask the subtree of a selected field is verified. */
+    if (flatcc_verify_error_string_not_zero_terminated !=
+            ns(Monster_verify_as_root_with_mask(buffer, size, &root_mask))) {
+        printf("masked verify missed an error in a selected subtree\n");
+        goto done;
+    }
+    root_children[ns(Monster_enemy_field_id)] = &enemy_mask;
+    root_mask.children = root_children;
+    if (ns(Monster_verify_as_root_with_mask(buffer, size, &root_mask))) {
+        printf("masked verify did not apply the child mask\n");
+        goto done;
+    }
+    mon = ns(Monster_as_root(buffer));
+    if (strcmp(ns(Monster_name(mon)), "root") || ns(Monster_hp(ns(Monster_enemy(mon)))) != 7) {
+        printf("masked verify test read unexpected values\n");
+        goto done;
+    }
+    /* Selecting only the union type field verifies the union table. */
+    flatcc_builder_aligned_free(buffer);
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_test_Monster_start(B));
+    ns(Monster_name_create_str(B, "member"));
+    ns(Monster_test_Monster_end(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+    if (!buffer || !(p = find_name(buffer, size, "member"))) {
+        printf("masked verify test setup failed\n");
+        goto done;
+    }
+    p[6] = 'x';
+    fields[0] = flatcc_verify_mask_word(ns(Monster_test_type_field_id), 0);
+    if (flatcc_verify_error_string_not_zero_terminated !=
+            ns(Monster_verify_as_root_with_mask(buffer, size, &mask))) {
+        printf("masked verify missed an error in a union selected by its type\n");
+        goto done;
+    }
+    fields[0] = flatcc_verify_mask_word(ns(Monster_test_field_id), 0);
+    if (flatcc_verify_error_string_not_zero_terminated !=
+            ns(Monster_verify_as_root_with_mask(buffer, size, &mask))) {
+        printf("masked verify missed an error in a union selected by its value\n");
+        goto done;
+    }
+    /* The union value id is just past the mask and its children. */
+    flatcc_builder_aligned_free(buffer);
+    flatcc_builder_reset(B);
+    ns(UnionAtWordEnd_start_as_root(B));
+    ns(UnionAtWordEnd_member_Monster_start(B));
+    ns(Monster_name_create_str(B, "member"));
+    ns(UnionAtWordEnd_member_Monster_end(B));
+    ns(UnionAtWordEnd_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+    if (!buffer || !(p = find_name(buffer, size, "member"))) {
+        printf("masked verify test setup failed\n");
+        goto done;
+    }
+    p[6] = 'x';
+    fields[0] = flatcc_verify_mask_word(ns(UnionAtWordEnd_member_type_field_id), 0);
+    mask.children = root_children;
+    if (ns(UnionAtWordEnd_member_type_field_id) != 31 ||
+            flatcc_verify_error_string_not_zero_terminated !=
+            ns(UnionAtWordEnd_verify_as_root_with_mask(buffer, size, &mask))) {
+        printf("masked verify missed an error in a union at the end of a mask word\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+/* A root monster with `text` as name and as the last element of `testarrayofstring`. */
+static void *build_text_monster(flatcc_builder_t *B, const char *text, size_t len, size_t *size)
+{
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_add(B, nsc(string_create(B, text, len))));
+    ns(Monster_testarrayofstring_start(B));
+    ns(Monster_testarrayofstring_push_create_str(B, "plain"));
+    ns(Monster_testarrayofstring_push(B, nsc(string_create(B, text, len))));
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_end_as_root(B));
+    return flatcc_builder_finalize_aligned_buffer(B, size);
+}
+
+int test_verify_with_flags(flatcc_builder_t *B)
+{
+    /* Long enough for whole SSE2 and AVX2 blocks. */
+    static const char unit[] = "text \xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80 ";
+    static const char *invalid[] = {
+        "\xc0\xaf", "\xe0\x80\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80",
+        "\xf5\x80\x80\x80", "\xe2\x82", "\x80", "\xff"
+    };
+    /* ASCII positions across block boundaries. */
+    static const size_t pos[] = { 0, 16, 31, 62, 105 };
+    const int all = flatcc_verify_flag_utf8 | flatcc_verify_flag_no_zero;
+    char text[120];
+    void *buffer = 0;
+    size_t i, j, k, size, len = sizeof(unit) - 1;
+    int ret = -1;
+
+    for (i = 0; i < sizeof(text); i += len) {
+        memcpy(text + i, unit, len);
+    }
+    buffer = build_text_monster(B, text, sizeof(text), &size);
+    if (!buffer || ns(Monster_verify_as_root_with_flags(buffer, size, all))) {
+        printf("flags verify rejected valid UTF-8\n");
+        goto done;
+    }
+    for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+        for (j = 0; j < sizeof(pos) / sizeof(pos[0]); ++j) {
+            flatcc_builder_aligned_free(buffer);
+            memcpy(text + pos[j], invalid[i], strlen(invalid[i]));
+            buffer = build_text_monster(B, text, sizeof(text), &size);
+            for (k = 0; k < sizeof(text); k += len) {
+                memcpy(text + k, unit, len);
+            }
+            if (!buffer || ns(Monster_verify_as_root(buffer, size)) ||
+                    ns(Monster_verify_as_root_with_flags(buffer, size, flatcc_verify_flag_no_zero)) ||
+                    flatcc_verify_error_string_not_valid_utf8 !=
+                    ns(Monster_verify_as_root_with_flags(buffer, size, flatcc_verify_flag_utf8))) {
+                printf("flags verify missed invalid UTF-8 %d at %d\n", (int)i, (int)pos[j]);
+                goto done;
+            }
+        }
+    }
+    /* Truncated at the end of the string. */
+    flatcc_builder_aligned_free(buffer);
+    buffer = build_text_monster(B, text, sizeof(text) - 2, &size);
+    if (!buffer || flatcc_verify_error_string_not_valid_utf8 !=
+            ns(Monster_verify_as_root_with_flags(buffer, size, flatcc_verify_flag_utf8))) {
+        printf("flags verify missed a truncated sequence\n");
+        goto done;
+    }
+    /* Only the string vector element is invalid. */
+    flatcc_builder_aligned_free(buffer);
+    buffer = build_text_monster(B, text, sizeof(text), &size);
+    if (!buffer || !(k = (size_t)(find_name(buffer, size, "plain") - (char *)buffer))) {
+        printf("flags verify test setup failed\n");
+        goto done;
+    }
+    ((char *)buffer)[k + 2] = '\xe0';
+    if (flatcc_verify_error_string_not_valid_utf8 !=
+            ns(Monster_verify_as_root_with_flags(buffer, size, flatcc_verify_flag_utf8))) {
+        printf("flags verify missed invalid UTF-8 in a string vector\n");
+        goto done;
+    }
+    /* Zeroes are valid UTF-8 but can be rejected, after invalid UTF-8. */
+    flatcc_builder_aligned_free(buffer);
+    text[45] = '\0';
+    buffer = build_text_monster(B, text, sizeof(text), &size);
+    if (!buffer || ns(Monster_verify_as_root_with_flags(buffer, size, flatcc_verify_flag_utf8)) ||
+            flatcc_verify_error_string_has_embedded_zero !=
+            ns(Monster_verify_as_root_with_flags(buffer, size, all))) {
+        printf("flags verify did not handle an embedded zero\n");
+        goto done;
+    }
+    flatcc_builder_aligned_free(buffer);
+    text[100] = '\xff';
+    buffer = build_text_monster(B, text, sizeof(text), &size);
+    if (!buffer || flatcc_verify_error_string_not_valid_utf8 !=
+            ns(Monster_verify_as_root_with_flags(buffer, size, all))) {
+        printf("flags verify reported a zero before invalid UTF-8\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+int test_vtable_dict(flatcc_builder_t *B)
+{
+    flatcc_builder_stats_t stats;
+    flatbuffers_string_ref_t id;
+    ns(Stat_table_t) stat;
+    const void *buffer;
+    size_t size;
+    int i, ret = -1;
+
+    flatcc_builder_custom_reset(B, 1, 0);
+    flatcc_builder_set_stats(B, 1);
+    if (flatcc_builder_set_vtable_dict(B, monster_test_vtable_dict())) {
+        printf("vtable dictionary could not be attached\n");
+        goto done;
+    }
+    /* The dictionary survives reset and flush. */
+    for (i = 0; i < 3; ++i) {
+        flatcc_builder_reset(B);
+        if (i == 2) {
+            flatcc_builder_flush_vtable_cache(B);
+        }
+        flatbuffers_buffer_start(B, ns(Stat_identifier));
+        id = flatbuffers_string_create_str(B, "dict");
+        ns(Stat_start(B));
+        ns(Stat_end(B));
+        flatbuffers_buffer_end(B, ns(Stat_create(B, id, 42, (uint16_t)i + 1)));
+        buffer = flatcc_builder_get_direct_buffer(B, &size);
+        stat = ns(Stat_as_root(buffer));
+        if (!buffer || ns(Stat_verify_as_root(buffer, size)) ||
+                strcmp(ns(Stat_id(stat)), "dict") || ns(Stat_val(stat)) != 42 ||
+                ns(Stat_count(stat)) != i + 1) {
+            printf("vtable dictionary buffer not as expected\n");
+            goto done;
+        }
+    }
+    /* The empty and the full Stat vtables are found in every buffer. */
+    flatcc_builder_get_stats(B, &stats);
+    if (FLATCC_BUILDER_STATS && (stats.vtable_lookups != 6 || stats.vtable_hits != 6)) {
+        printf("vtable dictionary lookups did not hit\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_custom_reset(B, 1, 0);
+    if (B->vtable_dict) {
+        printf("vtable dictionary not detached by reset with defaults\n");
+        ret = -1;
+    }
+    return ret;
+}
+
+int test_reserve_estimate(flatcc_builder_t *B)
+{
+    static const char *names[] = { "first", "second", "third" };
+    uint8_t inv[100];
+    size_t estimate, size;
+    flatcc_builder_stats_t stats;
+    ns(Vec3_t) *v;
+    int i, ret = -1;
+
+    memset(inv, 1, sizeof(inv));
+    estimate = ns(Monster_estimate_size()) +
+        flatbuffers_string_estimate_size(strlen("reserved")) +
+        flatbuffers_uint8_vec_estimate_size(sizeof(inv)) +
+        flatbuffers_string_vec_estimate_size(3);
+    for (i = 0; i < 3; ++i) {
+        estimate += flatbuffers_string_estimate_size(strlen(names[i]));
+    }
+    estimate = flatbuffers_buffer_estimate_size(estimate, 16);
+
+    /* Shrink the stacks so only the reservation can make room. */
+    flatcc_builder_custom_reset(B, 1, 1);
+    if (flatcc_builder_reserve(B, estimate)) {
+        printf("builder reserve failed\n");
+        goto done;
+    }
+    flatcc_builder_set_stats(B, 1);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "reserved"));
+    v = ns(Monster_pos_start(B));
+    v->x = 1, v->y = 2, v->z = 3;
+    ns(Monster_pos_end(B));
+    ns(Monster_inventory_create(B, inv, sizeof(inv)));
+    ns(Monster_testarrayofstring_start(B));
+    for (i = 0; i < 3; ++i) {
+        ns(Monster_testarrayofstring_push_create_str(B, names[i]));
+    }
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_hp_add(B, 10));
+    ns(Monster_end_as_root(B));
+    size = flatcc_builder_get_buffer_size(B);
+    flatcc_builder_get_stats(B, &stats);
+    if (size > estimate || estimate > 2 * size) {
+        printf("size estimate %d not a tight bound on buffer size %d\n", (int)estimate, (int)size);
+        goto done;
+    }
+    if (FLATCC_BUILDER_STATS && (stats.alloc_calls[flatcc_builder_alloc_ds] != 0 ||
+            stats.emitter_pages_allocated != 0)) {
+        printf("reserved builder still had to grow\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_custom_reset(B, 1, 0);
+    return ret;
+}
+
+int test_byteswap(flatcc_builder_t *B)
+{
+    uint8_t src[301], dst[301], expect[301];
+    uint64_t data[5] = { 1, 2, 3, 0x0102030405060708, 0xff };
+    const uint8_t *buf, *vec;
+    size_t width, size, i, k;
+    flatcc_builder_ref_t ref;
+    int ret = -1;
+
+    for (i = 0; i < sizeof(src); ++i) {
+        src[i] = (uint8_t)(i * 7 + 3);
+    }
+    for (width = 1; width <= 8; width *= 2) {
+        /* Cover vector blocks, scalar tails and unaligned buffers. */
+        for (size = 0; size + width < sizeof(src); size += width * 5) {
+            for (i = 0; i < size; i += width) {
+                for (k = 0; k < width; ++k) {
+                    expect[i + k] = src[1 + i + width - 1 - k];
+                }
+            }
+            flatcc_byteswap_copy(dst, src + 1, size, width);
+            if (memcmp(dst, expect, size)) {
+                printf("byteswap copy failed for width %d, size %d\n", (int)width, (int)size);
+                goto done;
+            }
+            memcpy(dst + 1, src + 1, size);
+            flatcc_byteswap_copy(dst + 1, dst + 1, size, width);
+            if (memcmp(dst + 1, expect, size)) {
+                printf("byteswap in place failed for width %d, size %d\n", (int)width, (int)size);
+                goto done;
+            }
+        }
+    }
+
+    flatcc_builder_reset(B);
+    flatcc_builder_start_buffer(B, 0, 0);
+    flatcc_builder_start_vector(B, 8, 8, FLATBUFFERS_COUNT_MAX(8));
+    flatcc_builder_append_vector(B, data, 5);
+    ref = flatcc_builder_end_byteswapped_vector(B, 8);
+    flatcc_builder_end_buffer(B, ref);
+    buf = flatcc_builder_get_direct_buffer(B, 0);
+    if (!buf) {
+        printf("byteswapped vector buffer not available\n");
+        goto done;
+    }
+    vec = buf + __flatbuffers_uoffset_read_from_pe(buf);
+    if (__flatbuffers_uoffset_read_from_pe(vec) != 5) {
+        printf("byteswapped vector has wrong length\n");
+        goto done;
+    }
+    vec += sizeof(flatbuffers_uoffset_t);
+    for (i = 0; i < 5 * 8; ++i) {
+        if (vec[i] != ((const uint8_t *)data)[(i & ~(size_t)7) + 7 - (i & 7)]) {
+            printf("byteswapped vector content mismatch\n");
+            goto done;
+        }
+    }
+    ret = 0;
+done:
+    flatcc_builder_reset(B);
+    return ret;
+}
+
+int test_clone(flatcc_builder_t *B)
+{
+    uint8_t inv[] = { 1, 2, 3 };
+    ns(Monster_ref_t) child;
+    nsc(string_ref_t) str;
+    ns(Monster_table_t) mon, enemy;
+    ns(Monster_vec_t) mons;
+    nsc(string_vec_t) strs;
+    void *src = 0, *dst = 0;
+    size_t src_size, dst_size;
+    int ret = -1;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_hp_add(B, 7));
+    ns(Monster_inventory_create(B, inv, sizeof(inv)));
+    ns(Monster_start(B));
+    ns(Monster_name_create_str(B, "shared"));
+    child = ns(Monster_end(B));
+    /* The same child is reachable along four paths. */
+    ns(Monster_enemy_add(B, child));
+    ns(Monster_test_add(B, ns(Any_as_Monster(child))));
+    ns(Monster_testarrayoftables_start(B));
+    ns(Monster_testarrayoftables_push(B, child));
+    ns(Monster_testarrayoftables_push(B, child));
+    ns(Monster_testarrayoftables_end(B));
+    str = nsc(string_create_str(B, "twice"));
+    ns(Monster_testarrayofstring_start(B));
+    ns(Monster_testarrayofstring_push(B, str));
+    ns(Monster_testarrayofstring_push(B, str));
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_end_as_root(B));
+    src = flatcc_builder_finalize_buffer(B, &src_size);
+
+    flatcc_builder_reset(B);
+    if (!ns(Monster_clone_as_root(B, ns(Monster_as_root(src))))) {
+        printf("clone as root failed\n");
+        goto done;
+    }
+    dst = flatcc_builder_finalize_buffer(B, &dst_size);
+    if (ns(Monster_verify_as_root(dst, dst_size))) {
+        printf("cloned buffer does not verify\n");
+        goto done;
+    }
+    mon = ns(Monster_as_root(dst));
+    enemy = ns(Monster_enemy(mon));
+    mons = ns(Monster_testarrayoftables(mon));
+    strs = ns(Monster_testarrayofstring(mon));
+    if (strcmp(ns(Monster_name(mon)), "root") || ns(Monster_hp(mon)) != 7 ||
+            nsc(uint8_vec_len(ns(Monster_inventory(mon)))) != 3 ||
+            nsc(uint8_vec_at(ns(Monster_inventory(mon)), 2)) != 3 ||
+            strcmp(ns(Monster_name(enemy)), "shared")) {
+        printf("cloned content differs\n");
+        goto done;
+    }
+    if (ns(Monster_test_type(mon)) != ns(Any_Monster) ||
+            ns(Monster_test(mon)) != enemy ||
+            ns(Monster_vec_at(mons, 0)) != enemy || ns(Monster_vec_at(mons, 1)) != enemy ||
+            nsc(string_vec_at(strs, 0)) != nsc(string_vec_at(strs, 1))) {
+        printf("shared objects were not shared in clone\n");
+        goto done;
+    }
+    if (dst_size > src_size) {
+        printf("clone is larger than source\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    free(src);
+    free(dst);
+    return ret;
+}
+
+int test_mutate(flatcc_builder_t *B)
+{
+    uint8_t inv[] = { 1, 2, 3 };
+    ns(Vec3_t) v3 = { 0 };
+    ns(Monster_table_t) mon;
+    nsc(uint8_mutable_vec_t) inventory;
+    ns(Vec3_struct_t) pos;
+    void *buffer;
+    size_t size;
+    int ret = -1;
+
+    flatcc_builder_reset(B);
+    ns(Monster_start_as_root(B));
+    ns(Monster_pos_create(B, 1, 2, 3, 4.5, ns(Color_Red), 10, 20));
+    ns(Monster_hp_add(B, 7));
+    ns(Monster_name_create_str(B, "mutant"));
+    ns(Monster_color_add(B, ns(Color_Green)));
+    ns(Monster_inventory_create(B, inv, sizeof(inv)));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+    mon = ns(Monster_as_root(buffer));
+
+    if (ns(Monster_hp_mutate(mon, 42)) || ns(Monster_hp(mon)) != 42) {
+        printf("could not mutate present scalar field\n");
+        goto done;
+    }
+    if (!ns(Monster_mana_mutate(mon, 1)) || ns(Monster_mana(mon)) != 150) {
+        printf("mutated defaulted scalar field\n");
+        goto done;
+    }
+    if (ns(Monster_color_mutate(mon, ns(Color_Blue))) || ns(Monster_color(mon)) != ns(Color_Blue)) {
+        printf("could not mutate enum field\n");
+        goto done;
+    }
+    pos = ns(Monster_pos(mon));
+    if (ns(Vec3_y_mutate(pos, -2)) || ns(Vec3_y(pos)) != -2 ||
+            ns(Test_b_mutate(ns(Vec3_test3(pos)), 21)) || ns(Test_b(ns(Vec3_test3(pos)))) != 21) {
+        printf("could not mutate struct member\n");
+        goto done;
+    }
+    v3.x = 9;
+    v3.test1 = 1.5;
+    v3.test2 = ns(Color_Green);
+    v3.test3.a = -5;
+    if (ns(Monster_pos_mutate(mon, &v3)) || ns(Vec3_x(pos)) != 9 || ns(Vec3_y(pos)) != 0 ||
+            ns(Vec3_test1(pos)) != 1.5 || ns(Vec3_test2(pos)) != ns(Color_Green) ||
+            ns(Test_a(ns(Vec3_test3(pos)))) != -5) {
+        printf("could not mutate struct field\n");
+        goto done;
+    }
+    if (!ns(Monster_testhashs32_fnv1_mutate(mon, 1))) {
+        printf("mutated absent field\n");
+        goto done;
+    }
+    inventory = (nsc(uint8_mutable_vec_t))ns(Monster_inventory(mon));
+    if (nsc(uint8_vec_mutate_at(inventory, 2, 30)) || nsc(uint8_vec_at(inventory, 2)) != 30 ||
+            !nsc(uint8_vec_mutate_at(inventory, 3, 40))) {
+        printf("scalar vector mutate failed\n");
+        goto done;
+    }
+    if (ns(Monster_verify_as_root(buffer, size))) {
+        printf("mutated buffer does not verify\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    return ret;
+}
+
+int test_struct_buffer(flatcc_builder_t *B)
+{
+    uint8_t buffer[100];
+
+    size_t size;
+    ns(Vec3_t) *v;
+    ns(Vec3_struct_t) vec3;
+
+    flatcc_builder_reset(B);
+    ns(Vec3_create_as_root(B, 1, 2, 3, 4.2, ns(Color_Blue), 2730, -17));
+    size = flatcc_builder_get_buffer_size(B);
+    assert(size == 48);
+    printf("dbg: struct buffer size: %d\n", (int)size);
+    assert(flatcc_emitter_get_buffer_size(flatcc_builder_get_emit_context(B)) == size);
+    if (!flatcc_builder_copy_buffer(B, buffer, 100)) {
+        printf("Copy failed\n");
+        return -1;
+    }
+    hexdump("Vec3 struct buffer", buffer, size, stderr);
+    if (!nsc(has_identifier(buffer, "MONS"))) {
+        printf("wrong Vec3 identifier (explicit)\n");
+        return -1;
+    }
+    if (nsc(has_identifier(buffer, "mons"))) {
+        printf("accepted wrong Vec3 identifier (explicit)\n");
+        return -1;
+    }
+    if (!nsc(has_identifier(buffer, ns(Vec3_identifier)))) {
+        printf("wrong Vec3 identifier (via define)\n");
+        return -1;
+    }
+    vec3 = ns(Vec3_as_root(buffer));
+    /* Convert buffer to native in place - a nop on native platform. */
+    v = (ns(Vec3_t) *)vec3;
+    ns(Vec3_from_pe(v));
+    if (v->x != 1.0f || v->y != 2.0f || v->z != 3.0f
+        || v->test1 != 4.2 || v->test2 != ns(Color_Blue)
+        || v->test3.a != 2730 || v->test3.b != -17
+       ) {
+        printf("struct buffer not valid\n");
+        return -1;
+    }
+    assert(ns(Color_Red) == 1 << 0);
+    assert(ns(Color_Green) == 1 << 1);
+    assert(ns(Color_Blue) == 1 << 3);
+    assert(sizeof(ns(Color_Blue) == 1));
+    return 0;
+}
+
+int test_typed_struct_buffer(flatcc_builder_t *B)
+{
+    uint8_t buffer[100];
+
+    size_t size;
+    ns(Vec3_t) *v;
+    ns(Vec3_struct_t) vec3;
+
+    flatcc_builder_reset(B);
+    ns(Vec3_create_as_typed_root(B, 1, 2, 3, 4.2, ns(Color_Blue), 2730, -17));
+    size = flatcc_builder_get_buffer_size(B);
+    assert(size == 48);
+    printf("dbg: struct buffer size: %d\n", (int)size);
+    assert(flatcc_emitter_get_buffer_size(flatcc_builder_get_emit_context(B)) == size);
+    if (!flatcc_builder_copy_buffer(B, buffer, 100)) {
+        printf("Copy failed\n");
+        return -1;
+    }
+    hexdump("typed Vec3 struct buffer", buffer, size, stderr);
+    if (!nsc(has_identifier(buffer, "\xd2\x3e\xf5\xa8"))) {
+        printf("wrong Vec3 identifier (explicit)\n");
+        return -1;
+    }
+    if (nsc(has_identifier(buffer, "mons"))) {
+        printf("accepted wrong Vec3 identifier (explicit)\n");
+        return -1;
+    }
+    if (!nsc(has_identifier(buffer, ns(Vec3_type_identifier)))) {
+        printf("wrong Vec3 identifier (via define)\n");
+        return -1;
+    }
+    if (!ns(Vec3_as_root_with_type_hash(buffer, ns(Vec3_type_hash)))) {
+        printf("wrong Vec3 type identifier (via define)\n");
+        return -1;
+    }
+    if (!ns(Vec3_verify_as_root_with_type_hash(buffer, size, ns(Vec3_type_hash)))) {
+        printf("verify failed with Vec3 type hash)\n");
+        return -1;
+    }
+    vec3 = ns(Vec3_as_typed_root(buffer));
+    if (!vec3) {
+        printf("typed Vec3 could not be read\n");
+        return -1;
+    }
+    if (!ns(Vec3_verify_as_typed_root(buffer, size))) {
+        printf("verify failed with Vec3 type hash)\n");
+        return -1;
+    }
+    /* Convert buffer to native in place - a nop on native platform. */
+    v = (ns(Vec3_t) *)vec3;
+    ns(Vec3_from_pe(v));
+    if (v->x != 1.0f || v->y != 2.0f || v->z != 3.0f
+        || v->test1 != 4.2 || v->test2 != ns(Color_Blue)
+        || v->test3.a != 2730 || v->test3.b != -17
+       ) {
+        printf("struct buffer not valid\n");
+        return -1;
+    }
+    assert(ns(Color_Red) == 1 << 0);
+    assert(ns(Color_Green) == 1 << 1);
+    assert(ns(Color_Blue) == 1 << 3);
+    assert(sizeof(ns(Color_Blue) == 1));
+    return 0;
+}
+
+
+/* A stable test snapshot for reference. */
+int gen_monster_benchmark(flatcc_builder_t *B)
+{
+    uint8_t inv[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    ns(Vec3_t) *vec;
+    ns(Test_t) *test, x;
+
+    flatcc_builder_reset(B);
+
     ns(Monster_start_as_root(B));
     ns(Monster_hp_add(B, 80));
     vec = ns(Monster_pos_start(B));
@@ -1713,6 +3280,108 @@ int main(int argc, char *argv[])
         return -1;
     }
 #endif
+#if 1
+    if (test_vtable_reuse_across_buffers()) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+    if (test_vtable_cache_move_to_front()) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+    if (test_checkpoint_rollback(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+    if (test_rollback_vtable_cache()) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+    if (test_rollback_stale_vtable()) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_arena_alloc()) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_shared_strings(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_object_dedup(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_splice_fragments(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_builder_stats(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_finalize_into(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_stream_mode(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+    if (test_vtable_dict(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+    if (test_verify_memoized(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+    if (test_verify_parallel(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+    if (test_verify_with_mask(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+    if (test_verify_with_flags(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
+#if 1
+    if (test_reserve_estimate(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+    if (test_byteswap(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+    if (test_clone(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+    if (test_mutate(B)) {
+        printf("TEST FAILED\n");
+        return -1;
+    }
+#endif
 #ifdef FLATBUFFERS_BENCHMARK
     time_monster(B);
     time_struct_buffer(B);
@@ -0,0 +1,100 @@
+/*
+ * Checks that table driven verification generated with --verifier-specs
+ * gives the same result as the generated verifier functions, for a valid
+ * buffer and for every single byte corruption of it.
+ */
+#include <stdio.h>
+
+#include "monster_test.h"
+
+#undef ns
+#define ns(x) FLATBUFFERS_WRAP_NAMESPACE(MyGame_Example, x)
+
+int verify_monster_with_specs(const void *buf, size_t size);
+
+static int build_monster(flatcc_builder_t *B)
+{
+    static uint8_t inventory[] = { 1, 2, 3, 4 };
+    ns(Monster_ref_t) mon;
+    ns(Test_t) *test;
+
+    ns(Monster_start(B));
+    ns(Monster_name_create_str(B, "TwoFace"));
+    mon = ns(Monster_end(B));
+
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "MyMonster"));
+    ns(Monster_hp_add(B, 80));
+    ns(Monster_inventory_create(B, inventory, 4));
+    ns(Monster_testarrayofstring_start(B));
+    ns(Monster_testarrayofstring_push_create_str(B, "Hello"));
+    ns(Monster_testarrayofstring_push_create_str(B, "world!"));
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_testarrayoftables_start(B));
+    ns(Monster_testarrayoftables_push(B, mon));
+    ns(Monster_testarrayoftables_push_start(B));
+    ns(Monster_name_create_str(B, "Joker"));
+    ns(Monster_testarrayoftables_push_end(B));
+    ns(Monster_testarrayoftables_end(B));
+    ns(Monster_enemy_start(B));
+    ns(Monster_name_create_str(B, "the enemy"));
+    ns(Monster_enemy_end(B));
+    ns(Monster_test_add)(B, ns(Any_as_Monster(mon)));
+    ns(Monster_test4_start(B));
+    test = ns(Monster_test4_extend(B, 2));
+    test[0].a = 10;
+    test[1].b = 20;
+    ns(Monster_test4_end(B));
+    ns(Monster_testnestedflatbuffer_start_as_root(B));
+    ns(Monster_name_create_str(B, "MyNestedMonster"));
+    ns(Monster_testnestedflatbuffer_end_as_root(B));
+    ns(Monster_testempty_start(B));
+    ns(Stat_id_create_str(B, "empty"));
+    ns(Monster_testempty_end(B));
+    ns(Monster_end_as_root(B));
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    flatcc_builder_t builder, *B = &builder;
+    static const uint8_t flips[] = { 0x01, 0x10, 0x80, 0xff };
+    uint8_t *buf;
+    size_t size, i, k, failures = 0;
+    int ret = -1, expected, actual;
+
+    (void)argc;
+    (void)argv;
+
+    flatcc_builder_init(B);
+    build_monster(B);
+    if (!(buf = flatcc_builder_finalize_aligned_buffer(B, &size))) {
+        printf("could not build monster\n");
+        goto done;
+    }
+    if ((expected = ns(Monster_verify_as_root(buf, size))) ||
+            (actual = verify_monster_with_specs(buf, size))) {
+        printf("monster did not verify: %s\n",
+                flatcc_verify_error_string(expected ? expected : actual));
+        goto done;
+    }
+    for (i = 0; i < size; ++i) {
+        for (k = 0; k < sizeof(flips); ++k) {
+            buf[i] ^= flips[k];
+            expected = ns(Monster_verify_as_root(buf, size));
+            actual = verify_monster_with_specs(buf, size);
+            buf[i] ^= flips[k];
+            if (expected != actual) {
+                printf("byte %d flipped with 0x%02x: functions: %s, specs: %s\n",
+                        (int)i, flips[k], flatcc_verify_error_string(expected),
+                        flatcc_verify_error_string(actual));
+                ++failures;
+            }
+        }
+    }
+    ret = failures ? -1 : 0;
+done:
+    flatcc_builder_aligned_free(buf);
+    flatcc_builder_clear(B);
+    return ret;
+}
@@ -0,0 +1,9 @@
+/* Verifier generated with --verifier-specs. */
+#include "monster_test_specs.h"
+
+int verify_monster_with_specs(const void *buf, size_t size);
+
+int verify_monster_with_specs(const void *buf, size_t size)
+{
+    return MyGame_Example_Monster_verify_as_root(buf, size);
+}
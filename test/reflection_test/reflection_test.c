@@ -1,5 +1,11 @@
 #include "flatcc/support/readfile.h"
 #include "flatcc/reflection/reflection_reader.h"
+#include "flatcc/flatcc_compact.h"
+#include "monster_test_builder.h"
+#include "monster_test_verifier.h"
+
+#undef ns
+#define ns(x) FLATBUFFERS_WRAP_NAMESPACE(MyGame_Example, x)
 
 #define lld(x) (long long int)(x)
 
@@ -98,9 +104,123 @@ done:
     return ret;
 }
 
+/* Builds a buffer with repeated content and checks that compaction removes it. */
+int test_compact(const char *monster_bfbs)
+{
+    flatcc_builder_t builder, *B = &builder;
+    void *schema, *buffer = 0, *compact = 0;
+    size_t schema_size, size, compact_size;
+    ns(Monster_table_t) mon, nested;
+    ns(Monster_vec_t) mons;
+    flatbuffers_string_vec_t strs;
+    int i, ret = -1;
+
+    schema = readfile(monster_bfbs, 10000, &schema_size);
+    if (!schema) {
+        printf("failed to load binary schema\n");
+        return -1;
+    }
+    flatcc_builder_init(B);
+    /* Flushing the vtable cache after every table duplicates all vtables. */
+    flatcc_builder_set_vtable_cache_limit(B, 1);
+    flatcc_builder_set_vtable_clustering(B, 0);
+    ns(Monster_start_as_root(B));
+    ns(Monster_name_create_str(B, "root"));
+    ns(Monster_pos_create(B, 1, 2, 3, 0.5, ns(Color_Red), 4, 5));
+    ns(Monster_test_Monster_start(B));
+    ns(Monster_name_create_str(B, "union"));
+    ns(Monster_test_Monster_end(B));
+    /* The nested buffer has the same string, which must not be shared across buffers. */
+    ns(Monster_testnestedflatbuffer_start_as_root(B));
+    ns(Monster_name_create_str(B, "nested"));
+    ns(Monster_pos_create(B, 1, 2, 3, 0.5, ns(Color_Red), 4, 5));
+    ns(Monster_testarrayofstring_start(B));
+    for (i = 0; i < 10; ++i) {
+        ns(Monster_testarrayofstring_push_create_str(B, "a long repeated string"));
+    }
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_testnestedflatbuffer_end_as_root(B));
+    ns(Monster_testarrayoftables_start(B));
+    for (i = 0; i < 10; ++i) {
+        ns(Monster_testarrayoftables_push_start(B));
+        ns(Monster_name_create_str(B, "a long repeated monster name"));
+        ns(Monster_hp_add(B, 10));
+        ns(Monster_testempty_start(B));
+        ns(Stat_val_add(B, 42));
+        ns(Monster_testempty_end(B));
+        ns(Monster_testarrayoftables_push_end(B));
+    }
+    ns(Monster_testarrayoftables_end(B));
+    ns(Monster_testarrayofstring_start(B));
+    for (i = 0; i < 10; ++i) {
+        ns(Monster_testarrayofstring_push_create_str(B, "a long repeated string"));
+    }
+    ns(Monster_testarrayofstring_end(B));
+    ns(Monster_end_as_root(B));
+    buffer = flatcc_builder_finalize_aligned_buffer(B, &size);
+
+    flatcc_builder_reset(B);
+    if (flatcc_compact_buffer(B, schema, schema_size, buffer, size)) {
+        printf("compaction failed\n");
+        goto done;
+    }
+    compact = flatcc_builder_finalize_aligned_buffer(B, &compact_size);
+    if (ns(Monster_verify_as_root(compact, compact_size))) {
+        printf("compacted buffer does not verify\n");
+        goto done;
+    }
+    if (compact_size >= size / 2) {
+        printf("compacted buffer is not small enough\n");
+        goto done;
+    }
+    mon = ns(Monster_as_root(compact));
+    mons = ns(Monster_testarrayoftables(mon));
+    strs = ns(Monster_testarrayofstring(mon));
+    if (strcmp(ns(Monster_name(mon)), "root") || ns(Test_b(ns(Vec3_test3(ns(Monster_pos(mon)))))) != 5 ||
+            ns(Monster_test_type(mon)) != ns(Any_Monster) ||
+            strcmp(ns(Monster_name(ns(Monster_test(mon)))), "union") ||
+            ns(Monster_vec_len(mons)) != 10 || ns(Monster_hp(ns(Monster_vec_at(mons, 9)))) != 10 ||
+            flatbuffers_string_vec_len(strs) != 10) {
+        printf("compacted buffer has wrong content\n");
+        goto done;
+    }
+    if (ns(Monster_testempty(ns(Monster_vec_at(mons, 0)))) !=
+            ns(Monster_testempty(ns(Monster_vec_at(mons, 9)))) ||
+            ns(Monster_name(ns(Monster_vec_at(mons, 0)))) !=
+            ns(Monster_name(ns(Monster_vec_at(mons, 9)))) ||
+            flatbuffers_string_vec_at(strs, 0) != flatbuffers_string_vec_at(strs, 9)) {
+        printf("identical objects were not shared\n");
+        goto done;
+    }
+    /* Vec3 is force aligned to 16 bytes, also in the nested buffer. */
+    nested = ns(Monster_testnestedflatbuffer_as_root(mon));
+    strs = ns(Monster_testarrayofstring(nested));
+    if (!nested || strcmp(ns(Monster_name(nested)), "nested") ||
+            ns(Test_b(ns(Vec3_test3(ns(Monster_pos(nested)))))) != 5 ||
+            flatbuffers_string_vec_len(strs) != 10 ||
+            ((size_t)ns(Monster_testnestedflatbuffer(mon)) - (size_t)compact) % 16) {
+        printf("compacted nested buffer has wrong content\n");
+        goto done;
+    }
+    if (flatbuffers_string_vec_at(strs, 0) != flatbuffers_string_vec_at(strs, 9)) {
+        printf("identical objects in the nested buffer were not shared\n");
+        goto done;
+    }
+    ret = 0;
+done:
+    flatcc_builder_aligned_free(buffer);
+    flatcc_builder_aligned_free(compact);
+    flatcc_builder_clear(B);
+    free(schema);
+    return ret;
+}
+
 int main(int argc, char *argv[])
 {
     (void)argc;
     (void)argv;
-    return test_schema("generated/monster_test.bfbs");
+    if (test_schema("generated/monster_test.bfbs")) {
+        return -1;
+    }
+    return test_compact("generated/monster_test.bfbs");
 }
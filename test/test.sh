@@ -48,7 +48,7 @@ ${ROOT}/bin/flatcc -I ${ROOT}/test/monster_test -a --stdout \
 cd ${TMP}/monster_test_solo && $CC -c -Wall -O3 -I ${INC} solo_monster.c
 
 echo "generating smoke test generated monster source with --prefix zzz --common-prefix hello" 1>&2
-${ROOT}/bin/flatcc -I ${ROOT}/test/monster_test -a \
+${ROOT}/bin/flatcc -I ${ROOT}/test/monster_test -a --vtable-dict \
     --common-prefix hello --prefix zzz \
     -o ${TMP}/monster_test_hello ${ROOT}/test/monster_test/monster_test.fbs
 echo "#include \"monster_test_builder.h\"" > ${TMP}/monster_test_hello/hello_monster.c
@@ -70,7 +70,7 @@ ${ROOT}/test/emit_test/emit_test.sh
 #
 echo "running main monster test"
 cd ${ROOT}/test/monster_test
-${ROOT}/bin/flatcc -I ${ROOT}/test/monster_test -a \
+${ROOT}/bin/flatcc -I ${ROOT}/test/monster_test -a --vtable-dict \
     -o ${TMP}/monster_test_main ${ROOT}/test/monster_test/monster_test.fbs
 cd ${TMP}/monster_test_main
 cp ${ROOT}/test/monster_test/monster_test.c .